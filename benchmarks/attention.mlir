@@ -0,0 +1,104 @@
+func.func private @nanoTime() -> i64 attributes { llvm.emit_c_interface }
+func.func private @printFlops(f64)
+func.func private @printI64(i64)
+func.func private @printMemrefF32(tensor<*xf32>)
+
+// Attention block over 8 heads: softmax(Q x K^T / sqrt(64)) x V
+!TTqkv = tensor<8x512x64xf32>
+!TTs = tensor<8x512x512xf32>
+!TTrow = tensor<8x512xf32>
+
+#map_q = affine_map<(d0, d1, d2, d3) -> (d0, d1, d3)>
+#map_k = affine_map<(d0, d1, d2, d3) -> (d0, d2, d3)>
+#map_s = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2)>
+#map_3d = affine_map<(d0, d1, d2) -> (d0, d1, d2)>
+#map_row = affine_map<(d0, d1, d2) -> (d0, d1)>
+
+func.func @attention() -> !TTqkv{
+
+  %val = arith.constant 2.00000e-02 : f32
+  %zero = arith.constant 0.00000e+00 : f32
+  %minus_inf = arith.constant 0xFF800000 : f32
+  %scale = arith.constant 1.25000e-01 : f32
+
+  %out = bufferization.alloc_tensor() : !TTqkv
+  %Q = linalg.fill ins(%val : f32) outs(%out : !TTqkv) -> !TTqkv
+  %out1 = bufferization.alloc_tensor() : !TTqkv
+  %K = linalg.fill ins(%val : f32) outs(%out1 : !TTqkv) -> !TTqkv
+  %out2 = bufferization.alloc_tensor() : !TTqkv
+  %V = linalg.fill ins(%val : f32) outs(%out2 : !TTqkv) -> !TTqkv
+  %out3 = bufferization.alloc_tensor() : !TTs
+  %S_init = linalg.fill ins(%zero : f32) outs(%out3 : !TTs) -> !TTs
+  %out4 = bufferization.alloc_tensor() : !TTrow
+  %max_init = linalg.fill ins(%minus_inf : f32) outs(%out4 : !TTrow) -> !TTrow
+  %out5 = bufferization.alloc_tensor() : !TTrow
+  %sum_init = linalg.fill ins(%zero : f32) outs(%out5 : !TTrow) -> !TTrow
+  %out6 = bufferization.alloc_tensor() : !TTs
+  %out7 = bufferization.alloc_tensor() : !TTs
+  %out8 = bufferization.alloc_tensor() : !TTqkv
+  %O_init = linalg.fill ins(%zero : f32) outs(%out8 : !TTqkv) -> !TTqkv
+
+  %t0 = func.call @nanoTime() : () -> (i64)
+
+  // Q x K^T
+  %S = linalg.generic {indexing_maps = [#map_q, #map_k, #map_s],
+                       iterator_types = ["parallel", "parallel", "parallel", "reduction"]}
+      ins(%Q, %K : !TTqkv, !TTqkv) outs(%S_init : !TTs) {
+    ^bb0(%q: f32, %k: f32, %acc: f32):
+      %mul = arith.mulf %q, %k : f32
+      %add = arith.addf %mul, %acc : f32
+      linalg.yield %add : f32
+  } -> !TTs
+
+  // Softmax of the scaled scores on the rows
+  %max = linalg.generic {indexing_maps = [#map_3d, #map_row],
+                         iterator_types = ["parallel", "parallel", "reduction"]}
+      ins(%S : !TTs) outs(%max_init : !TTrow) {
+    ^bb0(%in: f32, %acc: f32):
+      %m = arith.maximumf %in, %acc : f32
+      linalg.yield %m : f32
+  } -> !TTrow
+
+  %exp = linalg.generic {indexing_maps = [#map_3d, #map_row, #map_3d],
+                         iterator_types = ["parallel", "parallel", "parallel"]}
+      ins(%S, %max : !TTs, !TTrow) outs(%out6 : !TTs) {
+    ^bb0(%in: f32, %m: f32, %o: f32):
+      %sub = arith.subf %in, %m : f32
+      %scaled = arith.mulf %sub, %scale : f32
+      %e = math.exp %scaled : f32
+      linalg.yield %e : f32
+  } -> !TTs
+
+  %sum = linalg.generic {indexing_maps = [#map_3d, #map_row],
+                         iterator_types = ["parallel", "parallel", "reduction"]}
+      ins(%exp : !TTs) outs(%sum_init : !TTrow) {
+    ^bb0(%in: f32, %acc: f32):
+      %s = arith.addf %in, %acc : f32
+      linalg.yield %s : f32
+  } -> !TTrow
+
+  %P = linalg.generic {indexing_maps = [#map_3d, #map_row, #map_3d],
+                       iterator_types = ["parallel", "parallel", "parallel"]}
+      ins(%exp, %sum : !TTs, !TTrow) outs(%out7 : !TTs) {
+    ^bb0(%in: f32, %s: f32, %o: f32):
+      %div = arith.divf %in, %s : f32
+      linalg.yield %div : f32
+  } -> !TTs
+
+  // P x V
+  %O = linalg.batch_matmul ins(%P, %V: !TTs, !TTqkv)
+                          outs(%O_init: !TTqkv) -> !TTqkv
+
+  %t = func.call @nanoTime() : () -> (i64)
+  %delta = arith.subi %t, %t0 : i64
+  %fp = arith.uitofp %delta : i64 to f64
+  func.call @printFlops(%fp) : (f64) -> ()
+  func.call @printI64(%delta) : (i64) -> ()
+
+  return %O : !TTqkv
+}
+
+func.func @main(){
+    %outputmain = func.call @attention() : () -> !TTqkv
+    return
+}
@@ -0,0 +1,29 @@
+import tensorflow as tf
+import numpy as np
+import time
+
+
+@tf.function(jit_compile=True)
+def attention(Q, K, V):
+    scores = tf.matmul(Q, K, transpose_b=True) / np.sqrt(64.0)
+    return tf.matmul(tf.nn.softmax(scores, axis=-1), V)
+# Create random query, key and value tensors (heads, sequence, head dimension)
+Q = tf.constant(np.random.rand(8, 512, 64), dtype=tf.float32)
+K = tf.constant(np.random.rand(8, 512, 64), dtype=tf.float32)
+V = tf.constant(np.random.rand(8, 512, 64), dtype=tf.float32)
+
+
+for i in range(6):
+    # Start timing
+    start_time = tf.timestamp()
+
+    # Run the attention block
+    result = attention(Q, K, V)
+
+    # End timing
+    end_time = tf.timestamp()
+
+    # Calculate the elapsed time
+    elapsed_time = end_time - start_time
+
+    print("Time elapsed for the attention block: {:.4f} seconds".format(elapsed_time.numpy()))
@@ -0,0 +1,40 @@
+func.func private @nanoTime() -> i64 attributes { llvm.emit_c_interface }
+func.func private @printFlops(f64)
+func.func private @printI64(i64)
+func.func private @printMemrefF32(tensor<*xf32>)
+
+!TTa = tensor<32x256x512xf32>
+!TTb = tensor<32x512x256xf32>
+!TTc = tensor<32x256x256xf32>
+
+
+func.func @batch_matmul() -> !TTc{
+
+  %val = arith.constant 2.00000e+00 : f32
+  %zero = arith.constant 0.00000e+00 : f32
+
+  %out = bufferization.alloc_tensor() : !TTa
+  %A = linalg.fill ins(%val : f32) outs(%out : !TTa) -> !TTa
+  %out1 = bufferization.alloc_tensor() : !TTb
+  %B = linalg.fill ins(%val : f32) outs(%out1 : !TTb) -> !TTb
+  %out2 = bufferization.alloc_tensor() : !TTc
+  %C = linalg.fill ins(%zero : f32) outs(%out2 : !TTc) -> !TTc
+
+  %t0 = func.call @nanoTime() : () -> (i64)
+
+  %D = linalg.batch_matmul ins(%A, %B: !TTa, !TTb)
+                          outs(%C: !TTc) -> !TTc
+
+  %t = func.call @nanoTime() : () -> (i64)
+  %delta = arith.subi %t, %t0 : i64
+  %fp = arith.uitofp %delta : i64 to f64
+  func.call @printFlops(%fp) : (f64) -> ()
+  func.call @printI64(%delta) : (i64) -> ()
+
+  return %D : !TTc
+}
+
+func.func @main(){
+    %outputmain = func.call @batch_matmul() : () -> !TTc
+    return
+}
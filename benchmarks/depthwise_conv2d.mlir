@@ -0,0 +1,38 @@
+func.func private @printMemrefF32(tensor<*xf32>)
+func.func private @nanoTime() -> i64 attributes { llvm.emit_c_interface }
+func.func private @printFlops(f64)
+func.func private @printI64(i64)
+
+!TTa = tensor<8x114x114x64xf32>
+!TTb = tensor<3x3x64xf32>
+!TTc = tensor<8x112x112x64xf32>
+func.func @conv() -> !TTc {
+
+  %val = arith.constant 2.00000e+00 : f32
+  %zero = arith.constant 0.00000e+00 : f32
+  %out = bufferization.alloc_tensor() : !TTa
+  %input = linalg.fill ins(%val : f32) outs(%out : !TTa) -> !TTa
+  %out1 = bufferization.alloc_tensor() : !TTb
+  %filter = linalg.fill ins(%val : f32) outs(%out1 : !TTb) -> !TTb
+  %out2 = bufferization.alloc_tensor() : !TTc
+  %output = linalg.fill ins(%zero : f32) outs(%out2 : !TTc) -> !TTc
+
+  %t0 = func.call @nanoTime() : () -> (i64)
+
+  %dense_ret = linalg.depthwise_conv_2d_nhwc_hwc {dilations = dense<1> : tensor<2xi64>,
+                                                   strides = dense<1> : tensor<2xi64>}
+     ins (%input, %filter: !TTa, !TTb)
+    outs (%output: !TTc) -> !TTc
+
+  %t1 = func.call @nanoTime() : () -> (i64)
+  %delta = arith.subi %t1, %t0 : i64
+  %fp = arith.uitofp %delta : i64 to f64
+  func.call @printFlops(%fp) : (f64) -> ()
+  func.call @printI64(%delta) : (i64) -> ()
+
+  return %dense_ret : !TTc
+}
+func.func @main(){
+    %outputmain = call @conv() : () -> !TTc
+    return
+}
@@ -0,0 +1,27 @@
+import tensorflow as tf
+import numpy as np
+import time
+@tf.function(jit_compile=True)
+def conv(input_tensor, filter_tensor):
+    return tf.nn.depthwise_conv2d(input_tensor, filter_tensor, strides=[1, 1, 1, 1], padding='VALID', data_format='NHWC')
+
+# Create a random 4D input tensor (batch_size, height, width, channels)
+input_tensor = tf.constant(np.random.rand(8, 114, 114, 64), dtype=tf.float32)
+# Filter (height, width, channels, channel_multiplier)
+filter_tensor = tf.constant(np.random.rand(3, 3, 64, 1), dtype=tf.float32)
+
+for i in range(6):
+# Start timing
+    start_time = tf.timestamp()
+
+    # Apply the depthwise convolution
+
+    output_tensor = conv(input_tensor, filter_tensor)
+
+    # End timing
+    end_time = tf.timestamp()
+
+    # Calculate the elapsed time
+    elapsed_time = end_time - start_time
+
+    print("Time elapsed for depthwise Conv2D operation: {:.4f} seconds".format(elapsed_time.numpy()))
@@ -0,0 +1,85 @@
+func.func private @nanoTime() -> i64 attributes { llvm.emit_c_interface }
+func.func private @printFlops(f64)
+func.func private @printI64(i64)
+func.func private @printMemrefF32(tensor<*xf32>)
+
+// Layer normalization on the rows, as linalg.generic reductions:
+// (x - mean(x)) / sqrt(var(x) + eps) * gamma + beta
+!TTin = tensor<1024x4096xf32>
+!TTrow = tensor<1024xf32>
+!TTcol = tensor<4096xf32>
+
+#map_2d = affine_map<(d0, d1) -> (d0, d1)>
+#map_row = affine_map<(d0, d1) -> (d0)>
+#map_col = affine_map<(d0, d1) -> (d1)>
+
+func.func @layernorm() -> !TTin{
+
+  %val = arith.constant 2.00000e+00 : f32
+  %gamma_val = arith.constant 1.50000e+00 : f32
+  %beta_val = arith.constant 5.00000e-01 : f32
+  %zero = arith.constant 0.00000e+00 : f32
+  %n = arith.constant 4.09600e+03 : f32
+  %eps = arith.constant 1.00000e-05 : f32
+
+  %out = bufferization.alloc_tensor() : !TTin
+  %X = linalg.fill ins(%val : f32) outs(%out : !TTin) -> !TTin
+  %out1 = bufferization.alloc_tensor() : !TTcol
+  %gamma = linalg.fill ins(%gamma_val : f32) outs(%out1 : !TTcol) -> !TTcol
+  %out2 = bufferization.alloc_tensor() : !TTcol
+  %beta = linalg.fill ins(%beta_val : f32) outs(%out2 : !TTcol) -> !TTcol
+  %out3 = bufferization.alloc_tensor() : !TTrow
+  %sum_init = linalg.fill ins(%zero : f32) outs(%out3 : !TTrow) -> !TTrow
+  %out4 = bufferization.alloc_tensor() : !TTrow
+  %var_init = linalg.fill ins(%zero : f32) outs(%out4 : !TTrow) -> !TTrow
+  %out5 = bufferization.alloc_tensor() : !TTin
+
+  %t0 = func.call @nanoTime() : () -> (i64)
+
+  %sum = linalg.generic {indexing_maps = [#map_2d, #map_row],
+                         iterator_types = ["parallel", "reduction"]}
+      ins(%X : !TTin) outs(%sum_init : !TTrow) {
+    ^bb0(%in: f32, %acc: f32):
+      %s = arith.addf %in, %acc : f32
+      linalg.yield %s : f32
+  } -> !TTrow
+
+  %var = linalg.generic {indexing_maps = [#map_2d, #map_row, #map_row],
+                         iterator_types = ["parallel", "reduction"]}
+      ins(%X, %sum : !TTin, !TTrow) outs(%var_init : !TTrow) {
+    ^bb0(%in: f32, %s: f32, %acc: f32):
+      %mean = arith.divf %s, %n : f32
+      %diff = arith.subf %in, %mean : f32
+      %sq = arith.mulf %diff, %diff : f32
+      %v = arith.addf %sq, %acc : f32
+      linalg.yield %v : f32
+  } -> !TTrow
+
+  %Y = linalg.generic {indexing_maps = [#map_2d, #map_row, #map_row, #map_col, #map_col, #map_2d],
+                       iterator_types = ["parallel", "parallel"]}
+      ins(%X, %sum, %var, %gamma, %beta : !TTin, !TTrow, !TTrow, !TTcol, !TTcol) outs(%out5 : !TTin) {
+    ^bb0(%in: f32, %s: f32, %v: f32, %g: f32, %b: f32, %o: f32):
+      %mean = arith.divf %s, %n : f32
+      %diff = arith.subf %in, %mean : f32
+      %variance = arith.divf %v, %n : f32
+      %var_eps = arith.addf %variance, %eps : f32
+      %rstd = math.rsqrt %var_eps : f32
+      %norm = arith.mulf %diff, %rstd : f32
+      %scaled = arith.mulf %norm, %g : f32
+      %res = arith.addf %scaled, %b : f32
+      linalg.yield %res : f32
+  } -> !TTin
+
+  %t = func.call @nanoTime() : () -> (i64)
+  %delta = arith.subi %t, %t0 : i64
+  %fp = arith.uitofp %delta : i64 to f64
+  func.call @printFlops(%fp) : (f64) -> ()
+  func.call @printI64(%delta) : (i64) -> ()
+
+  return %Y : !TTin
+}
+
+func.func @main(){
+    %outputmain = func.call @layernorm() : () -> !TTin
+    return
+}
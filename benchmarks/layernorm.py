@@ -0,0 +1,29 @@
+import tensorflow as tf
+import numpy as np
+import time
+
+
+@tf.function(jit_compile=True)
+def layernorm(X, gamma, beta):
+    mean, variance = tf.nn.moments(X, axes=[-1], keepdims=True)
+    return tf.nn.batch_normalization(X, mean, variance, beta, gamma, 1e-5)
+# Create a random input tensor X, the scale gamma and the offset beta
+X = tf.constant(np.random.rand(1024, 4096), dtype=tf.float32)
+gamma = tf.constant(np.random.rand(4096), dtype=tf.float32)
+beta = tf.constant(np.random.rand(4096), dtype=tf.float32)
+
+
+for i in range(6):
+    # Start timing
+    start_time = tf.timestamp()
+
+    # Normalize the rows
+    result = layernorm(X, gamma, beta)
+
+    # End timing
+    end_time = tf.timestamp()
+
+    # Calculate the elapsed time
+    elapsed_time = end_time - start_time
+
+    print("Time elapsed for layernorm: {:.4f} seconds".format(elapsed_time.numpy()))
@@ -0,0 +1,65 @@
+func.func private @nanoTime() -> i64 attributes { llvm.emit_c_interface }
+func.func private @printFlops(f64)
+func.func private @printI64(i64)
+func.func private @printMemrefF32(tensor<*xf32>)
+
+// Fully connected layer: relu(A x B + bias), the bias is broadcast on the rows
+!TTa = tensor<1024x1024xf32>
+!TTb = tensor<1024x1024xf32>
+!TTc = tensor<1024x1024xf32>
+!TTbias = tensor<1024xf32>
+
+#map_2d = affine_map<(d0, d1) -> (d0, d1)>
+#map_col = affine_map<(d0, d1) -> (d1)>
+
+func.func @matmul_bias_relu() -> !TTc{
+
+  %val = arith.constant 2.00000e+00 : f32
+  %bias_val = arith.constant -1.00000e+00 : f32
+  %zero = arith.constant 0.00000e+00 : f32
+
+  %out = bufferization.alloc_tensor() : !TTa
+  %A = linalg.fill ins(%val : f32) outs(%out : !TTa) -> !TTa
+  %out1 = bufferization.alloc_tensor() : !TTb
+  %B = linalg.fill ins(%val : f32) outs(%out1 : !TTb) -> !TTb
+  %out2 = bufferization.alloc_tensor() : !TTbias
+  %bias = linalg.fill ins(%bias_val : f32) outs(%out2 : !TTbias) -> !TTbias
+  %out3 = bufferization.alloc_tensor() : !TTc
+  %C = linalg.fill ins(%zero : f32) outs(%out3 : !TTc) -> !TTc
+  %out4 = bufferization.alloc_tensor() : !TTc
+  %out5 = bufferization.alloc_tensor() : !TTc
+
+  %t0 = func.call @nanoTime() : () -> (i64)
+
+  %D = linalg.matmul ins(%A, %B: !TTa, !TTb)
+                    outs(%C: !TTc) -> !TTc
+
+  %E = linalg.generic {indexing_maps = [#map_2d, #map_col, #map_2d],
+                       iterator_types = ["parallel", "parallel"]}
+      ins(%D, %bias : !TTc, !TTbias) outs(%out4 : !TTc) {
+    ^bb0(%in: f32, %b: f32, %o: f32):
+      %add = arith.addf %in, %b : f32
+      linalg.yield %add : f32
+  } -> !TTc
+
+  %F = linalg.generic {indexing_maps = [#map_2d, #map_2d],
+                       iterator_types = ["parallel", "parallel"]}
+      ins(%E : !TTc) outs(%out5 : !TTc) {
+    ^bb0(%in: f32, %o: f32):
+      %relu = arith.maximumf %in, %zero : f32
+      linalg.yield %relu : f32
+  } -> !TTc
+
+  %t = func.call @nanoTime() : () -> (i64)
+  %delta = arith.subi %t, %t0 : i64
+  %fp = arith.uitofp %delta : i64 to f64
+  func.call @printFlops(%fp) : (f64) -> ()
+  func.call @printI64(%delta) : (i64) -> ()
+
+  return %F : !TTc
+}
+
+func.func @main(){
+    %outputmain = func.call @matmul_bias_relu() : () -> !TTc
+    return
+}
@@ -0,0 +1,28 @@
+import tensorflow as tf
+import numpy as np
+import time
+
+
+@tf.function(jit_compile=True)
+def matmul_bias_relu(A, B, bias):
+    return tf.nn.relu(tf.matmul(A, B) + bias)
+# Create random input tensors A, B and the bias
+A = tf.constant(np.random.rand(1024, 1024), dtype=tf.float32)
+B = tf.constant(np.random.rand(1024, 1024), dtype=tf.float32)
+bias = tf.constant(np.random.rand(1024), dtype=tf.float32)
+
+
+for i in range(6):
+    # Start timing
+    start_time = tf.timestamp()
+
+    # Perform relu(A x B + bias)
+    result = matmul_bias_relu(A, B, bias)
+
+    # End timing
+    end_time = tf.timestamp()
+
+    # Calculate the elapsed time
+    elapsed_time = end_time - start_time
+
+    print("Time elapsed for matmul+bias+relu: {:.4f} seconds".format(elapsed_time.numpy()))
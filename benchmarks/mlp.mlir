@@ -0,0 +1,76 @@
+func.func private @nanoTime() -> i64 attributes { llvm.emit_c_interface }
+func.func private @printFlops(f64)
+func.func private @printI64(i64)
+func.func private @printMemrefF32(tensor<*xf32>)
+
+// MLP block of three layers: relu(relu(X x W1) x W2) x W3
+!TTx = tensor<512x1024xf32>
+!TTw1 = tensor<1024x2048xf32>
+!TTh1 = tensor<512x2048xf32>
+!TTw2 = tensor<2048x1024xf32>
+!TTh2 = tensor<512x1024xf32>
+!TTw3 = tensor<1024x512xf32>
+!TTy = tensor<512x512xf32>
+
+#map_2d = affine_map<(d0, d1) -> (d0, d1)>
+
+func.func @mlp() -> !TTy{
+
+  %val = arith.constant 2.00000e-02 : f32
+  %zero = arith.constant 0.00000e+00 : f32
+
+  %out = bufferization.alloc_tensor() : !TTx
+  %X = linalg.fill ins(%val : f32) outs(%out : !TTx) -> !TTx
+  %out1 = bufferization.alloc_tensor() : !TTw1
+  %W1 = linalg.fill ins(%val : f32) outs(%out1 : !TTw1) -> !TTw1
+  %out2 = bufferization.alloc_tensor() : !TTw2
+  %W2 = linalg.fill ins(%val : f32) outs(%out2 : !TTw2) -> !TTw2
+  %out3 = bufferization.alloc_tensor() : !TTw3
+  %W3 = linalg.fill ins(%val : f32) outs(%out3 : !TTw3) -> !TTw3
+  %out4 = bufferization.alloc_tensor() : !TTh1
+  %C1 = linalg.fill ins(%zero : f32) outs(%out4 : !TTh1) -> !TTh1
+  %out5 = bufferization.alloc_tensor() : !TTh2
+  %C2 = linalg.fill ins(%zero : f32) outs(%out5 : !TTh2) -> !TTh2
+  %out6 = bufferization.alloc_tensor() : !TTy
+  %C3 = linalg.fill ins(%zero : f32) outs(%out6 : !TTy) -> !TTy
+  %out7 = bufferization.alloc_tensor() : !TTh1
+  %out8 = bufferization.alloc_tensor() : !TTh2
+
+  %t0 = func.call @nanoTime() : () -> (i64)
+
+  %H1 = linalg.matmul ins(%X, %W1: !TTx, !TTw1)
+                     outs(%C1: !TTh1) -> !TTh1
+  %R1 = linalg.generic {indexing_maps = [#map_2d, #map_2d],
+                        iterator_types = ["parallel", "parallel"]}
+      ins(%H1 : !TTh1) outs(%out7 : !TTh1) {
+    ^bb0(%in: f32, %o: f32):
+      %relu = arith.maximumf %in, %zero : f32
+      linalg.yield %relu : f32
+  } -> !TTh1
+
+  %H2 = linalg.matmul ins(%R1, %W2: !TTh1, !TTw2)
+                     outs(%C2: !TTh2) -> !TTh2
+  %R2 = linalg.generic {indexing_maps = [#map_2d, #map_2d],
+                        iterator_types = ["parallel", "parallel"]}
+      ins(%H2 : !TTh2) outs(%out8 : !TTh2) {
+    ^bb0(%in: f32, %o: f32):
+      %relu = arith.maximumf %in, %zero : f32
+      linalg.yield %relu : f32
+  } -> !TTh2
+
+  %Y = linalg.matmul ins(%R2, %W3: !TTh2, !TTw3)
+                    outs(%C3: !TTy) -> !TTy
+
+  %t = func.call @nanoTime() : () -> (i64)
+  %delta = arith.subi %t, %t0 : i64
+  %fp = arith.uitofp %delta : i64 to f64
+  func.call @printFlops(%fp) : (f64) -> ()
+  func.call @printI64(%delta) : (i64) -> ()
+
+  return %Y : !TTy
+}
+
+func.func @main(){
+    %outputmain = func.call @mlp() : () -> !TTy
+    return
+}
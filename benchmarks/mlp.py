@@ -0,0 +1,31 @@
+import tensorflow as tf
+import numpy as np
+import time
+
+
+@tf.function(jit_compile=True)
+def mlp(X, W1, W2, W3):
+    H1 = tf.nn.relu(tf.matmul(X, W1))
+    H2 = tf.nn.relu(tf.matmul(H1, W2))
+    return tf.matmul(H2, W3)
+# Create random input tensors X and the weights of the three layers
+X = tf.constant(np.random.rand(512, 1024), dtype=tf.float32)
+W1 = tf.constant(np.random.rand(1024, 2048), dtype=tf.float32)
+W2 = tf.constant(np.random.rand(2048, 1024), dtype=tf.float32)
+W3 = tf.constant(np.random.rand(1024, 512), dtype=tf.float32)
+
+
+for i in range(6):
+    # Start timing
+    start_time = tf.timestamp()
+
+    # Run the three layers
+    result = mlp(X, W1, W2, W3)
+
+    # End timing
+    end_time = tf.timestamp()
+
+    # Calculate the elapsed time
+    elapsed_time = end_time - start_time
+
+    print("Time elapsed for the MLP block: {:.4f} seconds".format(elapsed_time.numpy()))
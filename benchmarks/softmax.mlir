@@ -0,0 +1,76 @@
+func.func private @nanoTime() -> i64 attributes { llvm.emit_c_interface }
+func.func private @printFlops(f64)
+func.func private @printI64(i64)
+func.func private @printMemrefF32(tensor<*xf32>)
+
+// Softmax on the rows, as linalg.generic reductions:
+// exp(x - max(x)) / sum(exp(x - max(x)))
+!TTin = tensor<1024x4096xf32>
+!TTrow = tensor<1024xf32>
+
+#map_2d = affine_map<(d0, d1) -> (d0, d1)>
+#map_row = affine_map<(d0, d1) -> (d0)>
+
+func.func @softmax() -> !TTin{
+
+  %val = arith.constant 2.00000e+00 : f32
+  %zero = arith.constant 0.00000e+00 : f32
+  %minus_inf = arith.constant 0xFF800000 : f32
+
+  %out = bufferization.alloc_tensor() : !TTin
+  %X = linalg.fill ins(%val : f32) outs(%out : !TTin) -> !TTin
+  %out1 = bufferization.alloc_tensor() : !TTrow
+  %max_init = linalg.fill ins(%minus_inf : f32) outs(%out1 : !TTrow) -> !TTrow
+  %out2 = bufferization.alloc_tensor() : !TTrow
+  %sum_init = linalg.fill ins(%zero : f32) outs(%out2 : !TTrow) -> !TTrow
+  %out3 = bufferization.alloc_tensor() : !TTin
+  %out4 = bufferization.alloc_tensor() : !TTin
+
+  %t0 = func.call @nanoTime() : () -> (i64)
+
+  %max = linalg.generic {indexing_maps = [#map_2d, #map_row],
+                         iterator_types = ["parallel", "reduction"]}
+      ins(%X : !TTin) outs(%max_init : !TTrow) {
+    ^bb0(%in: f32, %acc: f32):
+      %m = arith.maximumf %in, %acc : f32
+      linalg.yield %m : f32
+  } -> !TTrow
+
+  %exp = linalg.generic {indexing_maps = [#map_2d, #map_row, #map_2d],
+                         iterator_types = ["parallel", "parallel"]}
+      ins(%X, %max : !TTin, !TTrow) outs(%out3 : !TTin) {
+    ^bb0(%in: f32, %m: f32, %o: f32):
+      %sub = arith.subf %in, %m : f32
+      %e = math.exp %sub : f32
+      linalg.yield %e : f32
+  } -> !TTin
+
+  %sum = linalg.generic {indexing_maps = [#map_2d, #map_row],
+                         iterator_types = ["parallel", "reduction"]}
+      ins(%exp : !TTin) outs(%sum_init : !TTrow) {
+    ^bb0(%in: f32, %acc: f32):
+      %s = arith.addf %in, %acc : f32
+      linalg.yield %s : f32
+  } -> !TTrow
+
+  %Y = linalg.generic {indexing_maps = [#map_2d, #map_row, #map_2d],
+                       iterator_types = ["parallel", "parallel"]}
+      ins(%exp, %sum : !TTin, !TTrow) outs(%out4 : !TTin) {
+    ^bb0(%in: f32, %s: f32, %o: f32):
+      %div = arith.divf %in, %s : f32
+      linalg.yield %div : f32
+  } -> !TTin
+
+  %t = func.call @nanoTime() : () -> (i64)
+  %delta = arith.subi %t, %t0 : i64
+  %fp = arith.uitofp %delta : i64 to f64
+  func.call @printFlops(%fp) : (f64) -> ()
+  func.call @printI64(%delta) : (i64) -> ()
+
+  return %Y : !TTin
+}
+
+func.func @main(){
+    %outputmain = func.call @softmax() : () -> !TTin
+    return
+}
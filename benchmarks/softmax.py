@@ -0,0 +1,26 @@
+import tensorflow as tf
+import numpy as np
+import time
+
+
+@tf.function(jit_compile=True)
+def softmax(X):
+    return tf.nn.softmax(X, axis=-1)
+# Create a random input tensor X
+X = tf.constant(np.random.rand(1024, 4096), dtype=tf.float32)
+
+
+for i in range(6):
+    # Start timing
+    start_time = tf.timestamp()
+
+    # Apply the softmax on the rows
+    result = softmax(X)
+
+    # End timing
+    end_time = tf.timestamp()
+
+    # Calculate the elapsed time
+    elapsed_time = end_time - start_time
+
+    print("Time elapsed for softmax: {:.4f} seconds".format(elapsed_time.numpy()))
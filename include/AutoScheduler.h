@@ -0,0 +1,172 @@
+//===---------------------------- AutoScheduler.h -------------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the AutoScheduler class, the entry
+/// point of the MLAutoScheduler library. It owns the MLIR context of the search
+/// and exposes the operations of the tool: searching the schedule of a module
+/// under a configuration, applying a schedule to a module, and querying and
+/// replaying the schedules of the tuning database. AutoSchedulerML is a client
+/// of this class, AutoSchedulerC.h wraps it for the C callers
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLSCEDULER_AUTO_SCHEDULER_H_
+#define MLSCEDULER_AUTO_SCHEDULER_H_
+
+#include "Node.h"
+#include "MLIRCodeIR.h"
+#include "Transformation.h"
+#include "ContextPool.h"
+#include "Roofline.h"
+#include "TuningDatabase.h"
+
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/// Options of a search. fromEnvironment() reads the environment variables of
+/// AutoSchedulerML, the default values are the ones of the tool without them.
+struct TuningConfig{
+    /// Name of the benchmark: the key of the tuning database and the prefix of
+    /// the logs.
+    std::string name;
+    /// Budget of the search (AS_MAX_EVALUATIONS, AS_TIME_BUDGET), 0 is no limit.
+    int maxEvaluations = 0;
+    double timeBudget = 0;
+    /// Searches the fast-math flags (AS_FASTMATH=1).
+    bool fastMath = false;
+    /// Computes the roofline bound (AS_ROOFLINE=1), the search stops within
+    /// rooflineStopFraction of it (AS_ROOFLINE_STOP_FRACTION, 0 never stops).
+    bool roofline = false;
+    double rooflineStopFraction = 0;
+    /// Tuning database (AS_TUNING_DB), an empty path keeps the opened one.
+    std::string tuningDbPath;
+    /// Stores the best schedule in the tuning database.
+    bool recordSchedule = true;
+    /// Runs of the stored schedule and slowdown in percent reported as a
+    /// regression (AS_REGRESS_REPEAT, AS_REGRESS_THRESHOLD).
+    int regressRepeat = 3;
+    double regressThreshold = 10;
+    /// Seed of the sampling of the candidates (AS_SEED), the random engine is
+    /// seeded with it at the start of each search. -1 keeps the engine as is.
+    int64_t seed = -1;
+
+    static TuningConfig fromEnvironment(const std::string &name);
+
+    /// Returns the file of the logs of the evaluations.
+    std::string getLogsFileName() const;
+};
+
+/// Result of a search. The nodes of the search tree belong to the arena, the
+/// best node is freed by the search: its evaluation and its schedule are kept.
+struct TuningResult{
+    /// Root of the search tree, holds the schedules printed in the report.
+    Node *root = nullptr;
+    /// The nodes kept in the tree: the root and the parallelization candidates.
+    std::vector<Node *> treeNodes;
+    std::string rootEvaluation;
+    /// Lowest evaluation of the search (nanoseconds), empty if every candidate
+    /// failed.
+    std::string bestEvaluation;
+    std::vector<Transformation *> bestSchedule;
+    /// Candidates run, and candidates given a stored run by the evaluation cache
+    /// (not counted in evaluations nor in the budget).
+    int evaluations = 0;
+    int cachedEvaluations = 0;
+    int skippedEvaluations = 0;
+    int verificationFailures = 0;
+    /// Roofline of the code, when TuningConfig::roofline is set.
+    KernelCost kernelCost;
+    double rooflineGflops = 0;
+    bool targetReached = false;
+    /// True if the best schedule replaced the entry of the tuning database.
+    bool recorded = false;
+
+    /// Returns the printed transformations of the best schedule.
+    std::string printBestSchedule() const;
+};
+
+/// Result of the replay of the stored schedule of a benchmark.
+struct RegressionResult{
+    /// False if the database has no (readable) schedule for the benchmark.
+    bool found = false;
+    TuningRecord record;
+    std::string rootEvaluation;
+    /// Fastest run of the stored schedule, none if it failed to run.
+    std::optional<double> time;
+    double slowdown = 0;
+    bool regression = false;
+    int evaluations = 0;
+};
+
+class AutoScheduler{
+    private:
+        mlir::DialectRegistry registry;
+        std::unique_ptr<mlir::MLIRContext> context;
+        /// Worker contexts applying the transformations of the candidates in
+        /// parallel.
+        std::unique_ptr<ContextPool> contextPool;
+        /// Codes loaded by the scheduler, the roots of the searches. They live as
+        /// long as the scheduler since the nodes of the arena refer to them.
+        std::vector<std::unique_ptr<MLIRCodeIR>> codes;
+
+    public:
+        /// Creates the context of the search with the dialects and the
+        /// extensions used by the transformations.
+        AutoScheduler();
+        AutoScheduler(const AutoScheduler &) = delete;
+        AutoScheduler &operator=(const AutoScheduler &) = delete;
+
+        /// Registers the dialects, translations and transform extensions of the
+        /// search in the registry.
+        static void registerDialects(mlir::DialectRegistry &registry);
+
+        mlir::MLIRContext *getContext();
+
+        /// Parses the file, returns the module (NULL on error) and sets code to
+        /// the code representation to search from.
+        mlir::OwningOpRef<mlir::Operation *> parseFile(llvm::StringRef filename, MLIRCodeIR *&code);
+
+        /// Parses the MLIR source, returns NULL on error. The diagnostics of the
+        /// parser are appended to diagnostics when it is given.
+        mlir::OwningOpRef<mlir::Operation *> parseSource(llvm::StringRef source, std::string *diagnostics = nullptr);
+
+        /// Returns the code representation of a clone of the module, owned by the
+        /// scheduler.
+        MLIRCodeIR *loadModule(mlir::Operation *module);
+
+        /// Searches the schedule of the code with the greedy search of the tool:
+        /// parallelization and vectorization of the operations, then tiling,
+        /// inter-op concurrency, bufferization and fast-math on each
+        /// parallelization candidate.
+        TuningResult tune(MLIRCodeIR *code, const TuningConfig &config);
+
+        /// Frees the search tree of the result and the code it was searched from,
+        /// for the clients running many searches (the daemon). With an empty
+        /// result only the code is freed. The code and the nodes must not be used
+        /// anymore.
+        void releaseSearch(MLIRCodeIR *code, TuningResult &result);
+
+        /// Applies the schedule to a clone of the code, returns the full module
+        /// (owned by the caller), null if the code cannot be materialized.
+        mlir::OwningOpRef<mlir::Operation *> applySchedule(MLIRCodeIR *code,
+                                                           const std::vector<Transformation *> &schedule);
+
+        /// Reads the stored schedule of the benchmark from the tuning database of
+        /// the configuration, returns false if it has no entry.
+        bool lookupSchedule(const TuningConfig &config, TuningRecord &record);
+
+        /// Evaluates the root code and the stored schedule of the benchmark
+        /// (regressRepeat times, the fastest run is kept) and compares it with
+        /// the recorded time.
+        RegressionResult checkRegression(MLIRCodeIR *code, const TuningConfig &config);
+};
+
+#endif // MLSCEDULER_AUTO_SCHEDULER_H_
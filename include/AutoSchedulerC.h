@@ -0,0 +1,102 @@
+/*===--------------------------- AutoSchedulerC.h -------------------------===*\
+|*                                                                            *|
+|*===----------------------------------------------------------------------===*|
+|*                                                                            *|
+|* This file contains the C API of the MLAutoScheduler library, for the       *|
+|* compiler drivers embedding the auto-scheduler. The modules and the         *|
+|* schedules cross the API as text: MLIR source for the modules, and the JSON *|
+|* array of the transformations of the tuning database for the schedules.     *|
+|* The strings returned by the API are freed with asFreeString. A scheduler   *|
+|* is used by one thread at a time.                                           *|
+|*                                                                            *|
+\*===----------------------------------------------------------------------===*/
+#ifndef MLSCEDULER_AUTO_SCHEDULER_C_H_
+#define MLSCEDULER_AUTO_SCHEDULER_C_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Opaque handle of an AutoScheduler and of its MLIR context. */
+typedef struct AsScheduler AsScheduler;
+
+/** Options of a search, see TuningConfig. */
+typedef struct AsTuningConfig {
+  /** Name of the benchmark, the key of the tuning database. */
+  const char *name;
+  int maxEvaluations;
+  double timeBudget;
+  int fastMath;
+  int roofline;
+  double rooflineStopFraction;
+  /** Path of the tuning database, NULL keeps the opened one. */
+  const char *tuningDbPath;
+  int recordSchedule;
+  /** Seed of the sampling of the candidates, -1 keeps the random engine. */
+  long long seed;
+} AsTuningConfig;
+
+/** Result of a search, the strings belong to the caller. */
+typedef struct AsTuningResult {
+  /** Evaluations in nanoseconds, bestTime is 0 if every candidate failed. */
+  double rootTime;
+  double bestTime;
+  /** Candidates run, and candidates given a stored run by the evaluation cache
+   *  (not counted in evaluations nor in the budget). */
+  int evaluations;
+  int cachedEvaluations;
+  int skippedEvaluations;
+  int verificationFailures;
+  int recorded;
+  /** JSON array of the transformations of the best schedule. */
+  char *schedule;
+  /** The module transformed by the best schedule, null if the schedule could
+   *  not be applied. */
+  char *module;
+} AsTuningResult;
+
+/** Returns a new scheduler, NULL if it could not be created. */
+AsScheduler *asSchedulerCreate(void);
+
+void asSchedulerDestroy(AsScheduler *scheduler);
+
+/** Returns the message of the last failed call, empty if there is none. The
+ * message belongs to the scheduler. */
+const char *asGetLastError(AsScheduler *scheduler);
+
+/** Fills the configuration with the environment variables of AutoSchedulerML
+ * (AS_MAX_EVALUATIONS, AS_TIME_BUDGET, AS_FASTMATH, AS_ROOFLINE...). The
+ * strings of the configuration are not copied, the name is kept. */
+void asTuningConfigInit(AsTuningConfig *config, const char *name);
+
+/** Searches the schedule of the MLIR module. Returns 0 on success. */
+int asTune(AsScheduler *scheduler, const char *module, const AsTuningConfig *config,
+           AsTuningResult *result);
+
+/** Searches the schedule of the module of the MLIR file. Returns 0 on
+ * success. */
+int asTuneFile(AsScheduler *scheduler, const char *filename, const AsTuningConfig *config,
+               AsTuningResult *result);
+
+/** Frees the strings of the result. */
+void asTuningResultDispose(AsTuningResult *result);
+
+/** Applies the schedule (JSON array of transformations) to the MLIR module,
+ * the transformed module is returned in transformedModule. Returns 0 on
+ * success. */
+int asApplySchedule(AsScheduler *scheduler, const char *module, const char *schedule,
+                    char **transformedModule);
+
+/** Reads the stored schedule of the benchmark from the tuning database
+ * (NULL: the opened one). Returns 0 if the benchmark has an entry, its
+ * schedule and its recorded time are returned. */
+int asLookupSchedule(AsScheduler *scheduler, const char *tuningDbPath, const char *name,
+                     char **schedule, double *time);
+
+void asFreeString(char *string);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MLSCEDULER_AUTO_SCHEDULER_C_H_ */
@@ -0,0 +1,78 @@
+//===------------------------- AutoSchedulerDaemon.h ----------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the AutoSchedulerDaemon class, the
+/// daemon mode of AutoSchedulerML (AutoSchedulerML --daemon <socket>). The
+/// daemon keeps one AutoScheduler (the MLIR context with its dialects and the
+/// worker contexts), the tuning database, the evaluation cache and the results
+/// of the searches across the requests received on a Unix socket.
+///
+/// Each message is a 4-byte big-endian length followed by a JSON object. The
+/// requests are {"op": "tune", "name", "module" (MLIR source) or "file",
+/// "max_evaluations", "time_budget", "fast_math", "record", "seed"}, {"op": "apply",
+/// "module" or "file", "schedule"}, {"op": "lookup", "name"}, {"op": "stats"},
+/// {"op": "ping"} and {"op": "shutdown"}. Each response has a "status" ("ok"
+/// or "error" with an "error" message). The requests are served one at a time.
+/// The responses of the last AS_DAEMON_CACHE_SIZE (256 by default) tune
+/// requests are kept, and the evaluation cache is on unless AS_EVALUATION_CACHE
+/// is 0
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLSCEDULER_AUTO_SCHEDULER_DAEMON_H_
+#define MLSCEDULER_AUTO_SCHEDULER_DAEMON_H_
+
+#include "AutoScheduler.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/JSON.h"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+
+class AutoSchedulerDaemon{
+    private:
+        std::string socketPath;
+        int listenSocket = -1;
+        AutoScheduler scheduler;
+
+        /// Responses of the tune requests by hash of the request (module and
+        /// options), the identical kernels are only searched once.
+        llvm::DenseMap<uint64_t, llvm::json::Object> results;
+        std::deque<uint64_t> resultOrder;
+        size_t resultCapacity = 256;
+
+        int numRequests = 0;
+        int numSearches = 0;
+        int resultHits = 0;
+        bool stopping = false;
+
+        /// Reads a message, returns false at the end of the connection.
+        static bool readMessage(int client, std::string &message);
+        static bool writeMessage(int client, const std::string &message);
+
+        void serveClient(int client);
+        llvm::json::Object handleRequest(llvm::StringRef message);
+        llvm::json::Object handleTune(const llvm::json::Object &request);
+        llvm::json::Object handleApply(const llvm::json::Object &request);
+        llvm::json::Object handleLookup(const llvm::json::Object &request);
+        llvm::json::Object handleStats();
+
+        /// Reads the module of the request ("module" or "file"), returns false
+        /// and sets error if it has none.
+        static bool readModuleSource(const llvm::json::Object &request, std::string &source, std::string &error);
+
+    public:
+        AutoSchedulerDaemon(const std::string &socketPath);
+        AutoSchedulerDaemon(const AutoSchedulerDaemon &) = delete;
+        AutoSchedulerDaemon &operator=(const AutoSchedulerDaemon &) = delete;
+        ~AutoSchedulerDaemon();
+
+        /// Serves the requests until a shutdown request, SIGINT or SIGTERM.
+        /// Returns the exit status of the tool.
+        int run();
+};
+
+#endif // MLSCEDULER_AUTO_SCHEDULER_DAEMON_H_
@@ -17,6 +17,8 @@
 #include "InterchangeTransformation.h"
 #include "ParallelizationTransformation.h"
 #include "VectorizationTransformation.h"
+#include "SearchTreeArena.h"
+#include "Logger.h"
 
 #include <queue>
 
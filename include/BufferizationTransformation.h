@@ -0,0 +1,68 @@
+//===----------------------- BufferizationTransformation.h ----------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the BufferizationTransformation class, which
+/// contains the declartion of the bufferization strategy: the options of the
+/// one-shot bufferization used to lower a candidate, searched like the other
+/// transformations of the schedule
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef MLSCEDULER_BUFFERIZATION_TRANSFORMATION_H_
+#define MLSCEDULER_BUFFERIZATION_TRANSFORMATION_H_
+
+#include "Transformation.h"
+#include "MLIRCodeIR.h"
+#include "Node.h"
+#include "SearchTreeArena.h"
+#include "Tracing.h"
+#include "Utils.h"
+
+#include "mlir/Dialect/Bufferization/IR/Bufferization.h"
+#include "mlir/Dialect/Bufferization/Transforms/OneShotAnalysis.h"
+
+#include <iostream>
+
+class BufferizationStrategy: public Transformation{
+    private:
+        mlir::bufferization::LayoutMapOption functionBoundaryLayout;
+        mlir::bufferization::OneShotBufferizationOptions::AnalysisHeuristic heuristic;
+        bool copyBeforeWrite;
+        bool emptyTensorElimination;
+        mlir::MLIRContext *context;
+    public:
+        /// Constructor for the default strategy of the evaluation pipeline.
+        BufferizationStrategy(mlir::MLIRContext *context);
+
+        BufferizationStrategy(mlir::bufferization::LayoutMapOption functionBoundaryLayout,
+                              mlir::bufferization::OneShotBufferizationOptions::AnalysisHeuristic heuristic,
+                              bool copyBeforeWrite, bool emptyTensorElimination, mlir::MLIRContext *context);
+
+        /// Leaves the code unchanged, the options are used by the evaluation
+        /// pipeline.
+        /// Overrides the applyTransformation() method from the base class Transformation.
+        void applyTransformation(CodeIR CodeIr) override;
+        std::string printTransformation() override;
+        std::string getType() override;
+
+        /// Sets the one-shot bufferization options of the strategy.
+        void configureOptions(mlir::bufferization::OneShotBufferizationOptions &options);
+        bool getEmptyTensorElimination();
+        mlir::bufferization::LayoutMapOption getFunctionBoundaryLayout();
+        mlir::bufferization::OneShotBufferizationOptions::AnalysisHeuristic getHeuristic();
+        bool getCopyBeforeWrite();
+
+        /// Creates a list of bufferization candidates for the given node, each one
+        /// changing one option of the default strategy. The buffers are always
+        /// deallocated, and keep the memory space of the input code: the runner
+        /// of the evaluations only executes the default memory space.
+        static SmallVector<Node* , 2>  createBufferizationCandidates(Node *node, mlir::MLIRContext *context);
+
+        /// Returns the last bufferization strategy of the schedule of the node, or
+        /// NULL if it uses the default one.
+        static BufferizationStrategy *getBufferizationStrategy(Node *node);
+};
+
+#endif // MLSCEDULER_BUFFERIZATION_TRANSFORMATION_H_
@@ -0,0 +1,64 @@
+//===----------------------- ConcurrencyTransformation.h ----------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the ConcurrencyTransformation class, which
+/// contains the declartion of the inter-op concurrency transformation: independent
+/// linalg operations run at the same time, each one with a part of the threads
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef MLSCEDULER_CONCURRENCY_TRANSFORMATION_H_
+#define MLSCEDULER_CONCURRENCY_TRANSFORMATION_H_
+
+#include "Transformation.h"
+#include "MLIRCodeIR.h"
+#include "Node.h"
+#include "SearchTreeArena.h"
+#include "Tracing.h"
+#include "Utils.h"
+#include "OpDependenceGraph.h"
+#include "CustomPasses/Passes.h"
+
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+
+#include <iostream>
+#include <thread>
+
+class InterOpConcurrency: public Transformation{
+    private:
+        /// The stages that run concurrently and the number of threads of each one.
+        llvm::SmallVector<int, 4> stages;
+        llvm::SmallVector<int64_t, 4> numThreads;
+        /// Identifies the group in the IR, several groups can be applied to a module.
+        int groupId;
+        mlir::MLIRContext *context;
+    public:
+        InterOpConcurrency();
+
+        /// Constructor for InterOpConcurrency that allows specifying the stages and their threads.
+        InterOpConcurrency(llvm::SmallVector<int, 4> stages, llvm::SmallVector<int64_t, 4> numThreads,
+                           int groupId, mlir::MLIRContext *context);
+
+        /// Tags the operations of the stages with the group and their threads, the
+        /// tags are lowered to OpenMP sections by the evaluation pipeline.
+        /// Overrides the applyTransformation() method from the base class Transformation.
+        void applyTransformation(CodeIR CodeIr) override;
+        std::string printTransformation() override;
+        std::string getType() override;
+
+        llvm::SmallVector<int, 4> getStages();
+        llvm::SmallVector<int64_t, 4> getNumThreads();
+        int getGroupId();
+
+        /// Creates a list of concurrency candidates for the given node, one per
+        /// thread allotment of each group of independent operations.
+        static SmallVector<Node* , 2>  createConcurrencyCandidates(Node *node, mlir::MLIRContext *context);
+};
+
+/// Returns the number of threads available to the generated code
+/// (AS_NUM_THREADS, or the number of hardware threads).
+int64_t getAvailableThreads();
+
+#endif // MLSCEDULER_CONCURRENCY_TRANSFORMATION_H_
@@ -0,0 +1,58 @@
+//===----------------------- ContextPool.h --------------------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the ContextPool class, which owns the
+/// worker threads applying the transformations of the lazy candidates. Each
+/// worker has its own MLIRContext, created with the dialect registry of the
+/// search, the code moves between the contexts as bytecode
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLSCEDULER_CONTEXT_POOL_H_
+#define MLSCEDULER_CONTEXT_POOL_H_
+
+#include "Node.h"
+#include "MLIRCodeIR.h"
+#include "Transformation.h"
+#include "Tracing.h"
+
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "llvm/ADT/ArrayRef.h"
+
+#include <memory>
+#include <vector>
+
+class ContextPool{
+    private:
+        /// The context of the search, the candidates are parked in it.
+        mlir::MLIRContext *context;
+        /// One context per worker thread.
+        std::vector<std::unique_ptr<mlir::MLIRContext>> workerContexts;
+
+        /// Returns true if the transformation only uses the context of the code it
+        /// is applied to, and can be replayed in a worker context.
+        static bool isContextIndependent(Transformation *transformation);
+
+    public:
+        /// Creates the contexts of the workers (AS_WORKER_THREADS, 1 by default:
+        /// the candidates are materialized in the context of the search).
+        ContextPool(const mlir::DialectRegistry &registry, mlir::MLIRContext *context);
+
+        int getNumWorkers();
+
+        /// Applies the transformations of the lazy candidates on the worker threads.
+        /// The parent codes are sent to the workers as bytecode, and the code of
+        /// each candidate comes back as bytecode, parked until it is evaluated.
+        /// The candidates that are not lazy, or whose transformation depends on
+        /// the context of the search, are left unchanged: only the Parallelization
+        /// and Interchange recipes are replayed by the workers, the tiling options
+        /// and the vectorization hold attributes of the context of the search.
+        void materializeCandidates(llvm::ArrayRef<Node *> candidates);
+
+        /// Returns the number of worker threads (AS_WORKER_THREADS).
+        static int getWorkerThreads();
+};
+
+#endif // MLSCEDULER_CONTEXT_POOL_H_
@@ -8,6 +8,35 @@ namespace mlir {
 
 std::unique_ptr<Pass> createForEachThreadLowering();
 
+/// Attributes set by the InterOpConcurrency transformation on the operations
+/// that run concurrently, and read by the concurrent regions passes.
+constexpr llvm::StringLiteral kConcurrentGroupAttrName = "as.concurrent_group";
+constexpr llvm::StringLiteral kNumThreadsAttrName = "as.num_threads";
+
+/// Wraps the top level operations tagged with the same concurrent group in the
+/// sections of an omp.sections operation (runs after bufferization).
+std::unique_ptr<Pass> createConcurrentRegionsLowering();
+
+/// Sets the num_threads of the omp.parallel operations nested in each section
+/// from its thread allotment (runs after the SCF to OpenMP conversion).
+std::unique_ptr<Pass> createConcurrentThreadAllotment();
+
+/// Replaces the static intermediate buffers of a function by views of a single
+/// arena, buffers whose lifetimes do not overlap share the same offsets (runs
+/// after the buffer deallocation).
+std::unique_ptr<Pass> createBufferArenaPlanning();
+
+/// Attribute set by the FastMath transformation on the kernel functions, it
+/// holds the arith fast-math flags of the function.
+constexpr llvm::StringLiteral kFastMathAttrName = "as.fastmath";
+
+/// Sets the LLVM fast-math flags of the floating point operations of the
+/// functions carrying kFastMathAttrName (runs after the conversion to LLVM).
+std::unique_ptr<Pass> createFastMathFlagsLowering();
+
+/// Registers the passes above in the pass registry, for the command line of
+/// AutoSchedulerOpt.
+void registerCustomPasses();
 
 } // namespace mlir
 
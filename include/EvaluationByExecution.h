@@ -12,7 +12,17 @@
 #define MLSCEDULER_EVALUATION_BY_EXECUTION_H_
 
 #include "Evaluation.h"
+#include "EvaluationCache.h"
 #include "Node.h"
+#include "BufferizationTransformation.h"
+#include "FastMathTransformation.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "OpIdentity.h"
+#include "OutputVerification.h"
+#include "PassTiming.h"
+#include "SearchTreeRecorder.h"
+#include "Tracing.h"
 #include "TransformDialectInterpreter.h"
 #include "TransformInterpreterPassBase.h"
 #include "CustomPasses/Passes.h"
@@ -27,6 +37,7 @@
 
 #include "mlir/Parser/Parser.h"
 
+#include <optional>
 #include <utility>
 #include <chrono>
 #include <iostream>
@@ -37,23 +48,123 @@
 
 #include <fstream>
 #include <ctime>
+#include <memory>
 
 #define READ 0
 #define WRITE 1
 
 using namespace mlir;
 class EvaluationByExecution {
+    private:
+        /// Checksum of the output of the root (baseline) code, the reference of
+        /// the output verification.
+        bool hasReferenceChecksum = false;
+        double referenceChecksum = 0;
+        /// Root code of the search, and its copy whose constant inputs are filled
+        /// with a pattern: the schedules of the verified candidates are replayed
+        /// on the copy, so that their checksums discriminate the wrong schedules
+        /// while the search works on the unchanged code.
+        MLIRCodeIR *referenceCode = nullptr;
+        MLIRCodeIR *patternCode = nullptr;
+        /// Number of candidates rejected by the output verification.
+        int verificationFailures = 0;
+
+        /// Budget of the search: at most AS_MAX_EVALUATIONS evaluations, within
+        /// AS_TIME_BUDGET seconds since the creation of the evaluator (0 is no
+        /// limit). Once it is spent, the candidates are not evaluated.
+        int maxEvaluations = 0;
+        double timeBudget = 0;
+        std::chrono::steady_clock::time_point startTime;
+        int numEvaluations = 0;
+        int skippedEvaluations = 0;
+        /// Candidates given the stored run of the evaluation cache, they are not
+        /// counted in numEvaluations nor in the budget.
+        int cachedEvaluations = 0;
+
+        /// Best evaluation of the search and the schedule of its node, kept by
+        /// the evaluator since the search frees the nodes it does not keep.
+        std::string bestEvaluation;
+        std::vector<Transformation*> bestSchedule;
+
+        /// The search stops once a candidate is evaluated at or below this
+        /// evaluation (AS_ROOFLINE_STOP_FRACTION of the roofline bound), 0 is
+        /// no target.
+        double targetEvaluation = 0;
+
+        /// Anytime trace of the search (AS_ANYTIME_FILE=<file.csv>): the
+        /// evaluation of each candidate and the best one so far, with the
+        /// seconds since the creation of the evaluator.
+        std::unique_ptr<llvm::raw_fd_ostream> anytimeFile;
+
+        void readBudget();
+        void recordAnytime(const std::string &evaluation, bool failed);
+
+        /// Returns the checksum of the output of the schedule of the node replayed
+        /// on the pattern code, none if it could not be lowered or run.
+        std::optional<double> computeChecksum(Node *node);
+
     public:
         std::string LogsFileName;
 
         EvaluationByExecution();
         EvaluationByExecution(std::string LogsFileName);
+        ~EvaluationByExecution();
+
+        /// Sets the root code the verified candidates are checked against, the
+        /// evaluator holds a reference to it.
+        void setReferenceCode(MLIRCodeIR *code);
+
+        /// Lowers the module to the LLVM dialect: the vector lowering patterns,
+        /// the bufferization with the strategy of the schedule of the node and
+        /// the conversions. The passes are measured by the pass timing when
+        /// timePasses is set. Returns false if a pass failed.
+        static bool lowerModule(mlir::Operation *op, Node *node, bool timePasses);
         /// Evaluates the transformation by executing it with the given parameters.
         /// Parameters:
         /// - registry: A reference to the DialectRegistry used for execution.
         /// - node: A pointer to the Node object representing the transformation.
         /// Returns: The evaluation result as a double value.
         std::string evaluateTransformation(/*int argc, char** argv, DialectRegistry &registry,*/ Node* node);
+
+        /// Returns the number of candidates whose output did not match the output
+        /// of the root code (AS_VERIFY=1, or AS_FASTMATH=1 for the FastMath candidates).
+        int getVerificationFailures();
+
+        /// Returns true if the evaluation budget of the search is spent or the
+        /// target evaluation is reached, the root code is always evaluated.
+        bool isBudgetExhausted();
+
+        /// Replaces the budget read from AS_MAX_EVALUATIONS and AS_TIME_BUDGET,
+        /// the time budget counts from this call.
+        void setBudget(int maxEvaluations, double timeBudget);
+
+        void setTargetEvaluation(double evaluation);
+
+        /// Returns true if the best evaluation is at or below the target one.
+        bool isTargetReached();
+
+        /// Returns the number of candidates run by the runner, the hits of the
+        /// evaluation cache excluded.
+        int getNumEvaluations();
+
+        /// Returns the number of candidates given a stored run by the evaluation
+        /// cache.
+        int getCachedEvaluations();
+
+        /// Returns the number of candidates not evaluated because the budget
+        /// was spent.
+        int getSkippedEvaluations();
+
+        /// Returns the lowest evaluation of a candidate that did not fail (the
+        /// root included), empty before the first evaluation.
+        std::string getBestEvaluation();
+
+        /// Returns the transformations of the best candidate.
+        std::vector<Transformation*> getBestSchedule();
 };
 
+/// Returns true if the runner of the evaluations is configured: SHARED_LIBS, and
+/// AS_CPU_RUNNER or LLVM_PATH.
+bool isCpuRunnerAvailable();
+
 #endif // MLSCEDULER_EVALUATION_BY_EXECUTION_H_
\ No newline at end of file
@@ -0,0 +1,74 @@
+//===--------------------------- EvaluationCache.h ------------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the EvaluationCache class, which keeps
+/// the output of the runner for the lowered modules already run. A candidate
+/// whose lowered module was run before (by the same search or by an earlier
+/// search of the daemon) gets the stored evaluation instead of being compiled
+/// and run again. It is enabled with AS_EVALUATION_CACHE=1 and by the daemon,
+/// and keeps at most AS_EVALUATION_CACHE_SIZE modules (4096 by default), the
+/// oldest ones are dropped first
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLSCEDULER_EVALUATION_CACHE_H_
+#define MLSCEDULER_EVALUATION_CACHE_H_
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+
+class EvaluationCache{
+    private:
+        /// The evaluation and the raw output of the runner of a module, with the
+        /// size and a second hash of the module, checked by the lookups so that
+        /// two modules with the same key are not confused.
+        struct Entry
+        {
+            std::string evaluation;
+            std::string rawOutput;
+            size_t size;
+            uint64_t checkHash;
+        };
+
+        bool enabled = false;
+        size_t capacity = 4096;
+        /// The entries by hash of the lowered module, and the hashes in the
+        /// order of insertion.
+        llvm::DenseMap<uint64_t, Entry> entries;
+        std::deque<uint64_t> order;
+        int hits = 0;
+        int misses = 0;
+        int collisions = 0;
+
+        EvaluationCache();
+
+    public:
+        EvaluationCache(const EvaluationCache &) = delete;
+        EvaluationCache &operator=(const EvaluationCache &) = delete;
+
+        /// Returns the cache of the process, used by the thread of the search.
+        static EvaluationCache &get();
+
+        bool isEnabled();
+        void setEnabled(bool enabled);
+
+        /// Returns true and the stored output if the module was run before.
+        bool lookup(llvm::StringRef loweredModule, std::string &evaluation, std::string &rawOutput);
+
+        /// Stores the output of the module, the modules that failed to run are
+        /// not stored (the failure may come from the machine).
+        void insert(llvm::StringRef loweredModule, const std::string &evaluation, const std::string &rawOutput);
+
+        int getHits();
+        int getMisses();
+        /// Returns the number of lookups whose key matched a different module.
+        int getCollisions();
+        int getSize();
+};
+
+#endif // MLSCEDULER_EVALUATION_CACHE_H_
@@ -0,0 +1,57 @@
+//===----------------------- FastMathTransformation.h ----------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the FastMathTransformation class, which
+/// contains the declartion of the fast-math transformation: the floating point
+/// operations of the kernels get the selected fast-math flags (reassociation,
+/// contraction...)
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef MLSCEDULER_FASTMATH_TRANSFORMATION_H_
+#define MLSCEDULER_FASTMATH_TRANSFORMATION_H_
+
+#include "Transformation.h"
+#include "MLIRCodeIR.h"
+#include "Node.h"
+#include "SearchTreeArena.h"
+#include "Tracing.h"
+#include "Utils.h"
+#include "CustomPasses/Passes.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+
+#include <iostream>
+
+class FastMath: public Transformation{
+    private:
+        mlir::arith::FastMathFlags flags;
+        mlir::MLIRContext *context;
+    public:
+        FastMath();
+
+        /// Constructor for FastMath that allows specifying the flags.
+        FastMath(mlir::arith::FastMathFlags flags, mlir::MLIRContext *context);
+
+        /// Sets the flags on the arith operations of the functions containing linalg
+        /// operations, and marks these functions so that the flags are also set on
+        /// the LLVM operations after the lowering.
+        /// Overrides the applyTransformation() method from the base class Transformation.
+        void applyTransformation(CodeIR CodeIr) override;
+        std::string printTransformation() override;
+        std::string getType() override;
+
+        mlir::arith::FastMathFlags getFlags();
+
+        /// Creates a list of fast-math candidates for the given node, one per set
+        /// of flags (contract, reassoc + contract, fast).
+        static SmallVector<Node* , 2>  createFastMathCandidates(Node *node, mlir::MLIRContext *context);
+
+        /// Returns true if the schedule of the node contains a FastMath transformation.
+        static bool hasFastMath(Node *node);
+};
+
+#endif // MLSCEDULER_FASTMATH_TRANSFORMATION_H_
@@ -15,7 +15,10 @@
 #include "Transformation.h"
 #include "MLIRCodeIR.h"
 #include "Node.h"
+#include "SearchTreeArena.h"
+#include "Tracing.h"
 #include "Utils.h"
+#include "OpIdentity.h"
 
 #include "mlir/Dialect/Linalg/Passes.h"
 
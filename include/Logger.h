@@ -0,0 +1,121 @@
+//===----------------------------- Logger.h -------------------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the Logger class, the logging of the
+/// search. The messages are queued in a bounded ring buffer and written by a
+/// background thread, so that the evaluations do not wait for the I/O. The
+/// level of the log is set by AS_LOG (error, warning, info, debug or trace,
+/// info by default) and the log goes to AS_LOG_FILE, stderr by default. When
+/// the buffer (AS_LOG_BUFFER messages, 4096 by default) is full, the info, debug
+/// and trace messages are dropped (their number is logged), the errors, the
+/// warnings and the appended text (the logs of AS_VERBOSE, the IR dumps) wait
+/// for the writer. With AS_LOG_IR_DIR set, the IR dumps are written to the
+/// directory as bytecode instead of being printed in the logs
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLSCEDULER_LOGGER_H_
+#define MLSCEDULER_LOGGER_H_
+
+#include "mlir/IR/Operation.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class LogLevel
+{
+    Error = 0,
+    Warning,
+    Info,
+    Debug,
+    Trace
+};
+
+/// Logs the streamed message if the level is enabled, the message is only
+/// formatted when it is logged:
+///   AS_LOG(LogLevel::Debug, "Stage = " << stage);
+#define AS_LOG(level, message)                         \
+    do                                                 \
+    {                                                  \
+        if (Logger::get().isEnabled(level))            \
+        {                                              \
+            std::ostringstream logStream;              \
+            logStream << message;                      \
+            Logger::get().log(level, logStream.str()); \
+        }                                              \
+    } while (0)
+
+class Logger{
+    private:
+        /// A message appended to a log file, or the bytecode of an IR dump
+        /// written to its own file.
+        struct Entry
+        {
+            std::string file;
+            std::string data;
+            bool isBytecode = false;
+        };
+
+        LogLevel level = LogLevel::Info;
+        std::string logFile;
+        std::string irDirectory;
+        std::atomic<uint64_t> irDumps{0};
+
+        /// The ring buffer of the messages waiting for the writer.
+        std::vector<Entry> buffer;
+        size_t head = 0;
+        size_t count = 0;
+        uint64_t dropped = 0;
+        std::mutex mutex;
+        std::condition_variable available;
+        std::condition_variable drained;
+        /// Notified when the writer empties the buffer, for the producers waiting
+        /// for room.
+        std::condition_variable room;
+        bool stopping = false;
+        bool writing = false;
+        std::thread writer;
+
+        Logger();
+        ~Logger();
+
+        /// Queues the entry, waits for room if the buffer is full and the entry
+        /// must be written, drops it otherwise.
+        void push(Entry entry, bool wait);
+        void runWriter();
+
+    public:
+        Logger(const Logger &) = delete;
+        Logger &operator=(const Logger &) = delete;
+
+        /// Returns the logger of the search, the writer thread is started on the
+        /// first use.
+        static Logger &get();
+
+        bool isEnabled(LogLevel level);
+
+        /// Logs a message of the level to the log of the search.
+        void log(LogLevel level, std::string message);
+
+        /// Appends the text to a log file.
+        void append(const std::string &file, std::string text);
+
+        /// Appends the header and the code to a log file, or the header and the
+        /// path of the bytecode of the code if AS_LOG_IR_DIR is set.
+        void appendIR(const std::string &file, const std::string &header, mlir::Operation *op);
+
+        /// Logs the code with the level, as appendIR on the log of the search.
+        void logIR(LogLevel level, const std::string &header, mlir::Operation *op);
+
+        /// Waits until the queued messages are written.
+        void flush();
+};
+
+#endif // MLSCEDULER_LOGGER_H_
@@ -20,23 +20,71 @@
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 
 
 #include <iostream>
+#include <memory>
 using namespace mlir;
 
+class Transformation;
+
 // This is a C++ class called MLIRCodeIR that represents the representation of code.
 class MLIRCodeIR : public CodeIR{
     private:
         //mlir::OwningOpRef<Operation*>* MLIRIr; // Representation of code.
+
+        /// Recipe of a lazy code representation: the code is a clone of the parent
+        /// code with the transformation applied, it is materialized on demand.
+        MLIRCodeIR *parent = nullptr;
+        Transformation *recipe = nullptr;
+
+        /// Number of owners of the code: the node holding it, and the lazy code
+        /// representations that replay their recipe on it.
+        int refCount = 1;
+
+        /// Bytecode of the parked code (compressed when zlib is available), or
+        /// the file holding it when it is larger than the spill threshold.
+        llvm::SmallVector<uint8_t, 0> parkedBytecode;
+        std::string parkedFile;
+        /// Size of the uncompressed bytecode, 0 if it is not compressed.
+        size_t uncompressedSize = 0;
+        bool parked = false;
+        mlir::MLIRContext *context = nullptr;
+
+        /// Module with the functions that are not transformed (runtime functions,
+        /// main...) and declarations of the kernel functions. It is shared by all
+        /// the candidates derived from the root and erased with the last code
+        /// sharing it: the code of a candidate only holds the kernel functions
+        /// (the functions with linalg operations) and declarations of the other
+        /// functions, the full module is assembled for the lowering.
+        std::shared_ptr<mlir::Operation> skeleton;
+
+        /// Moves the functions of the module that are not kernels to the
+        /// skeleton, returns the module with the kernel functions.
+        mlir::Operation *scopeModule(mlir::Operation *module);
+
+        /// Rehydrates the parked code.
+        void unpark();
+        /// Returns a new copy of the parked code (the code stays parked), null if
+        /// the bytecode cannot be read.
+        mlir::Operation *readParked();
+        /// Drops the parked bytecode and its file.
+        void discardParked();
     public:
-        // MLIRCodeIR();
+        MLIRCodeIR() = default;
+
+        /// Creates a lazy code representation from the parent code and the
+        /// transformation to replay on it, no code is created until getIr().
+        /// The lazy code holds a reference to the parent code.
+        MLIRCodeIR(MLIRCodeIR *parent, Transformation *recipe);
 
         // /// Constructor that takes a void* parameter and initializes the Ir member variable.
         // MLIRCodeIR(void* Ir);
@@ -46,11 +94,66 @@ class MLIRCodeIR : public CodeIR{
         /// status of the parsing process.
         mlir::OwningOpRef<Operation*> parseInputFile(StringRef InputFilename, MLIRContext &context);
 
+        /// Sets the code to a clone of the module: the operations get their
+        /// identifiers and the functions that are not kernels go to the skeleton.
+        /// The module is left unchanged.
+        void loadModule(Operation *module);
+
         /// Overrides the cloneIr() method from the base class CodeIR.
-        /// Returns a pointer to a new instance of MLIRCodeIR.
+        /// Returns a pointer to a new instance of MLIRCodeIR, only the kernel
+        /// functions are cloned, the skeleton is shared.
         CodeIR* cloneIr() override;
 
         CodeIR* setMLIRIR(Operation* module);
+
+        /// Returns the code, rehydrating it if it is parked, or materializing it by
+        /// replaying the recipe on a copy of the parent code. Returns null if the
+        /// parked code cannot be read and there is no recipe to replay (or the
+        /// replay of the parent failed), the failure is logged.
+        /// CodeIR::getIr() is not virtual (the CodeIR class comes from the
+        /// coreAutoScheduler module) and this one only hides it: a code reached
+        /// through the base class, as the transformations get it, must be
+        /// materialized first.
+        void* getIr();
+
+        /// Materializes the code before it is given to a transformation, returns
+        /// false if it cannot be materialized.
+        bool materialize();
+
+        /// Returns a new full module made of a clone of the skeleton with the
+        /// kernel functions of the code, owned by the caller. Without skeleton
+        /// (AS_FUNCTION_SCOPED_IR=0) it is a clone of the code. Returns null if
+        /// the code cannot be materialized.
+        mlir::Operation *assembleModule();
+
+        bool isMaterialized();
+        bool hasRecipe();
+        bool isParked();
+
+        /// Serializes the code of an inactive candidate to bytecode and frees the
+        /// code, the next getIr() rehydrates it. The bytecode is compressed unless
+        /// AS_PARK_COMPRESS=0, and written to a temporary file (memory mapped when
+        /// it is read back) when it is larger than AS_PARK_SPILL_BYTES.
+        void park();
+
+        /// Parks the code given as bytecode (code produced in another context),
+        /// the code is rehydrated in the context by the next getIr().
+        void parkBytecode(llvm::StringRef bytecode, mlir::MLIRContext *context);
+
+        MLIRCodeIR *getParent();
+        Transformation *getRecipe();
+
+        /// Frees the code of a lazy code representation, it will be replayed by the
+        /// next getIr(). The code of the root is never freed.
+        void release();
+
+        /// Adds an owner of the code.
+        void retain();
+
+        /// Drops a reference to the code, the code and the representation are
+        /// deleted with the last reference (with the reference to the parent code
+        /// of a lazy representation, and its reference to the skeleton).
+        void dropReference();
 };
 
 #endif // MLSCHEDULER_MLIRCODEIR_H_
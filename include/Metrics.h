@@ -0,0 +1,94 @@
+//===----------------------------- Metrics.h ------------------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the MetricsRegistry class, which counts
+/// the candidates of the search and exposes the metrics in the Prometheus text
+/// format, for the monitoring of long tuning jobs. The metrics are served over
+/// HTTP on a localhost port (AS_METRICS_PORT) or a Unix socket
+/// (AS_METRICS_SOCKET), and dumped periodically to a file (AS_METRICS_FILE,
+/// every AS_METRICS_INTERVAL seconds, 10 by default)
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLSCEDULER_METRICS_H_
+#define MLSCEDULER_METRICS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include <sys/types.h>
+
+class MetricsRegistry{
+    private:
+        std::atomic<uint64_t> candidatesGenerated{0};
+        std::atomic<uint64_t> candidatesEvaluated{0};
+        std::atomic<uint64_t> candidatesFailed{0};
+        /// Evaluations whose code was materialized or parked (hits), or had to
+        /// be replayed from the parent code (misses).
+        std::atomic<uint64_t> codeCacheHits{0};
+        std::atomic<uint64_t> codeCacheMisses{0};
+        /// Evaluations given a stored run by the evaluation cache (hits), or run
+        /// by the runner while the cache is enabled (misses).
+        std::atomic<uint64_t> evaluationCacheHits{0};
+        std::atomic<uint64_t> evaluationCacheMisses{0};
+        /// Evaluations of the root code and of the best candidate, as returned
+        /// by the runner (lower is better), 0 until known.
+        std::atomic<double> rootEvaluation{0};
+        std::atomic<double> incumbentEvaluation{0};
+
+        std::chrono::steady_clock::time_point startTime;
+
+        /// The exporter thread serves the sockets and writes the dump file.
+        std::thread exporter;
+        std::atomic<bool> stopping{false};
+        /// Process which started the exporter. A forked copy of the process
+        /// (the children running the tools) neither joins the thread nor
+        /// removes the socket of the parent.
+        pid_t ownerPid = -1;
+        int tcpSocket = -1;
+        int unixSocket = -1;
+        std::string unixSocketPath;
+        std::string dumpFile;
+        int dumpInterval = 10;
+
+        void runExporter();
+        void serveClient(int client);
+        void writeDump();
+
+        MetricsRegistry();
+        ~MetricsRegistry();
+
+    public:
+        MetricsRegistry(const MetricsRegistry &) = delete;
+        MetricsRegistry &operator=(const MetricsRegistry &) = delete;
+
+        /// Returns the metrics of the search.
+        static MetricsRegistry &get();
+
+        /// Opens the endpoints configured by the environment and starts the
+        /// exporter thread, if any endpoint is configured.
+        void start();
+
+        /// Stops the exporter thread, the dump file is written one last time.
+        void stop();
+
+        void addGeneratedCandidate();
+
+        /// Records the evaluation of a candidate. The failed evaluations (the
+        /// runner failed or the output was rejected) do not change the
+        /// incumbent.
+        void addEvaluation(double evaluation, bool isRoot, bool failed);
+
+        void addCodeCacheLookup(bool hit);
+
+        void addEvaluationCacheLookup(bool hit);
+
+        /// Returns the metrics in the Prometheus text exposition format.
+        std::string render();
+};
+
+#endif // MLSCEDULER_METRICS_H_
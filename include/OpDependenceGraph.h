@@ -0,0 +1,73 @@
+//===----------------------- OpDependenceGraph.h -------------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the OpDependenceGraph class, which
+/// builds the producer-consumer DAG of the linalg operations of a module and
+/// finds the operations that can run concurrently
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLSCEDULER_OP_DEPENDENCE_GRAPH_H_
+#define MLSCEDULER_OP_DEPENDENCE_GRAPH_H_
+
+#include "Utils.h"
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "llvm/ADT/DenseMap.h"
+
+#include <set>
+#include <vector>
+
+class OpDependenceGraph{
+    private:
+        /// The linalg operations, indexed by stage (same order as getLinalgOps).
+        llvm::SmallVector<mlir::linalg::LinalgOp, 4> linalgOps;
+        /// The top level operations of the function body containing the stages,
+        /// after tiling and fusion several stages may share the same anchor.
+        llvm::SmallVector<mlir::Operation *, 4> anchorOps;
+        llvm::DenseMap<mlir::Operation *, int> anchorIndex;
+        /// The anchor of each stage.
+        llvm::SmallVector<int, 4> stageAnchor;
+        /// Producer and consumer anchors of each anchor.
+        std::vector<std::set<int>> producers;
+        std::vector<std::set<int>> consumers;
+
+        void addDependences(int anchor);
+
+    public:
+        /// Builds the graph for all the linalg operations nested in prog.
+        OpDependenceGraph(mlir::Operation *prog);
+
+        int getNumStages();
+        mlir::linalg::LinalgOp getOp(int stage);
+
+        /// Returns the top level operation of the function body containing the
+        /// given stage.
+        mlir::Operation *getAnchor(int stage);
+
+        /// Returns the stages whose anchors produce a value used by the anchor of
+        /// the given stage.
+        std::set<int> getProducerStages(int stage);
+        std::set<int> getConsumerStages(int stage);
+
+        /// Returns true if there is a producer-consumer path between the two
+        /// stages, in any direction, or if they share the same anchor.
+        bool areDependent(int stageA, int stageB);
+
+        /// Returns groups of mutually independent stages (one representative stage
+        /// per anchor), grouped by their depth in the DAG. Only anchors that
+        /// contain an operation other than linalg.fill are considered, and only
+        /// groups with at least two members are returned.
+        std::vector<std::vector<int>> getIndependentGroups();
+
+        /// Returns the number of iterations of the stage (the product of the
+        /// static sizes of its iteration domain), used to split threads.
+        int64_t estimateWork(int stage);
+};
+
+/// Returns the top level operation of the enclosing function body containing op.
+mlir::Operation *getTopLevelAncestor(mlir::Operation *op);
+
+#endif // MLSCEDULER_OP_DEPENDENCE_GRAPH_H_
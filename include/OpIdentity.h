@@ -0,0 +1,80 @@
+//===----------------------- OpIdentity.h ---------------------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the stable identifiers of the linalg
+/// operations and of the OpIdentityIndex class. The identifier is a discardable
+/// attribute assigned when the input is parsed (the stage of the operation at
+/// that time); it is kept by the clones of the code and by the clones made by
+/// tiling and fusion, so an operation is found by its identifier even when the
+/// number of linalg operations changes
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLSCEDULER_OP_IDENTITY_H_
+#define MLSCEDULER_OP_IDENTITY_H_
+
+#include "Utils.h"
+
+#include "mlir/IR/Operation.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+
+/// Name of the attribute holding the identifier of a linalg operation.
+constexpr llvm::StringLiteral kOpIdAttrName = "as.op_id";
+
+/// Gives an identifier to the linalg operations nested in root that do not have
+/// one, in the order of the stages.
+void assignOpIds(mlir::Operation *root);
+
+/// Returns the identifier of the operation, -1 if it has none.
+int64_t getOpId(mlir::Operation *op);
+
+/// Sets the identifier of the operation (to keep the identifier of an operation
+/// replaced by a rewrite), does nothing for a negative identifier.
+void setOpId(mlir::Operation *op, int64_t id);
+
+class OpIdentityIndex{
+    private:
+        mlir::Operation *root;
+        /// The operation of each identifier with its nesting depth. When the
+        /// operation was cloned (fused producers), the least nested one is kept.
+        llvm::DenseMap<int64_t, std::pair<mlir::Operation *, unsigned>> ops;
+
+    public:
+        /// Indexes the operations with an identifier nested in root.
+        OpIdentityIndex(mlir::Operation *root);
+
+        mlir::Operation *getRoot();
+
+        /// Indexes the operations nested in op, after a rewrite created them.
+        void update(mlir::Operation *op);
+
+        /// Removes the operation from the index, before a rewrite erases it.
+        void erase(mlir::Operation *op);
+
+        /// Returns the operation with the identifier, nullptr if there is none.
+        mlir::Operation *lookup(int64_t id);
+
+        /// Returns the operation with the identifier, or the operation of the stage
+        /// for the code without identifiers.
+        mlir::Operation *lookup(int64_t id, int stage);
+};
+
+/// Returns the index of the operations nested in root. The index of the last
+/// code is kept (one per thread) for the transformations applied in sequence to
+/// the same code: a transformation rewriting linalg operations updates it or
+/// invalidates it, and the code invalidates it before erasing its operation.
+/// The kept index is only used while no code was invalidated since it was
+/// built, in any thread (an erased code may be reallocated at the same address).
+OpIdentityIndex &getOpIdentityIndex(mlir::Operation *root);
+
+/// Drops the kept index if it is the index of root, and the kept indexes of the
+/// other threads.
+void invalidateOpIdentityIndex(mlir::Operation *root);
+
+/// Returns the operation with the identifier in root, or the operation of the
+/// stage if no operation has the identifier.
+mlir::Operation *findStageOp(mlir::Operation *root, int64_t id, int stage);
+
+#endif // MLSCEDULER_OP_IDENTITY_H_
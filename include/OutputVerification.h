@@ -0,0 +1,48 @@
+//===----------------------- OutputVerification.h -------------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the output verification functions: the
+/// evaluated module prints a checksum of the output of the kernel, which is
+/// compared to the checksum of the baseline code
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLSCEDULER_OUTPUT_VERIFICATION_H_
+#define MLSCEDULER_OUTPUT_VERIFICATION_H_
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/BuiltinOps.h"
+
+#include <optional>
+#include <string>
+
+/// Adds to the main function of the module the printing of a position weighted
+/// checksum of the tensor returned by the last call to a kernel function, after
+/// the time measurement. The checksum is printed as "( value )".
+/// Returns false if the module has no main function or no kernel call.
+bool instrumentOutputChecksum(mlir::Operation *module);
+
+/// Replaces the constant fills of the inputs of the linalg operations by a
+/// deterministic pattern of their indices, so that the wrong schedules (permuted
+/// loops, wrong tile boundaries) do not print the checksum of the right one on
+/// uniform data. The fills of the inits (the neutral elements of the
+/// reductions) are kept, the pattern operations keep the identifiers of the
+/// fills. Returns the number of replaced fills.
+int fillInputsWithPattern(mlir::Operation *module);
+
+/// Returns the last checksum printed in the output of the runner.
+std::optional<double> parseOutputChecksum(const std::string &output);
+
+/// Returns true if the relative difference between the checksums is below the
+/// tolerance.
+bool isWithinTolerance(double reference, double value, double tolerance);
+
+/// Returns the tolerance of the output verification (AS_VERIFY_TOLERANCE, 1e-3
+/// by default).
+double getVerificationTolerance();
+
+#endif // MLSCEDULER_OUTPUT_VERIFICATION_H_
@@ -15,7 +15,11 @@
 #include "Transformation.h"
 #include "MLIRCodeIR.h"
 #include "Node.h"
+#include "SearchTreeArena.h"
+#include "Tracing.h"
+#include "Logger.h"
 #include "Utils.h"
+#include "OpIdentity.h"
 
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 
@@ -45,6 +49,9 @@ class Parallelization: public Transformation{
     private:
         mlir::TilingInterface* op;
         int OperationStage;
+        /// Identifier of the target operation (kOpIdAttrName), the stage is only
+        /// used for the code without identifiers.
+        int64_t targetOpId = -1;
         mlir::MLIRContext *context;
         llvm::SmallVector<int64_t, 4> tileSizes;
     public:
@@ -67,6 +74,8 @@ class Parallelization: public Transformation{
         llvm::SmallVector<int64_t, 4>  getTileSizes();
         int getOperationStage();
         void setOperationStage(int stage);
+        int64_t getTargetOpId();
+        void setTargetOpId(int64_t id);
 };
 
 #endif // MLSCEDULER_PARALLELIZATION_TRANSFORMATION_H_
\ No newline at end of file
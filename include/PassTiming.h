@@ -0,0 +1,81 @@
+//===---------------------------- PassTiming.h ----------------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the PassTiming class, which measures
+/// the passes lowering each evaluated candidate. With AS_PASS_TIMING set to the
+/// path of a CSV file, the wall time, the number of runs and the statistics of
+/// each pass are written per candidate, and aggregated over the search in
+/// <AS_PASS_TIMING>.summary.csv at the end of the search. The statistics of
+/// LLVM are enabled at runtime, the summary says so when they are unavailable
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLSCEDULER_PASS_TIMING_H_
+#define MLSCEDULER_PASS_TIMING_H_
+
+#include "Logger.h"
+
+#include "mlir/Pass/PassManager.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <utility>
+
+class PassTiming{
+    private:
+        /// The runs of a pass, in a candidate or over the search.
+        struct PassRecord
+        {
+            uint64_t runs = 0;
+            double wallMicroseconds = 0;
+            /// Largest wall time of the pass in a candidate (summary only).
+            double maxMicroseconds = 0;
+            int candidates = 0;
+            llvm::MapVector<std::string, uint64_t> statistics;
+        };
+
+        std::string csvFile;
+        std::ofstream csv;
+        int numCandidates = 0;
+
+        /// The passes of the candidate being lowered, the passes of the nested
+        /// pass managers may run on the threads of the context.
+        std::mutex mutex;
+        llvm::MapVector<std::string, PassRecord> current;
+        llvm::MapVector<std::string, PassRecord> summary;
+
+        PassTiming();
+
+    public:
+        PassTiming(const PassTiming &) = delete;
+        PassTiming &operator=(const PassTiming &) = delete;
+
+        /// Returns the pass timing of the search.
+        static PassTiming &get();
+
+        bool isEnabled();
+
+        /// Measures the passes run by the pass manager.
+        void instrument(mlir::PassManager &pm);
+
+        /// Adds a run of a pass (or of a lowering step that is not a pass) of
+        /// the current candidate.
+        void addRun(llvm::StringRef name, double microseconds,
+                    llvm::ArrayRef<std::pair<std::string, uint64_t>> statistics = {});
+
+        /// Writes the passes of the current candidate and adds them to the
+        /// summary.
+        void recordCandidate(const std::string &schedule, bool lowered);
+
+        /// Writes the summary of the search, and logs the passes taking most
+        /// of the lowering time.
+        void writeSummary();
+};
+
+#endif // MLSCEDULER_PASS_TIMING_H_
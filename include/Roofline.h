@@ -0,0 +1,91 @@
+//===------------------------------ Roofline.h ----------------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the Roofline class, which calibrates
+/// the roofline of the host (peak FP32 FMA throughput of one core and of all
+/// cores, streaming memory bandwidth) and bounds the time of a benchmark from
+/// its floating-point operations and the bytes of its operands. With
+/// AS_ROOFLINE=1 the end of the search reports the GFLOPS of the best schedule
+/// and its fraction of the roofline bound; with AS_ROOFLINE_STOP_FRACTION set
+/// (0.8 stops within 80% of the bound) the search stops once a candidate reaches
+/// this fraction. The calibration is stored in AS_ROOFLINE_CACHE when set, and
+/// AS_ROOFLINE_PEAK_GFLOPS / AS_ROOFLINE_BANDWIDTH replace the measured values
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLSCEDULER_ROOFLINE_H_
+#define MLSCEDULER_ROOFLINE_H_
+
+#include "Logger.h"
+#include "Tracing.h"
+
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/IR/Operation.h"
+#include "llvm/ADT/STLExtras.h"
+
+#include <cstdint>
+
+/// Static cost of a code: the floating-point operations of the bodies of its
+/// linalg operations times their iterations, and the bytes of their tensor
+/// operands, each one read or written once (the compulsory traffic).
+struct KernelCost{
+    double flops = 0;
+    double bytes = 0;
+
+    /// Returns the flops per byte, 0 without operands.
+    double getArithmeticIntensity();
+};
+
+class Roofline{
+    private:
+        bool calibrated = false;
+        /// GFLOPS of the FMA kernel on one thread and on all the hardware threads.
+        double peakGflopsSingleCore = 0;
+        double peakGflops = 0;
+        /// GB/s of the triad kernel on all the hardware threads.
+        double bandwidth = 0;
+
+        Roofline() = default;
+
+        bool readCache();
+        void writeCache();
+
+    public:
+        Roofline(const Roofline &) = delete;
+        Roofline &operator=(const Roofline &) = delete;
+
+        static Roofline &get();
+
+        /// Returns true if AS_ROOFLINE=1 or AS_ROOFLINE_STOP_FRACTION is set.
+        bool isEnabled();
+
+        /// Returns AS_ROOFLINE_STOP_FRACTION, 0 if the search does not stop early.
+        double getStopFraction();
+
+        /// Measures the roofline, once (the cache and the overrides are read first).
+        void calibrate();
+
+        double getPeakGflopsSingleCore();
+        double getPeakGflops();
+        double getBandwidth();
+
+        /// Returns the GFLOPS bound of a code with the arithmetic intensity.
+        double getAttainableGflops(double arithmeticIntensity);
+
+        /// Returns the GFLOPS of the FMA kernel run on numThreads threads. On
+        /// x86 the kernel uses AVX2 and FMA, and AVX-512 when the host has them
+        /// (the best of the kernels is returned).
+        static double measurePeakGflops(unsigned numThreads);
+
+        /// Returns the GB/s of the triad kernel (a = b + s * c) run on numThreads
+        /// threads, on arrays larger than the last level caches.
+        static double measureBandwidth(unsigned numThreads);
+
+        /// Returns the cost of the linalg operations nested in root, the fills
+        /// (out of the timed region of the benchmarks) and the operations with
+        /// dynamic shapes are ignored.
+        static KernelCost computeKernelCost(mlir::Operation *root);
+};
+
+#endif // MLSCEDULER_ROOFLINE_H_
@@ -0,0 +1,92 @@
+//===----------------------- SearchTreeArena.h ----------------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the SearchTreeArena class, which owns
+/// the nodes and the transformations of the search tree. The nodes are recycled
+/// when they are pruned, the transformations are shared by the schedules of the
+/// descendants of a node and live until the end of the search
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLSCEDULER_SEARCH_TREE_ARENA_H_
+#define MLSCEDULER_SEARCH_TREE_ARENA_H_
+
+#include "Node.h"
+#include "MLIRCodeIR.h"
+#include "Metrics.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/RecyclingAllocator.h"
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class SearchTreeArena{
+    private:
+        llvm::RecyclingAllocator<llvm::BumpPtrAllocator, Node> nodeAllocator;
+        llvm::BumpPtrAllocator transformationAllocator;
+        /// The transformations and their destructors, called when the arena is
+        /// destroyed.
+        std::vector<std::pair<void *, void (*)(void *)>> destructors;
+
+        int liveNodes = 0;
+        int freedNodes = 0;
+
+        template <typename T>
+        static void destroy(void *object)
+        {
+            static_cast<T *>(object)->~T();
+        }
+
+    public:
+        SearchTreeArena() = default;
+        SearchTreeArena(const SearchTreeArena &) = delete;
+        SearchTreeArena &operator=(const SearchTreeArena &) = delete;
+        ~SearchTreeArena();
+
+        /// Returns the arena of the search.
+        static SearchTreeArena &get();
+
+        /// Creates a node in the arena, the node owns a reference to its code.
+        template <typename... Args>
+        Node *createNode(Args &&...args)
+        {
+            liveNodes++;
+            MetricsRegistry::get().addGeneratedCandidate();
+            return new (nodeAllocator.Allocate()) Node(std::forward<Args>(args)...);
+        }
+
+        /// Creates a transformation in the arena.
+        template <typename T, typename... Args>
+        T *createTransformation(Args &&...args)
+        {
+            void *memory = transformationAllocator.Allocate(sizeof(T), alignof(T));
+            T *transformation = new (memory) T(std::forward<Args>(args)...);
+            if (!std::is_trivially_destructible<T>::value)
+                destructors.emplace_back(transformation, &destroy<T>);
+            return transformation;
+        }
+
+        /// Frees a node that is not referenced by the search tree anymore (a
+        /// candidate that lost the selection): the reference of the node to its
+        /// code is dropped and the node is recycled. The code is kept alive as long
+        /// as lazy candidates derived from it need it.
+        void freeNode(Node *node);
+
+        /// Frees the nodes, except the node to keep (the best one).
+        void freeNodes(llvm::ArrayRef<Node *> nodes, Node *keep = nullptr);
+
+        /// Destroys the transformations of the arena, when no node is alive
+        /// anymore (between the searches of a long-lived client such as the
+        /// daemon). Returns false, and keeps them, if nodes are still alive. No
+        /// schedule of the previous searches may be used afterwards.
+        bool releaseTransformations();
+
+        int getLiveNodes();
+        int getFreedNodes();
+};
+
+#endif // MLSCEDULER_SEARCH_TREE_ARENA_H_
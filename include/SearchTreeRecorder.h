@@ -0,0 +1,68 @@
+//===------------------------- SearchTreeRecorder.h -----------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the SearchTreeRecorder class, which
+/// exports the search tree. With AS_SEARCH_TREE set to the path of a file, each
+/// evaluated node is written as a JSON line when it is evaluated (the pruned
+/// nodes are freed right after): its identifier, the identifier of its parent,
+/// its transformations, its evaluation and the counters of the search at this
+/// point. Each search of the process starts a new tree, the nodes carry the
+/// index and the name of their search. scripts/analyze_search_tree.py reads
+/// the file
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLSCEDULER_SEARCH_TREE_RECORDER_H_
+#define MLSCEDULER_SEARCH_TREE_RECORDER_H_
+
+#include "Node.h"
+#include "Transformation.h"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class SearchTreeRecorder{
+    private:
+        std::unique_ptr<llvm::raw_fd_ostream> output;
+        std::chrono::steady_clock::time_point startTime;
+        int64_t numRecords = 0;
+        int64_t numFailed = 0;
+        int64_t searchIndex = -1;
+        std::string searchName;
+
+        /// The recorded nodes of the search by schedule, a schedule is keyed by
+        /// its printed steps since the arena reuses the addresses of the freed
+        /// transformations. The parent of a node is the recorded node with the
+        /// longest prefix of its schedule.
+        std::map<std::vector<std::string>, int64_t> nodeIds;
+
+        SearchTreeRecorder();
+
+        static std::vector<std::string> getScheduleKey(const std::vector<Transformation *> &schedule);
+        int64_t findParent(std::vector<std::string> key);
+
+    public:
+        SearchTreeRecorder(const SearchTreeRecorder &) = delete;
+        SearchTreeRecorder &operator=(const SearchTreeRecorder &) = delete;
+
+        /// Returns the recorder of the search.
+        static SearchTreeRecorder &get();
+
+        bool isEnabled();
+
+        /// Starts the tree of a new search: the identifiers, the counters and
+        /// the elapsed time restart from 0.
+        void beginSearch(const std::string &name);
+
+        /// Writes the evaluated node, returns its identifier (-1 if the tree is
+        /// not recorded).
+        int64_t recordEvaluation(Node *node, const std::string &evaluation, bool failed);
+};
+
+#endif // MLSCEDULER_SEARCH_TREE_RECORDER_H_
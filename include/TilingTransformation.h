@@ -14,7 +14,10 @@
 #include "Transformation.h"
 #include "MLIRCodeIR.h"
 #include "Node.h"
+#include "SearchTreeArena.h"
+#include "Tracing.h"
 #include "Utils.h"
+#include "OpIdentity.h"
 
 #include "mlir/Dialect/SCF/Transforms/TileUsingInterface.h"
 #include "mlir/Dialect/Transform/Utils/DiagnosedSilenceableFailure.h"
@@ -29,6 +32,9 @@ class Tiling: public Transformation{
     private:
         mlir::TilingInterface* op;
         int OperationStage;
+        /// Identifier of the target operation (kOpIdAttrName), the stage is only
+        /// used for the code without identifiers.
+        int64_t targetOpId = -1;
         mlir::scf::SCFTilingOptions options;
         mlir::MLIRContext *context;
         llvm::SmallVector<int64_t, 4> tileSizes;
@@ -54,6 +60,8 @@ class Tiling: public Transformation{
         mlir::scf::SCFTilingOptions getOptions();
         int getOperationStage();
         void setOperationStage(int stage);
+        int64_t getTargetOpId();
+        void setTargetOpId(int64_t id);
 };
 
 #endif // MLSCEDULER_TILING_TRANSFORMATION_H_
\ No newline at end of file
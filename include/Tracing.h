@@ -0,0 +1,49 @@
+//===----------------------------- Tracing.h ------------------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the tracing functions of the search.
+/// With AS_TRACE set to the path of a file, the phases of the search (candidate
+/// generation, cloning, transformations, lowering passes, runner) are recorded
+/// with the LLVM time trace profiler, and written at the end of the search in
+/// the Chrome trace event format (chrome://tracing, ui.perfetto.dev). Each
+/// thread has its own track, the events of an evaluation carry the schedule of
+/// the candidate
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLSCEDULER_TRACING_H_
+#define MLSCEDULER_TRACING_H_
+
+#include "Node.h"
+#include "Transformation.h"
+
+#include "mlir/Pass/PassManager.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/TimeProfiler.h"
+
+#include <iostream>
+#include <string>
+
+/// Starts the tracing of the main thread if AS_TRACE is set. The events shorter
+/// than AS_TRACE_GRANULARITY microseconds (0 by default) are dropped.
+void initTracing(llvm::StringRef processName);
+
+/// Returns true if the search is traced.
+bool isTracingEnabled();
+
+/// Starts and ends the tracing of a worker thread, when the search is traced.
+void initThreadTracing(llvm::StringRef threadName);
+void finishThreadTracing();
+
+/// Writes the events of all the threads to the trace file.
+void writeTrace();
+
+/// Returns the detail of the trace events of a candidate: its schedule.
+std::string getTraceCandidateName(Node *node);
+
+/// Records an event for each pass run by the pass manager. The passes run on
+/// the threads of the context are not recorded.
+void addPassTracing(mlir::PassManager &pm);
+
+#endif // MLSCEDULER_TRACING_H_
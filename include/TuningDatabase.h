@@ -0,0 +1,93 @@
+//===--------------------------- TuningDatabase.h -------------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the declaration of the TuningDatabase class, which stores
+/// the best schedule found for each benchmark. With AS_TUNING_DB set to the path
+/// of a JSON file, the end of a search records its best schedule (the
+/// parameters of each transformation, enough to replay it on the input code)
+/// with its time and the time of the root code, when the benchmark has no entry
+/// or the new schedule is faster. The regression mode (AS_REGRESS=1) replays the
+/// stored schedule and compares its time with the recorded one
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLSCEDULER_TUNING_DATABASE_H_
+#define MLSCEDULER_TUNING_DATABASE_H_
+
+#include "Transformation.h"
+#include "SearchTreeArena.h"
+#include "TilingTransformation.h"
+#include "InterchangeTransformation.h"
+#include "ParallelizationTransformation.h"
+#include "VectorizationTransformation.h"
+#include "ConcurrencyTransformation.h"
+#include "BufferizationTransformation.h"
+#include "FastMathTransformation.h"
+
+#include "mlir/IR/MLIRContext.h"
+#include "llvm/Support/JSON.h"
+
+#include <string>
+#include <vector>
+
+/// The stored best schedule of a benchmark.
+struct TuningRecord{
+    double rootTime = 0;
+    double time = 0;
+    std::string date;
+    std::vector<Transformation *> schedule;
+};
+
+class TuningDatabase{
+    private:
+        std::string path;
+        /// The entries of the file by benchmark, read when the database is opened.
+        llvm::json::Object benchmarks;
+
+        TuningDatabase();
+
+        bool write();
+
+    public:
+        TuningDatabase(const TuningDatabase &) = delete;
+        TuningDatabase &operator=(const TuningDatabase &) = delete;
+
+        /// Returns the database of AS_TUNING_DB.
+        static TuningDatabase &get();
+
+        bool isEnabled();
+
+        /// Replaces the database with the one of the file (the file of
+        /// AS_TUNING_DB is opened first), an empty path disables it. Returns
+        /// false if the file exists and could not be read.
+        bool open(const std::string &path);
+
+        const std::string &getPath();
+
+        /// Reads the entry of the benchmark, the transformations of the schedule
+        /// are created in the arena. Returns false if the benchmark has no entry
+        /// or a transformation of its schedule is unknown.
+        bool lookup(const std::string &benchmark, TuningRecord &record, mlir::MLIRContext *context);
+
+        /// Stores the schedule if the benchmark has no entry or if it is faster
+        /// than the stored one, returns true if the entry was replaced.
+        bool record(const std::string &benchmark, double rootTime, double time,
+                    const std::vector<Transformation *> &schedule);
+
+        /// Returns the parameters of the transformation as a JSON object.
+        static llvm::json::Object serializeTransformation(Transformation *transformation);
+
+        /// Creates the transformation of the JSON object, NULL if its type is unknown.
+        static Transformation *deserializeTransformation(const llvm::json::Object &step, mlir::MLIRContext *context);
+
+        /// Returns the JSON array of the transformations of the schedule.
+        static llvm::json::Array serializeSchedule(const std::vector<Transformation *> &schedule);
+
+        /// Creates the transformations of the JSON array, returns false if one of
+        /// them is unknown.
+        static bool deserializeSchedule(const llvm::json::Array &steps, mlir::MLIRContext *context,
+                                        std::vector<Transformation *> &schedule);
+};
+
+#endif // MLSCEDULER_TUNING_DATABASE_H_
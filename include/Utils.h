@@ -61,6 +61,15 @@ std::string function_wrapper(const std::string &operation, const std::string &ma
 
 llvm::SmallVector<mlir::OpFoldResult> getMixedSizes(llvm::ArrayRef<int64_t> tileSizes, mlir::MLIRContext *context);
 
+/// Returns the random engine of the sampling of the candidates, seeded with
+/// AS_SEED (a random seed without it) so that a search can be repeated. It is
+/// only used by the thread of the search.
+std::mt19937 &getRandomEngine();
+
+/// Restarts the random engine from the seed, at the start of each search of a
+/// long-lived process (daemon, library) so that the search can be repeated.
+void seedRandomEngine(std::mt19937::result_type seed);
+
 mlir::LogicalResult TagSCFForAll(mlir::Operation *Target, std::string tag);
 mlir::LogicalResult TagOperation(mlir::Operation *Target, std::string tag);
 #endif // MLSCHEDULER_UTILS_H_
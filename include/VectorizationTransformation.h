@@ -15,11 +15,20 @@
 #include "Transformation.h"
 #include "MLIRCodeIR.h"
 #include "Node.h"
+#include "SearchTreeArena.h"
+#include "Tracing.h"
+#include "Logger.h"
 #include "TilingTransformation.h"
 #include "ParallelizationTransformation.h"
 #include "TransformDialectInterpreter.h"
 #include "TransformInterpreterPassBase.h"
 #include "Utils.h"
+#include "OpIdentity.h"
+
+#include "mlir/Dialect/Tensor/Transforms/Transforms.h"
+#include "mlir/Dialect/Vector/Transforms/LoweringPatterns.h"
+#include "mlir/Dialect/Vector/Transforms/VectorRewritePatterns.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
 #include <iostream>
 #include <random>
@@ -27,6 +36,10 @@
 class Vectorization: public Transformation{
     private:
         mlir::linalg::LinalgOp * op;
+        /// Stage and identifier (kOpIdAttrName) of the vectorized operation, a
+        /// negative stage for the candidates vectorized by the search.
+        int OperationStage = -1;
+        int64_t targetOpId = -1;
         mlir::MLIRContext *context;
 
     public:
@@ -35,6 +48,10 @@ class Vectorization: public Transformation{
         /// Constructor for Tiling that allows specifying the tile size.
         Vectorization(mlir::linalg::LinalgOp * op, /*llvm::SmallVector<int64_t, 4> tileSizes,*/ mlir::MLIRContext *context);
 
+        /// Constructor for the vectorization of one operation, found by its
+        /// identifier (or its stage) when the transformation is applied.
+        Vectorization(int64_t targetOpId, int OperationStage, mlir::MLIRContext *context);
+
         /// Applies the tiling transformation to the given CodeIR object.
         /// Overrides the applyTransformation() method from the base class Transformation.
         void applyTransformation(CodeIR CodeIr) override;
@@ -44,6 +61,9 @@ class Vectorization: public Transformation{
         /// Overrides the createCandidates() method from the base class Transformation.
         static SmallVector<Node* , 2>  createVectorizationCandidates(Node *node, mlir::MLIRContext *context);
 
+        int getOperationStage();
+        int64_t getTargetOpId();
+
 };
 
 #endif // MLSCHEDULER_VECTORIZATION_TRANSFORMATION_H_
\ No newline at end of file
@@ -0,0 +1,355 @@
+//===---------------------------- Microbench.cpp --------------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the microbenchmarks of the auto-scheduler: the paths
+/// taking most of the tuning time (code cloning, collection of the linalg
+/// operations, enumeration of the tile sizes, generation and materialization of
+/// the parallelization candidates with the fusion of the producers, lowering of
+/// the root code to the LLVM dialect, and with --evaluate the lowering and the
+/// execution of the root code by the runner) are timed on the given benchmarks.
+/// The results are printed, and written in the JSON format of Google Benchmark
+/// with --json, to be compared between revisions with
+/// scripts/compare_microbench.py. With
+/// --calibrate the roofline of the host (peak FMA throughput of one core and of
+/// all cores, streaming bandwidth) is measured and written with the results
+///
+//===----------------------------------------------------------------------===//
+
+#include "EvaluationByExecution.h"
+#include "MLIRCodeIR.h"
+#include "Node.h"
+#include "ParallelizationTransformation.h"
+#include "Roofline.h"
+#include "SearchTreeArena.h"
+#include "Utils.h"
+
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Linalg/TransformOps/DialectExtension.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Transform/IR/TransformDialect.h"
+#include "mlir/Dialect/Vector/TransformOps/VectorTransformOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/InitAllDialects.h"
+#include "mlir/Target/LLVMIR/Dialect/All.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <numeric>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static llvm::cl::list<std::string> inputFilenames(llvm::cl::Positional, llvm::cl::desc("<benchmark.mlir>..."),
+                                                  llvm::cl::OneOrMore);
+static llvm::cl::opt<std::string> benchmarkFilter("filter", llvm::cl::desc("Only the microbenchmarks matching the regex"),
+                                                  llvm::cl::init(".*"));
+static llvm::cl::opt<double> minTimeSeconds("min-time", llvm::cl::desc("Minimum time of a microbenchmark, in seconds"),
+                                            llvm::cl::init(1.0));
+static llvm::cl::opt<int> maxIterations("max-iterations", llvm::cl::desc("Maximum iterations of a microbenchmark"),
+                                        llvm::cl::init(1000000));
+static llvm::cl::opt<std::string> jsonOutput("json", llvm::cl::desc("Writes the results to this JSON file"),
+                                             llvm::cl::init(""));
+static llvm::cl::opt<bool> runEvaluation("evaluate",
+                                         llvm::cl::desc("Times the lowering and the execution of the root code by the "
+                                                        "runner (needs SHARED_LIBS, and AS_CPU_RUNNER or LLVM_PATH)"),
+                                         llvm::cl::init(false));
+static llvm::cl::opt<bool> runCalibration("calibrate", llvm::cl::desc("Measures the roofline of the host"),
+                                          llvm::cl::init(false));
+
+/// Roofline of the host, measured with --calibrate.
+static double peakGflopsSingleCore = 0;
+static double peakGflops = 0;
+static double bandwidth = 0;
+
+/// Timing of the iterations of a microbenchmark, the body of the microbenchmark
+/// times its measured part with startTiming()/stopTiming() (the preparation and
+/// the cleanup of an iteration are not measured).
+class MicrobenchState
+{
+private:
+  std::chrono::steady_clock::time_point start;
+  bool running = false;
+
+public:
+  std::vector<double> iterationNanoseconds;
+  llvm::StringMap<double> counters;
+
+  void startTiming()
+  {
+    this->running = true;
+    this->start = std::chrono::steady_clock::now();
+  }
+  void stopTiming()
+  {
+    auto end = std::chrono::steady_clock::now();
+    if (!this->running)
+      return;
+    this->running = false;
+    this->iterationNanoseconds.push_back(std::chrono::duration<double, std::nano>(end - this->start).count());
+  }
+};
+
+struct MicrobenchResult
+{
+  std::string name;
+  int64_t iterations;
+  double minNanoseconds;
+  double medianNanoseconds;
+  double meanNanoseconds;
+  llvm::StringMap<double> counters;
+};
+
+static std::vector<MicrobenchResult> results;
+
+/// Runs the body until it was timed for --min-time seconds (at least once), and
+/// records the distribution of the iteration times.
+static void runMicrobench(const std::string &name, llvm::function_ref<void(MicrobenchState &)> body)
+{
+  if (!std::regex_search(name, std::regex(benchmarkFilter.getValue())))
+    return;
+  MicrobenchState state;
+  double total = 0;
+  while ((state.iterationNanoseconds.empty() || total < minTimeSeconds * 1e9) &&
+         (int64_t)state.iterationNanoseconds.size() < maxIterations)
+  {
+    size_t before = state.iterationNanoseconds.size();
+    body(state);
+    if (state.iterationNanoseconds.size() == before)
+    {
+      llvm::errs() << name << ": the body did not time any iteration\n";
+      return;
+    }
+    total += state.iterationNanoseconds.back();
+  }
+
+  std::vector<double> times = state.iterationNanoseconds;
+  std::sort(times.begin(), times.end());
+  MicrobenchResult result;
+  result.name = name;
+  result.iterations = times.size();
+  result.minNanoseconds = times.front();
+  result.medianNanoseconds = times[times.size() / 2];
+  result.meanNanoseconds = total / times.size();
+  result.counters = state.counters;
+  llvm::outs() << llvm::format("%-60s %12.0f ns %12.0f ns %10lld", name.c_str(), result.medianNanoseconds,
+                               result.minNanoseconds, (long long)result.iterations);
+  for (auto &counter : result.counters)
+    llvm::outs() << " " << counter.getKey() << "=" << counter.getValue();
+  llvm::outs() << "\n";
+  results.push_back(std::move(result));
+}
+
+static void writeJson(llvm::StringRef path)
+{
+  std::error_code ec;
+  llvm::raw_fd_ostream output(path, ec);
+  if (ec)
+  {
+    llvm::errs() << "Could not open " << path << ": " << ec.message() << "\n";
+    return;
+  }
+  char date[64];
+  std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+  llvm::json::OStream json(output, 2);
+  json.object([&]()
+              {
+    json.attributeObject("context", [&]()
+                         {
+      json.attribute("date", date);
+      json.attribute("executable", "AutoSchedulerMicrobench");
+      json.attribute("num_cpus", (int64_t)std::thread::hardware_concurrency());
+      json.attribute("min_time", minTimeSeconds.getValue());
+      if (runCalibration)
+      {
+        json.attribute("peak_gflops_single_core", peakGflopsSingleCore);
+        json.attribute("peak_gflops", peakGflops);
+        json.attribute("bandwidth_gbs", bandwidth);
+      } });
+    json.attributeArray("benchmarks", [&]()
+                        {
+      for (const MicrobenchResult &result : results)
+      {
+        json.object([&]()
+                    {
+          json.attribute("name", result.name);
+          json.attribute("run_type", "iteration");
+          json.attribute("iterations", result.iterations);
+          json.attribute("real_time", result.medianNanoseconds);
+          json.attribute("cpu_time", result.medianNanoseconds);
+          json.attribute("min_time_ns", result.minNanoseconds);
+          json.attribute("mean_time_ns", result.meanNanoseconds);
+          json.attribute("time_unit", "ns");
+          for (auto &counter : result.counters)
+            json.attribute(counter.getKey(), counter.getValue()); });
+      } }); });
+  output << "\n";
+}
+
+/// Enumerates the tile sizes of the parallelization of an operation with the
+/// given loop bounds, as Parallelization::createParallelizationCandidates does.
+static void runTileCombinationsMicrobench(const std::string &name, llvm::SmallVector<int64_t> upperBounds)
+{
+  llvm::SmallVector<llvm::SmallVector<int64_t, 4>, 4> possibleTileSizes;
+  for (int64_t value : upperBounds)
+  {
+    llvm::SmallVector<int64_t, 4> dividers;
+    for (int64_t i = 2; i < std::min<int64_t>(value, 100); ++i)
+    {
+      if (value % i == 0)
+        dividers.push_back(i);
+    }
+    possibleTileSizes.push_back(dividers);
+  }
+  runMicrobench("generateTileForAllOpCombinations/" + name, [&](MicrobenchState &state)
+                {
+    size_t numCombinations = 0;
+    state.startTiming();
+    for (size_t numberLoops = 2; numberLoops <= upperBounds.size() - 1; ++numberLoops)
+      numCombinations += generateTileForAllOpCombinations(numberLoops, possibleTileSizes, upperBounds).size();
+    state.stopTiming();
+    state.counters["combinations"] = numCombinations; });
+}
+
+static void runBenchmarkMicrobenches(llvm::StringRef inputFilename, mlir::MLIRContext &context)
+{
+  std::string benchmark = llvm::sys::path::stem(inputFilename).str();
+  MLIRCodeIR *codeIr = new MLIRCodeIR();
+  mlir::OwningOpRef<mlir::Operation *> module = codeIr->parseInputFile(inputFilename, context);
+  if (!module)
+    return;
+  mlir::Operation *code = (mlir::Operation *)codeIr->getIr();
+
+  runMicrobench("cloneIr/" + benchmark, [&](MicrobenchState &state)
+                {
+    state.startTiming();
+    MLIRCodeIR *clone = (MLIRCodeIR *)codeIr->cloneIr();
+    state.stopTiming();
+    clone->dropReference(); });
+
+  runMicrobench("getLinalgOps/" + benchmark, [&](MicrobenchState &state)
+                {
+    state.startTiming();
+    llvm::SmallVector<mlir::linalg::LinalgOp, 4> linalgOps = getLinalgOps(code);
+    state.stopTiming();
+    state.counters["operations"] = linalgOps.size(); });
+
+  // The candidates of the first stage are generated, and materialized in the
+  // context of the search (the tiling of the consumer and the fusion of its
+  // producers), as with AS_WORKER_THREADS=1. Each iteration has its own root,
+  // so that the transformations of the candidates are released with the nodes
+  llvm::SmallVector<mlir::linalg::LinalgOp, 4> linalgOps = getLinalgOps(code);
+  if (!linalgOps.empty())
+  {
+    runMicrobench("createParallelizationCandidates/" + benchmark, [&](MicrobenchState &state)
+                  {
+      codeIr->retain();
+      Node *root = SearchTreeArena::get().createNode(codeIr, 0);
+      state.startTiming();
+      SmallVector<Node *, 2> candidates =
+          Parallelization::createParallelizationCandidates(root, &context, 0, linalgOps);
+      for (Node *candidate : candidates)
+        ((MLIRCodeIR *)candidate->getTransformedCodeIr())->getIr();
+      state.stopTiming();
+      state.counters["candidates"] = candidates.size();
+      SearchTreeArena::get().freeNodes(candidates);
+      SearchTreeArena::get().freeNode(root);
+      SearchTreeArena::get().releaseTransformations(); });
+  }
+
+  // The root code is lowered without the runner, each iteration lowers its own
+  // assembled module: the time is the one of the pass pipeline alone
+  Node *root = SearchTreeArena::get().createNode(codeIr, 0);
+  runMicrobench("lowerModule/" + benchmark, [&](MicrobenchState &state)
+                {
+    mlir::Operation *module = codeIr->assembleModule();
+    if (module == nullptr)
+      return;
+    state.startTiming();
+    bool lowered = EvaluationByExecution::lowerModule(module, root, false);
+    state.stopTiming();
+    state.counters["lowered"] = lowered;
+    invalidateOpIdentityIndex(module);
+    module->erase(); });
+
+  // The root code is lowered and run by the runner (mlir-cpu-runner, see
+  // AS_CPU_RUNNER): the time is the one of the whole evaluation
+  if (runEvaluation)
+  {
+    EvaluationByExecution evaluator(benchmark + "_logs_microbench.txt");
+    runMicrobench("lowerAndExecute/" + benchmark, [&](MicrobenchState &state)
+                  {
+      state.startTiming();
+      evaluator.evaluateTransformation(root);
+      state.stopTiming(); });
+  }
+  SearchTreeArena::get().freeNode(root);
+}
+
+int main(int argc, char **argv)
+{
+  llvm::InitLLVM y(argc, argv);
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+  llvm::cl::ParseCommandLineOptions(argc, argv, "Microbenchmarks of the auto-scheduler\n");
+  if (runEvaluation && !isCpuRunnerAvailable())
+  {
+    llvm::errs() << "--evaluate needs the runner: set SHARED_LIBS, and AS_CPU_RUNNER or LLVM_PATH\n";
+    return 1;
+  }
+
+  // Same context as the search
+  mlir::DialectRegistry registry;
+  mlir::registerAllDialects(registry);
+  mlir::registerAllToLLVMIRTranslations(registry);
+  mlir::linalg::registerTransformDialectExtension(registry);
+  mlir::vector::registerTransformDialectExtension(registry);
+  mlir::MLIRContext context(registry);
+  context.loadDialect<mlir::scf::SCFDialect>();
+  context.loadDialect<mlir::vector::VectorDialect>();
+  context.loadDialect<mlir::transform::TransformDialect>();
+
+  if (runCalibration)
+  {
+    unsigned numThreads = std::max(1u, std::thread::hardware_concurrency());
+    peakGflopsSingleCore = Roofline::measurePeakGflops(1);
+    peakGflops = Roofline::measurePeakGflops(numThreads);
+    bandwidth = Roofline::measureBandwidth(numThreads);
+    llvm::outs() << llvm::format("Peak FP32 FMA: %.1f GFLOPS on one core, %.1f GFLOPS on %u threads\n",
+                                 peakGflopsSingleCore, peakGflops, numThreads)
+                 << llvm::format("Streaming bandwidth (triad): %.1f GB/s\n\n", bandwidth);
+  }
+
+  llvm::outs() << llvm::format("%-60s %15s %15s %10s\n", "Microbenchmark", "Median", "Min", "Iterations");
+
+  // Iteration domains of the benchmarks, and larger ones (the loops whose
+  // bound has no divider below 100 have no tile size)
+  runTileCombinationsMicrobench("matmul_1200x1000x1500", {1200, 1000, 1500});
+  runTileCombinationsMicrobench("batch_matmul_96x2048x2048x720", {96, 2048, 2048, 720});
+  runTileCombinationsMicrobench("conv2d_32x112x112x64x4x4x16", {32, 112, 112, 64, 4, 4, 16});
+  runTileCombinationsMicrobench("conv3d_16x60x60x60x32x4x4x4x8", {16, 60, 60, 60, 32, 4, 4, 4, 8});
+
+  for (const std::string &inputFilename : inputFilenames)
+    runBenchmarkMicrobenches(inputFilename, context);
+
+  if (!jsonOutput.empty())
+    writeJson(jsonOutput);
+  return 0;
+}
@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+# Analyzes the search tree exported with AS_SEARCH_TREE=<file.jsonl>: prints a
+# summary of the search, the path to the best candidate and the speedups over
+# the root code by transformation parameter.
+#
+#   python3 scripts/analyze_search_tree.py tree.jsonl [--top 10] [--type Tiling] [--csv out.csv] [--search 0]
+#
+# A file holds the trees of all the searches of the process, the last one is
+# analyzed unless --search gives its index.
+import argparse
+import csv
+import json
+import re
+import statistics
+import sys
+
+FAILED = 9000000000000000000
+
+
+def load(path, search):
+    searches = {}
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line:
+                continue
+            node = json.loads(line)
+            try:
+                node["time"] = float(node["evaluation"])
+            except ValueError:
+                node["time"] = FAILED
+            if node["time"] >= FAILED:
+                node["failed"] = True
+            searches.setdefault(node.get("search", 0), {})[node["id"]] = node
+    if not searches:
+        return {}
+    if search is None:
+        search = max(searches)
+    return searches.get(search, {})
+
+
+def schedule_str(node):
+    return " ".join(step["params"] for step in node["schedule"]) or "root"
+
+
+def best_path(nodes, best):
+    path = []
+    node = best
+    while node is not None:
+        path.append(node)
+        node = nodes.get(node["parent"])
+    return list(reversed(path))
+
+
+def parameter_speedups(nodes, root_time, type_filter):
+    # The parameters of the last transformation of each candidate, in the order
+    # they appear in its printed form, e.g. TP( 4, 8 ) -> (0, 4), (1, 8)
+    groups = {}
+    for node in nodes.values():
+        if node["failed"] or not node["schedule"] or node["time"] <= 0:
+            continue
+        step = node["schedule"][-1]
+        if type_filter and step["type"] != type_filter:
+            continue
+        speedup = root_time / node["time"]
+        for index, value in enumerate(re.findall(r"-?\d+", step["params"])):
+            groups.setdefault((step["type"], index, int(value)), []).append(speedup)
+    return groups
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Analyzes an exported search tree")
+    parser.add_argument("tree", help="JSONL file written with AS_SEARCH_TREE")
+    parser.add_argument("--top", type=int, default=10, help="number of best candidates to print")
+    parser.add_argument("--type", default=None, help="only the parameters of this transformation type")
+    parser.add_argument("--csv", default=None, help="writes the speedups by parameter to this CSV file")
+    parser.add_argument("--search", type=int, default=None, help="index of the search to analyze (the last one)")
+    args = parser.parse_args()
+
+    nodes = load(args.tree, args.search)
+    if not nodes:
+        sys.exit("The search tree is empty")
+
+    roots = [n for n in nodes.values() if not n["schedule"]]
+    root = roots[0] if roots else min(nodes.values(), key=lambda n: n["id"])
+    root_time = root["time"]
+    valid = [n for n in nodes.values() if not n["failed"]]
+    failed = len(nodes) - len(valid)
+    best = min(valid, key=lambda n: n["time"]) if valid else root
+
+    print("Nodes: {}  failed: {}  max depth: {}".format(
+        len(nodes), failed, max(n["depth"] for n in nodes.values())))
+    print("Root: {}".format(root["evaluation"]))
+    print("Best: {} (node {}, speedup {:.3f}x)".format(
+        best["evaluation"], best["id"], root_time / best["time"] if best["time"] > 0 else 0))
+
+    print("\nBest path:")
+    for node in best_path(nodes, best):
+        print("  [{}] {}  {}".format(node["id"], node["evaluation"], schedule_str(node)))
+
+    print("\nTop {} candidates:".format(args.top))
+    for node in sorted(valid, key=lambda n: n["time"])[:args.top]:
+        print("  [{}] {:.3f}x  {}".format(node["id"], root_time / node["time"] if node["time"] > 0 else 0,
+                                          schedule_str(node)))
+
+    groups = parameter_speedups(nodes, root_time, args.type)
+    rows = []
+    for (kind, index, value), speedups in sorted(groups.items()):
+        rows.append([kind, index, value, len(speedups), min(speedups),
+                     statistics.median(speedups), statistics.mean(speedups), max(speedups)])
+
+    print("\nSpeedup by parameter of the last transformation:")
+    print("  {:<16} {:>5} {:>8} {:>6} {:>8} {:>8} {:>8} {:>8}".format(
+        "type", "param", "value", "count", "min", "median", "mean", "max"))
+    for row in rows:
+        print("  {:<16} {:>5} {:>8} {:>6} {:>8.3f} {:>8.3f} {:>8.3f} {:>8.3f}".format(*row))
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.writer(f)
+            writer.writerow(["type", "param", "value", "count", "min", "median", "mean", "max"])
+            writer.writerows(rows)
+
+
+if __name__ == "__main__":
+    main()
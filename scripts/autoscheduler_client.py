@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+# Client of the auto-scheduler daemon (AutoSchedulerML --daemon <socket>). Each
+# message is a 4-byte big-endian length followed by a JSON object, see
+# include/AutoSchedulerDaemon.h for the requests:
+#
+#   python3 scripts/autoscheduler_client.py --socket /tmp/as.sock tune \
+#       benchmarks/matmul.mlir --max-evaluations 100 --output matmul.opt.mlir
+#   python3 scripts/autoscheduler_client.py --socket /tmp/as.sock stats
+#
+# The module is sent as MLIR source, the daemon does not need to see the files
+# of the client. request() can be imported by the build tools.
+import argparse
+import json
+import os
+import socket
+import struct
+import sys
+
+
+def request(socket_path, message, timeout=None):
+    """Sends a request to the daemon and returns its response."""
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as connection:
+        connection.settimeout(timeout)
+        connection.connect(socket_path)
+        payload = json.dumps(message).encode()
+        connection.sendall(struct.pack(">I", len(payload)) + payload)
+        size = struct.unpack(">I", receive(connection, 4))[0]
+        return json.loads(receive(connection, size))
+
+
+def receive(connection, size):
+    data = b""
+    while len(data) < size:
+        chunk = connection.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError("the daemon closed the connection")
+        data += chunk
+    return data
+
+
+def read_module(path):
+    with open(path) as module:
+        return module.read()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Client of the auto-scheduler daemon")
+    parser.add_argument("--socket", default=os.environ.get("AS_DAEMON_SOCKET", "/tmp/autoscheduler.sock"),
+                        help="socket of the daemon (AS_DAEMON_SOCKET)")
+    parser.add_argument("--timeout", type=float, default=None, help="timeout of the request in seconds")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    tune = commands.add_parser("tune", help="search the schedule of a module")
+    tune.add_argument("module")
+    tune.add_argument("--name", help="name of the benchmark, the file name by default")
+    tune.add_argument("--max-evaluations", type=int)
+    tune.add_argument("--time-budget", type=float)
+    tune.add_argument("--fast-math", action="store_true")
+    tune.add_argument("--no-record", action="store_true", help="do not store the schedule in the tuning database")
+    tune.add_argument("--seed", type=int, help="seed of the sampling of the candidates")
+    tune.add_argument("--output", help="file of the transformed module")
+
+    apply = commands.add_parser("apply", help="apply a schedule (JSON array) to a module")
+    apply.add_argument("module")
+    apply.add_argument("schedule", help="file of the schedule, the \"schedule\" of a tune or lookup response")
+    apply.add_argument("--output", help="file of the transformed module")
+
+    lookup = commands.add_parser("lookup", help="read the stored schedule of a benchmark")
+    lookup.add_argument("name")
+
+    for command in ["stats", "ping", "shutdown"]:
+        commands.add_parser(command)
+    args = parser.parse_args()
+
+    message = {"op": args.command}
+    if args.command == "tune":
+        message["module"] = read_module(args.module)
+        message["name"] = args.name or os.path.basename(args.module).split(".")[0]
+        if args.max_evaluations is not None:
+            message["max_evaluations"] = args.max_evaluations
+        if args.time_budget is not None:
+            message["time_budget"] = args.time_budget
+        if args.fast_math:
+            message["fast_math"] = True
+        if args.no_record:
+            message["record"] = False
+        if args.seed is not None:
+            message["seed"] = args.seed
+    elif args.command == "apply":
+        message["module"] = read_module(args.module)
+        with open(args.schedule) as schedule:
+            steps = json.load(schedule)
+        message["schedule"] = steps["schedule"] if isinstance(steps, dict) else steps
+    elif args.command == "lookup":
+        message["name"] = args.name
+
+    response = request(args.socket, message, args.timeout)
+    if response.get("status") != "ok":
+        print("error: " + response.get("error", "unknown error"), file=sys.stderr)
+        return 1
+    output = getattr(args, "output", None)
+    if output and "module" in response:
+        with open(output, "w") as module:
+            module.write(response.pop("module"))
+    json.dump(response, sys.stdout, indent=2)
+    print()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
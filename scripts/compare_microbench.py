@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+# Compares two runs of AutoSchedulerMicrobench (--json output, e.g. the
+# microbench.json of the autoscheduler-microbench target): prints the change of
+# the median time of each microbenchmark, and exits with 1 if one of them is
+# slower than the threshold.
+#
+#   python3 scripts/compare_microbench.py baseline.json microbench.json [--threshold 10]
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        return {b["name"]: b for b in json.load(f)["benchmarks"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compares two microbenchmark runs")
+    parser.add_argument("baseline", help="JSON results of the reference revision")
+    parser.add_argument("contender", help="JSON results of the new revision")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="slowdown in percent reported as a regression")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    contender = load(args.contender)
+
+    regressions = []
+    print("{:<60} {:>14} {:>14} {:>9}".format("Microbenchmark", "Baseline (ns)", "New (ns)", "Change"))
+    for name, new in contender.items():
+        if name not in baseline:
+            print("{:<60} {:>14} {:>14.0f} {:>9}".format(name, "-", new["real_time"], "new"))
+            continue
+        old_time = baseline[name]["real_time"]
+        new_time = new["real_time"]
+        change = (new_time - old_time) / old_time * 100 if old_time > 0 else 0
+        mark = ""
+        if change > args.threshold:
+            regressions.append(name)
+            mark = "  REGRESSION"
+        print("{:<60} {:>14.0f} {:>14.0f} {:>+8.1f}%{}".format(name, old_time, new_time, change, mark))
+    for name in baseline:
+        if name not in contender:
+            print("{:<60} {:>14.0f} {:>14} {:>9}".format(name, baseline[name]["real_time"], "-", "missing"))
+
+    if regressions:
+        print("\n{} regression(s) above {:.0f}%: {}".format(len(regressions), args.threshold, ", ".join(regressions)))
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
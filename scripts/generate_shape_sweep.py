@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+# Generates benchmark modules for a sweep of shapes, in the convention of the
+# benchmarks of benchmarks/ (inputs filled before the first nanoTime call, time
+# printed with printFlops/printI64), and optionally runs the auto-scheduler on
+# them with scripts/run_benchmarks.py.
+#
+# The shapes are a grid (the product of the values of each parameter) or a list
+# (a CSV file with one shape per row, the parameters as columns):
+#
+#   python3 scripts/generate_shape_sweep.py matmul --grid M=128,512,1024 N=512,1024 K=256,1024 --output sweep
+#   python3 scripts/generate_shape_sweep.py conv2d --shapes production_convs.csv --output sweep \
+#       --run --binary build/bin/AutoSchedulerML --llvm-tools-dir <llvm>/build/bin --llvm-lib-dir <llvm>/build/lib
+#
+# sweep/manifest.csv maps each module to its shape, with --run the results of
+# run_benchmarks.py are joined with it in <output>-results.csv.
+import argparse
+import csv
+import itertools
+import os
+import subprocess
+import sys
+
+HEADER = """func.func private @nanoTime() -> i64 attributes { llvm.emit_c_interface }
+func.func private @printFlops(f64)
+func.func private @printI64(i64)
+func.func private @printMemrefF32(tensor<*xf32>)
+"""
+
+TIMING = """  %t0 = func.call @nanoTime() : () -> (i64)
+
+{op}
+
+  %t = func.call @nanoTime() : () -> (i64)
+  %delta = arith.subi %t, %t0 : i64
+  %fp = arith.uitofp %delta : i64 to f64
+  func.call @printFlops(%fp) : (f64) -> ()
+  func.call @printI64(%delta) : (i64) -> ()
+"""
+
+KERNEL = """
+!TTa = tensor<{a}xf32>
+!TTb = tensor<{b}xf32>
+!TTc = tensor<{c}xf32>
+
+func.func @{name}() -> !TTc{{
+
+  %val = arith.constant 2.00000e+00 : f32
+  %zero = arith.constant 0.00000e+00 : f32
+
+  %out = bufferization.alloc_tensor() : !TTa
+  %A = linalg.fill ins(%val : f32) outs(%out : !TTa) -> !TTa
+  %out1 = bufferization.alloc_tensor() : !TTb
+  %B = linalg.fill ins(%val : f32) outs(%out1 : !TTb) -> !TTb
+  %out2 = bufferization.alloc_tensor() : !TTc
+  %C = linalg.fill ins(%zero : f32) outs(%out2 : !TTc) -> !TTc
+
+{timing}
+  return %D : !TTc
+}}
+
+func.func @main(){{
+    %outputmain = func.call @{name}() : () -> !TTc
+    return
+}}
+"""
+
+
+def dims(*values):
+    return "x".join(str(v) for v in values)
+
+
+def matmul(s):
+    op = """  %D = linalg.matmul ins(%A, %B: !TTa, !TTb)
+                    outs(%C: !TTc) -> !TTc"""
+    return dims(s["M"], s["K"]), dims(s["K"], s["N"]), dims(s["M"], s["N"]), op
+
+
+def output_size(size, kernel, stride):
+    return (size - kernel) // stride + 1
+
+
+def conv2d(s):
+    oh = output_size(s["H"], s["KH"], s["stride"])
+    ow = output_size(s["W"], s["KW"], s["stride"])
+    op = """  %D = linalg.conv_2d_nhwc_hwcf {{dilations = dense<1> : tensor<2xi64>,
+                                  strides = dense<{stride}> : tensor<2xi64>}}
+     ins (%A, %B: !TTa, !TTb)
+    outs (%C: !TTc) -> !TTc""".format(stride=s["stride"])
+    return (dims(s["N"], s["H"], s["W"], s["C"]), dims(s["KH"], s["KW"], s["C"], s["F"]),
+            dims(s["N"], oh, ow, s["F"]), op)
+
+
+def pooling(s):
+    oh = output_size(s["H"], s["KH"], s["stride"])
+    ow = output_size(s["W"], s["KW"], s["stride"])
+    op = """  %D = linalg.pooling_nhwc_max {{dilations = dense<1> : tensor<2xi64>, strides = dense<{stride}> : tensor<2xi64>}}
+  ins(%A, %B: !TTa, !TTb)
+  outs(%C: !TTc) -> !TTc""".format(stride=s["stride"])
+    return (dims(s["N"], s["H"], s["W"], s["C"]), dims(s["KH"], s["KW"]),
+            dims(s["N"], oh, ow, s["C"]), op)
+
+
+# The parameters of each kind of operation, with their default values
+KINDS = {
+    "matmul": (matmul, {"M": 1024, "N": 1024, "K": 1024}),
+    "conv2d": (conv2d, {"N": 1, "H": 58, "W": 58, "C": 64, "F": 64, "KH": 3, "KW": 3, "stride": 1}),
+    "pooling": (pooling, {"N": 1, "H": 114, "W": 114, "C": 64, "KH": 3, "KW": 3, "stride": 2}),
+}
+
+
+def parse_grid(kind, items):
+    params = dict((k, [v]) for k, v in KINDS[kind][1].items())
+    for item in items:
+        key, _, values = item.partition("=")
+        if key not in params:
+            sys.exit("Unknown parameter {} of {} (parameters: {})".format(key, kind, ", ".join(params)))
+        params[key] = [int(v) for v in values.split(",") if v]
+    keys = list(params)
+    return [dict(zip(keys, values)) for values in itertools.product(*(params[k] for k in keys))]
+
+
+def parse_list(kind, path):
+    shapes = []
+    with open(path) as f:
+        for row in csv.DictReader(f):
+            shape = dict(KINDS[kind][1])
+            for key, value in row.items():
+                if key not in shape:
+                    sys.exit("Unknown parameter {} of {} in {}".format(key, kind, path))
+                shape[key] = int(value)
+            shapes.append(shape)
+    return shapes
+
+
+def shape_name(kind, shape):
+    return kind + "_" + "_".join("{}{}".format(k, v) for k, v in shape.items())
+
+
+def generate(kind, shapes, directory):
+    os.makedirs(directory, exist_ok=True)
+    manifest = []
+    for shape in shapes:
+        if kind != "matmul" and (shape["H"] < shape["KH"] or shape["W"] < shape["KW"]):
+            print("Skipping {}: the window is larger than the input".format(shape_name(kind, shape)))
+            continue
+        name = shape_name(kind, shape)
+        a, b, c, op = KINDS[kind][0](shape)
+        with open(os.path.join(directory, name + ".mlir"), "w") as f:
+            f.write(HEADER)
+            f.write(KERNEL.format(a=a, b=b, c=c, name=kind, timing=TIMING.format(op=op)))
+        manifest.append(dict(benchmark=name, kind=kind, **shape))
+    with open(os.path.join(directory, "manifest.csv"), "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=["benchmark", "kind"] + list(KINDS[kind][1]))
+        writer.writeheader()
+        writer.writerows(manifest)
+    print("{} modules written to {}".format(len(manifest), directory))
+    return manifest
+
+
+def run(args, manifest):
+    script = os.path.join(os.path.dirname(os.path.abspath(__file__)), "run_benchmarks.py")
+    results = args.output + "-results"
+    command = [sys.executable, script, "--binary", args.binary, "--benchmarks", args.output, "--output", results,
+               "--max-evaluations", str(args.max_evaluations), "--time-budget", str(args.time_budget)]
+    for option in ["runner", "shared_libs", "llvm_tools_dir", "llvm_lib_dir"]:
+        if getattr(args, option):
+            command += ["--" + option.replace("_", "-"), getattr(args, option)]
+    returncode = subprocess.call(command)
+
+    # The results are joined with the shapes
+    with open(results + ".csv") as f:
+        rows = {row["benchmark"]: row for row in csv.DictReader(f)}
+    fields = list(manifest[0]) + ["status", "root_time", "best_time", "speedup", "evaluations", "wall_time_s",
+                                  "best_schedule"]
+    with open(results + ".csv", "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=fields, extrasaction="ignore")
+        writer.writeheader()
+        for entry in manifest:
+            writer.writerow(dict(rows.get(entry["benchmark"], {"status": "missing"}), **entry))
+    print("Results by shape written to {}.csv".format(results))
+    return returncode
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generates (and runs) a sweep of benchmark shapes")
+    parser.add_argument("kind", choices=sorted(KINDS), help="kind of operation")
+    shapes = parser.add_mutually_exclusive_group(required=True)
+    shapes.add_argument("--grid", nargs="+", metavar="PARAM=V1,V2,...",
+                        help="values of the parameters, the sweep is their product")
+    shapes.add_argument("--shapes", metavar="CSV", help="list of shapes, one per row, the parameters as columns")
+    parser.add_argument("--output", default="sweep", help="directory of the generated modules")
+    parser.add_argument("--run", action="store_true", help="runs the auto-scheduler on the modules")
+    parser.add_argument("--binary", default=None, help="path of AutoSchedulerML (--run)")
+    parser.add_argument("--max-evaluations", type=int, default=200, help="evaluations per shape (0: no limit)")
+    parser.add_argument("--time-budget", type=float, default=600, help="seconds per shape (0: no limit)")
+    parser.add_argument("--runner", default=None, help="path of mlir-cpu-runner")
+    parser.add_argument("--shared-libs", default=None, help="comma separated runner libraries")
+    parser.add_argument("--llvm-tools-dir", default=None, help="directory of mlir-cpu-runner")
+    parser.add_argument("--llvm-lib-dir", default=None, help="directory of the runner libraries")
+    args = parser.parse_args()
+
+    if args.grid:
+        shape_list = parse_grid(args.kind, args.grid)
+    else:
+        shape_list = parse_list(args.kind, args.shapes)
+    manifest = generate(args.kind, shape_list, args.output)
+    if args.run and manifest:
+        if not args.binary:
+            sys.exit("--run needs --binary")
+        sys.exit(run(args, manifest))
+
+
+if __name__ == "__main__":
+    main()
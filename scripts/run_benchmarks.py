@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+# Runs the auto-scheduler on every benchmark of benchmarks/ under a fixed
+# budget and writes the results (root time, best time, speedup, evaluations,
+# wall time) to <output>.csv and <output>.json. Used by the autoscheduler-bench
+# target, it can also be run by hand:
+#
+#   python3 scripts/run_benchmarks.py --binary build/bin/AutoSchedulerML \
+#       --llvm-tools-dir <llvm>/build/bin --llvm-lib-dir <llvm>/build/lib
+#
+# With --tuning-db the best schedule of each benchmark is stored in the database
+# (AS_TUNING_DB) when it is faster than the stored one. With --regress the
+# stored schedules are replayed and measured instead of searching, a benchmark
+# slower than its recorded time by more than --threshold percent has the status
+# "regression" (the autoscheduler-regress target). With --roofline the GFLOPS of
+# the best schedule are compared with the roofline of the host, calibrated once
+# for the suite (<output>-roofline.json).
+import argparse
+import csv
+import glob
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+FIELDS = ["benchmark", "status", "root_time", "best_time", "speedup", "evaluations",
+          "cached_evaluations", "skipped_evaluations", "verification_failures", "budget_exhausted", "wall_time_s",
+          "recorded_time", "slowdown_pct", "achieved_gflops", "arithmetic_intensity", "roofline_gflops",
+          "roofline_fraction", "best_schedule"]
+
+RUNNER_LIBS = ["libmlir_runner_utils.so", "libmlir_c_runner_utils.so", "libomp.so"]
+
+
+def runner_environment(args):
+    env = dict(os.environ)
+    if args.runner:
+        env["AS_CPU_RUNNER"] = args.runner
+    elif args.llvm_tools_dir:
+        env["AS_CPU_RUNNER"] = os.path.join(args.llvm_tools_dir, "mlir-cpu-runner")
+    if args.shared_libs:
+        env["SHARED_LIBS"] = args.shared_libs
+    elif args.llvm_lib_dir:
+        libs = [os.path.join(args.llvm_lib_dir, lib) for lib in RUNNER_LIBS]
+        env["SHARED_LIBS"] = ",".join(lib for lib in libs if os.path.exists(lib))
+    if "AS_CPU_RUNNER" not in env and "LLVM_PATH" not in env:
+        sys.exit("No mlir-cpu-runner: pass --runner or --llvm-tools-dir (or set LLVM_PATH)")
+    if not env.get("SHARED_LIBS"):
+        sys.exit("No runner libraries: pass --shared-libs or --llvm-lib-dir (or set SHARED_LIBS)")
+    if args.roofline or args.roofline_stop_fraction > 0:
+        env["AS_ROOFLINE"] = "1"
+        env["AS_ROOFLINE_CACHE"] = os.path.abspath(args.output + "-roofline.json")
+    if args.roofline_stop_fraction > 0:
+        env["AS_ROOFLINE_STOP_FRACTION"] = str(args.roofline_stop_fraction)
+    if args.tuning_db:
+        env["AS_TUNING_DB"] = os.path.abspath(args.tuning_db)
+    if args.regress:
+        if not args.tuning_db:
+            sys.exit("--regress needs --tuning-db")
+        env["AS_REGRESS"] = "1"
+        env["AS_REGRESS_THRESHOLD"] = str(args.threshold)
+        env["AS_REGRESS_REPEAT"] = str(args.repeat)
+        return env
+    if args.max_evaluations > 0:
+        env["AS_MAX_EVALUATIONS"] = str(args.max_evaluations)
+    if args.time_budget > 0:
+        env["AS_TIME_BUDGET"] = str(args.time_budget)
+    return env
+
+
+def run_benchmark(args, env, path):
+    name = os.path.splitext(os.path.basename(path))[0]
+    result = {"benchmark": name}
+    # The auto-scheduler writes its logs and schedules in the working directory
+    with tempfile.TemporaryDirectory(prefix="as-bench-" + name + "-") as workdir:
+        summary = os.path.join(workdir, "summary.json")
+        run_env = dict(env, AS_SUMMARY_FILE=summary)
+        # The time budget is checked between evaluations, the timeout stops a
+        # run stuck in one
+        timeout = args.time_budget * 2 + 600 if args.time_budget > 0 else None
+        start = time.time()
+        try:
+            with open(os.path.join(args.log_dir, name + ".log"), "w") as log:
+                process = subprocess.run([os.path.abspath(args.binary), os.path.abspath(path)], cwd=workdir,
+                                         env=run_env, stdout=log, stderr=subprocess.STDOUT, timeout=timeout)
+            status = "ok" if process.returncode == 0 else "exit " + str(process.returncode)
+            if args.regress and process.returncode in (1, 2):
+                status = "regression" if process.returncode == 1 else "no schedule"
+        except subprocess.TimeoutExpired:
+            status = "timeout"
+        result["wall_time_s"] = round(time.time() - start, 3)
+        if os.path.exists(summary):
+            with open(summary) as f:
+                result.update(json.load(f))
+            result["benchmark"] = name
+        elif status == "ok":
+            status = "no summary"
+        result["status"] = status
+    return result
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description="Runs the benchmark suite of the auto-scheduler")
+    parser.add_argument("--binary", required=True, help="path of AutoSchedulerML")
+    parser.add_argument("--benchmarks", default=os.path.join(root, "benchmarks"),
+                        help="directory of the .mlir benchmarks")
+    parser.add_argument("--filter", default=None, help="only the benchmarks whose name contains this string")
+    parser.add_argument("--output", default="autoscheduler-bench",
+                        help="results prefix, <output>.csv and <output>.json are written")
+    parser.add_argument("--max-evaluations", type=int, default=200, help="evaluations per benchmark (0: no limit)")
+    parser.add_argument("--time-budget", type=float, default=600, help="seconds per benchmark (0: no limit)")
+    parser.add_argument("--runner", default=None, help="path of mlir-cpu-runner")
+    parser.add_argument("--shared-libs", default=None, help="comma separated runner libraries")
+    parser.add_argument("--llvm-tools-dir", default=None, help="directory of mlir-cpu-runner")
+    parser.add_argument("--llvm-lib-dir", default=None, help="directory of the runner libraries")
+    parser.add_argument("--tuning-db", default=None, help="JSON database of the best schedules (AS_TUNING_DB)")
+    parser.add_argument("--regress", action="store_true",
+                        help="replays the stored schedules and compares their time with the recorded one")
+    parser.add_argument("--threshold", type=float, default=10,
+                        help="slowdown in percent reported as a regression (--regress)")
+    parser.add_argument("--repeat", type=int, default=3, help="runs of each stored schedule, the fastest is kept")
+    parser.add_argument("--roofline", action="store_true", help="reports the fraction of the roofline reached")
+    parser.add_argument("--roofline-stop-fraction", type=float, default=0,
+                        help="stops a search within this fraction of the roofline (0.8: 80%%, 0: never)")
+    args = parser.parse_args()
+
+    env = runner_environment(args)
+    benchmarks = sorted(glob.glob(os.path.join(args.benchmarks, "*.mlir")))
+    if args.filter:
+        benchmarks = [b for b in benchmarks if args.filter in os.path.basename(b)]
+    if not benchmarks:
+        sys.exit("No benchmark in " + args.benchmarks)
+    args.log_dir = os.path.abspath(args.output + "-logs")
+    os.makedirs(args.log_dir, exist_ok=True)
+
+    results = []
+    for path in benchmarks:
+        print("Running {} ...".format(os.path.basename(path)), flush=True)
+        result = run_benchmark(args, env, path)
+        results.append(result)
+        if args.regress and "recorded_time" in result:
+            print("  {}: {:+.1f}% against the recorded time".format(result["status"], result["slowdown_pct"]),
+                  flush=True)
+        elif "speedup" in result:
+            roofline = ""
+            if "roofline_fraction" in result:
+                roofline = ", {:.1f} GFLOPS ({:.0%} of the roofline)".format(result["achieved_gflops"],
+                                                                          result["roofline_fraction"])
+            print("  {}: {:.3f}x in {} evaluations, {:.1f} s{}".format(
+                result["status"], result["speedup"], result["evaluations"], result["wall_time_s"], roofline),
+                flush=True)
+        else:
+            print("  {} (see {}.log)".format(result["status"], os.path.join(args.log_dir, result["benchmark"])),
+                  flush=True)
+
+    with open(args.output + ".csv", "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=FIELDS, extrasaction="ignore")
+        writer.writeheader()
+        writer.writerows(results)
+    with open(args.output + ".json", "w") as f:
+        json.dump({"max_evaluations": args.max_evaluations, "time_budget_s": args.time_budget,
+                   "regress": args.regress, "results": results}, f, indent=2)
+    print("Results written to {}.csv and {}.json".format(args.output, args.output))
+    if any(r["status"] != "ok" for r in results):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+# Measures the tuning efficiency of the auto-scheduler: each search strategy is
+# run on each benchmark with several seeds (AS_SEED), and the anytime trace of
+# each run (AS_ANYTIME_FILE, the best time after each evaluation) gives the
+# quality of the incumbent over the wall time and over the evaluations. The
+# quality is the best time found by any run of the benchmark divided by the
+# time of the incumbent (1 is the best known schedule).
+#
+# A strategy is a name and the environment of its runs, the default one is the
+# search of AutoSchedulerML as configured:
+#
+#   python3 scripts/tuning_efficiency.py --binary build/bin/AutoSchedulerML \
+#       --llvm-tools-dir <llvm>/build/bin --llvm-lib-dir <llvm>/build/lib \
+#       --strategy default --strategy "fastmath:AS_FASTMATH=1" --seeds 5
+#
+# Writes <output>-curves.csv (the anytime curves), <output>-runs.csv (one row
+# per run) and <output>-summary.csv: for each strategy and benchmark, the final
+# quality and the wall time and evaluations to reach each --levels fraction of
+# the best (median over the seeds that reached it), and the mean quality over
+# the time horizon of the benchmark (the area under the curve).
+import argparse
+import csv
+import glob
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from run_benchmarks import runner_environment  # noqa: E402
+
+
+def parse_strategy(text):
+    name, _, assignments = text.partition(":")
+    env = {}
+    for assignment in filter(None, assignments.split(",")):
+        key, _, value = assignment.partition("=")
+        env[key] = value
+    return name, env
+
+
+def read_trace(path):
+    points = []
+    if not os.path.exists(path):
+        return points
+    with open(path) as f:
+        for row in csv.DictReader(f):
+            if row["incumbent_ns"]:
+                points.append((int(row["evaluation"]), float(row["elapsed_s"]), float(row["incumbent_ns"])))
+    return points
+
+
+def run(args, env, strategy, strategy_env, path, seed):
+    name = os.path.splitext(os.path.basename(path))[0]
+    with tempfile.TemporaryDirectory(prefix="as-efficiency-" + name + "-") as workdir:
+        trace = os.path.join(workdir, "anytime.csv")
+        run_env = dict(env, AS_ANYTIME_FILE=trace, AS_SEED=str(seed), **strategy_env)
+        timeout = args.time_budget * 2 + 600 if args.time_budget > 0 else None
+        log_name = "{}-{}-{}.log".format(strategy, name, seed)
+        start = time.time()
+        try:
+            with open(os.path.join(args.log_dir, log_name), "w") as log:
+                process = subprocess.run([os.path.abspath(args.binary), os.path.abspath(path)], cwd=workdir,
+                                         env=run_env, stdout=log, stderr=subprocess.STDOUT, timeout=timeout)
+            status = "ok" if process.returncode == 0 else "exit " + str(process.returncode)
+        except subprocess.TimeoutExpired:
+            status = "timeout"
+        points = read_trace(trace)
+    return {"strategy": strategy, "benchmark": name, "seed": seed, "status": status,
+            "wall_time_s": round(time.time() - start, 3), "points": points}
+
+
+def quality_steps(points, best, key):
+    """Incumbent quality as a step function of the key (1: wall time, 0: evaluations)."""
+    return [(p[key], best / p[2]) for p in points]
+
+
+def first_reaching(steps, level):
+    for x, quality in steps:
+        if quality >= level:
+            return x
+    return None
+
+
+def mean_quality(steps, horizon):
+    """Mean quality over [0, horizon] of the step function (0 before the first point)."""
+    if not steps or horizon <= 0:
+        return 0.0
+    area = 0.0
+    for i, (x, quality) in enumerate(steps):
+        end = steps[i + 1][0] if i + 1 < len(steps) else horizon
+        area += quality * max(0.0, min(end, horizon) - min(x, horizon))
+    return area / horizon
+
+
+def median_or_none(values):
+    values = [v for v in values if v is not None]
+    return statistics.median(values) if values else None
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description="Time-to-quality curves of the search strategies")
+    parser.add_argument("--binary", required=True, help="path of AutoSchedulerML")
+    parser.add_argument("--benchmarks", default=os.path.join(root, "benchmarks"),
+                        help="directory of the .mlir benchmarks")
+    parser.add_argument("--filter", default=None, help="only the benchmarks whose name contains this string")
+    parser.add_argument("--strategy", action="append", default=None, metavar="NAME[:VAR=VALUE,...]",
+                        help="search strategy and its environment, can be repeated (default: default)")
+    parser.add_argument("--seeds", type=int, default=3, help="runs of each strategy on each benchmark")
+    parser.add_argument("--first-seed", type=int, default=1, help="seed of the first run")
+    parser.add_argument("--levels", default="0.9,0.95", help="fractions of the best reported in the summary")
+    parser.add_argument("--output", default="tuning-efficiency", help="results prefix")
+    parser.add_argument("--max-evaluations", type=int, default=200, help="evaluations per run (0: no limit)")
+    parser.add_argument("--time-budget", type=float, default=600, help="seconds per run (0: no limit)")
+    parser.add_argument("--runner", default=None, help="path of mlir-cpu-runner")
+    parser.add_argument("--shared-libs", default=None, help="comma separated runner libraries")
+    parser.add_argument("--llvm-tools-dir", default=None, help="directory of mlir-cpu-runner")
+    parser.add_argument("--llvm-lib-dir", default=None, help="directory of the runner libraries")
+    parser.set_defaults(tuning_db=None, regress=False, roofline=False, roofline_stop_fraction=0)
+    args = parser.parse_args()
+
+    env = runner_environment(args)
+    strategies = [parse_strategy(s) for s in (args.strategy or ["default"])]
+    levels = [float(level) for level in args.levels.split(",") if level]
+    benchmarks = sorted(glob.glob(os.path.join(args.benchmarks, "*.mlir")))
+    if args.filter:
+        benchmarks = [b for b in benchmarks if args.filter in os.path.basename(b)]
+    if not benchmarks:
+        sys.exit("No benchmark in " + args.benchmarks)
+    args.log_dir = os.path.abspath(args.output + "-logs")
+    os.makedirs(args.log_dir, exist_ok=True)
+
+    runs = []
+    for path in benchmarks:
+        for strategy, strategy_env in strategies:
+            for seed in range(args.first_seed, args.first_seed + args.seeds):
+                print("Running {} with {} (seed {}) ...".format(os.path.basename(path), strategy, seed), flush=True)
+                result = run(args, env, strategy, strategy_env, path, seed)
+                final = result["points"][-1][2] if result["points"] else None
+                print("  {}: {} evaluations, best {}".format(result["status"], len(result["points"]), final),
+                      flush=True)
+                runs.append(result)
+
+    # The reference of each benchmark is the best time of all its runs, its
+    # horizon the longest run
+    best = {}
+    horizon = {}
+    for r in runs:
+        if r["points"]:
+            best[r["benchmark"]] = min(best.get(r["benchmark"], float("inf")), min(p[2] for p in r["points"]))
+            horizon[r["benchmark"]] = max(horizon.get(r["benchmark"], 0), r["points"][-1][1])
+
+    with open(args.output + "-curves.csv", "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(["strategy", "benchmark", "seed", "evaluation", "elapsed_s", "incumbent_ns", "quality"])
+        for r in runs:
+            for evaluation, elapsed, incumbent in r["points"]:
+                writer.writerow([r["strategy"], r["benchmark"], r["seed"], evaluation, elapsed, incumbent,
+                                 best[r["benchmark"]] / incumbent])
+
+    run_fields = ["strategy", "benchmark", "seed", "status", "evaluations", "wall_time_s", "final_quality",
+                  "mean_quality"]
+    for level in levels:
+        run_fields += ["time_to_{:g}".format(level), "evaluations_to_{:g}".format(level)]
+    run_rows = []
+    for r in runs:
+        row = {k: r[k] for k in ["strategy", "benchmark", "seed", "status", "wall_time_s"]}
+        row["evaluations"] = len(r["points"])
+        if r["points"]:
+            reference = best[r["benchmark"]]
+            by_time = quality_steps(r["points"], reference, 1)
+            by_evaluation = quality_steps(r["points"], reference, 0)
+            row["final_quality"] = by_time[-1][1]
+            row["mean_quality"] = mean_quality(by_time, horizon[r["benchmark"]])
+            for level in levels:
+                row["time_to_{:g}".format(level)] = first_reaching(by_time, level)
+                row["evaluations_to_{:g}".format(level)] = first_reaching(by_evaluation, level)
+        run_rows.append(row)
+    with open(args.output + "-runs.csv", "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=run_fields)
+        writer.writeheader()
+        writer.writerows(run_rows)
+
+    summary_fields = ["strategy", "benchmark", "seeds", "final_quality_mean", "final_quality_min",
+                      "mean_quality"]
+    for level in levels:
+        summary_fields += ["time_to_{:g}_median".format(level), "evaluations_to_{:g}_median".format(level),
+                           "reached_{:g}".format(level)]
+    summary = []
+    for path in benchmarks:
+        name = os.path.splitext(os.path.basename(path))[0]
+        for strategy, _ in strategies:
+            rows = [r for r in run_rows if r["strategy"] == strategy and r["benchmark"] == name
+                    and "final_quality" in r]
+            row = {"strategy": strategy, "benchmark": name, "seeds": len(rows)}
+            if rows:
+                row["final_quality_mean"] = statistics.mean(r["final_quality"] for r in rows)
+                row["final_quality_min"] = min(r["final_quality"] for r in rows)
+                row["mean_quality"] = statistics.mean(r["mean_quality"] for r in rows)
+                for level in levels:
+                    times = [r["time_to_{:g}".format(level)] for r in rows]
+                    row["time_to_{:g}_median".format(level)] = median_or_none(times)
+                    row["evaluations_to_{:g}_median".format(level)] = median_or_none(
+                        [r["evaluations_to_{:g}".format(level)] for r in rows])
+                    row["reached_{:g}".format(level)] = "{}/{}".format(sum(t is not None for t in times), len(rows))
+            summary.append(row)
+    with open(args.output + "-summary.csv", "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=summary_fields)
+        writer.writeheader()
+        writer.writerows(summary)
+
+    level = levels[-1] if levels else None
+    print("\n{:<24} {:<24} {:>8} {:>10}{}".format("Strategy", "Benchmark", "Quality", "Mean",
+                                                  " {:>14}".format("Time to {:g}".format(level)) if level else ""))
+    for row in summary:
+        if "final_quality_mean" not in row:
+            print("{:<24} {:<24} {:>8}".format(row["strategy"], row["benchmark"], "failed"))
+            continue
+        reached = ""
+        if level:
+            value = row["time_to_{:g}_median".format(level)]
+            reached = " {:>14}".format("{:.1f} s".format(value) if value is not None else "-")
+        print("{:<24} {:<24} {:>8.3f} {:>10.3f}{}".format(row["strategy"], row["benchmark"],
+                                                          row["final_quality_mean"], row["mean_quality"], reached))
+    print("Results written to {0}-curves.csv, {0}-runs.csv and {0}-summary.csv".format(args.output))
+    if any(r["status"] != "ok" for r in runs):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
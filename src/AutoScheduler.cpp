@@ -0,0 +1,537 @@
+//===---------------------- AutoScheduler.cpp AutoScheduler ---------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the AutoScheduler class, which runs
+/// the search of the schedules and replays them
+///
+//===----------------------------------------------------------------------===//
+#include "AutoScheduler.h"
+
+#include "EvaluationByExecution.h"
+#include "TilingTransformation.h"
+#include "ParallelizationTransformation.h"
+#include "VectorizationTransformation.h"
+#include "ConcurrencyTransformation.h"
+#include "BufferizationTransformation.h"
+#include "FastMathTransformation.h"
+#include "SearchTreeArena.h"
+#include "OpIdentity.h"
+#include "Utils.h"
+#include "Logger.h"
+#include "Tracing.h"
+
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Bufferization/IR/Bufferization.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Linalg/TransformOps/DialectExtension.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Shape/IR/Shape.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Transform/IR/TransformDialect.h"
+#include "mlir/Dialect/Vector/IR/VectorOps.h"
+#include "mlir/Dialect/Vector/TransformOps/VectorTransformOps.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/InitAllDialects.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Target/LLVMIR/Dialect/All.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+
+using namespace mlir;
+
+/// Returns true if the environment variable is set to 1.
+static bool isEnvFlagSet(const char *name)
+{
+  return std::getenv(name) != nullptr && std::stoi(std::getenv(name)) == 1;
+}
+
+/// Returns the operation of each stage in the code: the stages are the linalg
+/// operations of the root code, found by their identifiers since tiling and
+/// fusion add linalg operations. A stage whose operation is not found is null.
+static SmallVector<linalg::LinalgOp, 4> getStageOps(mlir::Operation *code, llvm::ArrayRef<int64_t> stageOpIds)
+{
+  SmallVector<linalg::LinalgOp, 4> stageOps;
+  for (int stage = 0; stage < (int)stageOpIds.size(); ++stage)
+    stageOps.push_back(dyn_cast_or_null<linalg::LinalgOp>(findStageOp(code, stageOpIds[stage], stage)));
+  return stageOps;
+}
+
+// Frees a candidate that lost the greedy selection. The nodes of the search tree
+// (the root and the parallelization candidates, printed in the schedule) are
+// kept, their code is parked until it is expanded again.
+static void pruneCandidate(Node *node, Node *bestEval, const llvm::SmallPtrSetImpl<Node *> &treeNodes)
+{
+  if (node == bestEval)
+    return;
+  if (treeNodes.count(node))
+  {
+    ((MLIRCodeIR *)node->getTransformedCodeIr())->park();
+    return;
+  }
+  SearchTreeArena::get().freeNode(node);
+}
+
+/// Evaluates the candidates and keeps the best one in bestEval, the others are
+/// pruned.
+static void selectBest(llvm::ArrayRef<Node *> candidates, Node *&bestEval, EvaluationByExecution &evaluator,
+                       const llvm::SmallPtrSetImpl<Node *> &treeNodes)
+{
+  for (Node *candidate : candidates)
+  {
+    std::string evaluation = evaluator.evaluateTransformation(candidate);
+    candidate->setEvaluation(evaluation);
+
+    if (std::stod(bestEval->getEvaluation()) > std::stod(evaluation))
+    {
+      AS_LOG(LogLevel::Info, "We changed the node");
+      Node *previousBest = bestEval;
+      bestEval = candidate;
+      pruneCandidate(previousBest, bestEval, treeNodes);
+    }
+    else
+      pruneCandidate(candidate, bestEval, treeNodes);
+  }
+}
+
+TuningConfig TuningConfig::fromEnvironment(const std::string &name)
+{
+  TuningConfig config;
+  config.name = name;
+  if (std::getenv("AS_MAX_EVALUATIONS") != nullptr)
+    config.maxEvaluations = std::stoi(std::getenv("AS_MAX_EVALUATIONS"));
+  if (std::getenv("AS_TIME_BUDGET") != nullptr)
+    config.timeBudget = std::stod(std::getenv("AS_TIME_BUDGET"));
+  config.fastMath = isEnvFlagSet("AS_FASTMATH");
+  config.roofline = Roofline::get().isEnabled();
+  config.rooflineStopFraction = Roofline::get().getStopFraction();
+  if (std::getenv("AS_TUNING_DB") != nullptr)
+    config.tuningDbPath = std::getenv("AS_TUNING_DB");
+  if (std::getenv("AS_REGRESS_REPEAT") != nullptr)
+    config.regressRepeat = std::max(1, std::stoi(std::getenv("AS_REGRESS_REPEAT")));
+  if (std::getenv("AS_REGRESS_THRESHOLD") != nullptr)
+    config.regressThreshold = std::stod(std::getenv("AS_REGRESS_THRESHOLD"));
+  if (std::getenv("AS_SEED") != nullptr)
+    config.seed = std::stoul(std::getenv("AS_SEED"));
+  return config;
+}
+
+std::string TuningConfig::getLogsFileName() const
+{
+  return this->name + "_logs_best_exhustive_debug_single_op_vect_all.txt";
+}
+
+std::string TuningResult::printBestSchedule() const
+{
+  std::ostringstream schedule;
+  for (Transformation *transformation : this->bestSchedule)
+    schedule << transformation->printTransformation() << " ";
+  return schedule.str();
+}
+
+AutoScheduler::AutoScheduler()
+{
+  registerDialects(this->registry);
+  this->context = std::make_unique<mlir::MLIRContext>();
+  this->context->appendDialectRegistry(this->registry);
+  this->context->loadDialect<scf::SCFDialect>();
+  this->context->loadDialect<vector::VectorDialect>();
+  this->context->loadDialect<mlir::transform::TransformDialect>();
+  this->contextPool = std::make_unique<ContextPool>(this->registry, this->context.get());
+}
+
+void AutoScheduler::registerDialects(mlir::DialectRegistry &registry)
+{
+  registerAllDialects(registry);
+  mlir::registerAllToLLVMIRTranslations(registry);
+  registry.insert<affine::AffineDialect, scf::SCFDialect,
+                  linalg::LinalgDialect,
+                  arith::ArithDialect,
+                  func::FuncDialect,
+                  memref::MemRefDialect,
+                  transform::TransformDialect,
+                  bufferization::BufferizationDialect,
+                  tensor::TensorDialect,
+                  vector::VectorDialect,
+                  shape::ShapeDialect>();
+  mlir::linalg::registerTransformDialectExtension(registry);
+  mlir::vector::registerTransformDialectExtension(registry);
+}
+
+mlir::MLIRContext *AutoScheduler::getContext()
+{
+  return this->context.get();
+}
+
+mlir::OwningOpRef<mlir::Operation *> AutoScheduler::parseFile(llvm::StringRef filename, MLIRCodeIR *&code)
+{
+  llvm::TimeTraceScope traceScope("Parse input", filename);
+  auto newCode = std::make_unique<MLIRCodeIR>();
+  mlir::OwningOpRef<mlir::Operation *> module = newCode->parseInputFile(filename, *this->context);
+  code = nullptr;
+  if (!module)
+    return nullptr;
+  code = newCode.get();
+  this->codes.push_back(std::move(newCode));
+  return module;
+}
+
+mlir::OwningOpRef<mlir::Operation *> AutoScheduler::parseSource(llvm::StringRef source, std::string *diagnostics)
+{
+  if (!diagnostics)
+    return mlir::parseSourceString<mlir::ModuleOp>(source, this->context.get());
+  llvm::raw_string_ostream diagnosticsStream(*diagnostics);
+  mlir::ScopedDiagnosticHandler handler(this->context.get(), [&](mlir::Diagnostic &diagnostic)
+                                        {
+    diagnosticsStream << diagnostic << "\n";
+    return mlir::success(); });
+  mlir::OwningOpRef<mlir::Operation *> module = mlir::parseSourceString<mlir::ModuleOp>(source, this->context.get());
+  diagnosticsStream.flush();
+  return module;
+}
+
+MLIRCodeIR *AutoScheduler::loadModule(mlir::Operation *module)
+{
+  auto code = std::make_unique<MLIRCodeIR>();
+  code->loadModule(module);
+  this->codes.push_back(std::move(code));
+  return this->codes.back().get();
+}
+
+TuningResult AutoScheduler::tune(MLIRCodeIR *code, const TuningConfig &config)
+{
+  mlir::MLIRContext &context = *this->context;
+  if (!config.tuningDbPath.empty() && config.tuningDbPath != TuningDatabase::get().getPath())
+    TuningDatabase::get().open(config.tuningDbPath);
+  // Each search samples the same candidates for the same seed, whatever the
+  // searches run before it in the process
+  if (config.seed >= 0)
+    seedRandomEngine((std::mt19937::result_type)config.seed);
+
+  SearchTreeRecorder::get().beginSearch(config.name);
+
+  TuningResult result;
+  Node *root = SearchTreeArena::get().createNode(code, 0);
+  result.root = root;
+  EvaluationByExecution evaluator(config.getLogsFileName());
+  evaluator.setBudget(config.maxEvaluations, config.timeBudget);
+  evaluator.setReferenceCode(code);
+  SmallVector<mlir::linalg::LinalgOp, 4> linalgOps = getLinalgOps((mlir::Operation *)code->getIr());
+  SmallVector<int64_t, 4> stageOpIds;
+  for (linalg::LinalgOp op : linalgOps)
+    stageOpIds.push_back(getOpId(op));
+
+  // Evaluate the root transformation
+  Node *bestEval = root;
+  result.rootEvaluation = evaluator.evaluateTransformation(bestEval);
+  bestEval->setEvaluation(result.rootEvaluation);
+
+  // Roofline bound of the code, the search stops within rooflineStopFraction
+  // of it
+  if (config.roofline || config.rooflineStopFraction > 0)
+  {
+    result.kernelCost = Roofline::computeKernelCost((mlir::Operation *)code->getIr());
+    result.rooflineGflops = Roofline::get().getAttainableGflops(result.kernelCost.getArithmeticIntensity());
+    AS_LOG(LogLevel::Info, "Cost of " << config.name << ": " << result.kernelCost.flops << " flops, "
+                                      << result.kernelCost.bytes << " bytes, roofline bound "
+                                      << result.rooflineGflops << " GFLOPS");
+    // The evaluations are nanoseconds, a GFLOPS is a flop per nanosecond
+    if (config.rooflineStopFraction > 0 && result.kernelCost.flops > 0 && result.rooflineGflops > 0)
+      evaluator.setTargetEvaluation(result.kernelCost.flops /
+                                    (result.rooflineGflops * config.rooflineStopFraction));
+  }
+
+  bool changed = true;
+  int stage = bestEval->getCurrentStage();
+  AS_LOG(LogLevel::Debug, "Number of opeartions = " << linalgOps.size());
+  SmallVector<Node *, 2> nodesToVect;
+  llvm::SmallPtrSet<Node *, 16> treeNodes;
+  treeNodes.insert(root);
+  while (stage < (int)linalgOps.size() - 1)
+  {
+    if (!changed)
+    {
+      stage++;
+      bestEval->setCurrentStage(stage);
+    }
+    SmallVector<Node *, 2> optList;
+    mlir::Operation *newOp = ((mlir::Operation *)(*((MLIRCodeIR *)bestEval->getTransformedCodeIr()))
+                                  .getIr());
+    // The code of the best candidate could not be materialized (its parked
+    // code cannot be read), the search of the phase stops with it
+    if (newOp == nullptr)
+    {
+      AS_LOG(LogLevel::Warning, "Could not materialize the best candidate, the parallelization stops");
+      break;
+    }
+    linalgOps = getStageOps(newOp, stageOpIds);
+    if (!linalgOps[stage])
+    {
+      AS_LOG(LogLevel::Warning, "No operation of stage " << stage << " in the best candidate, the stage is skipped");
+      changed = false;
+      continue;
+    }
+    int OpToVectStage = stage;
+    int64_t OpToVectId = getOpId(linalgOps[stage]);
+    auto start = std::chrono::high_resolution_clock::now();
+    AS_LOG(LogLevel::Debug, " CUURET STAGE FOR PARA : " << stage);
+    AS_LOG(LogLevel::Debug, "Number of opeartions IPDATED = " << linalgOps.size());
+
+    optList = Parallelization::createParallelizationCandidates(bestEval, &context, stage, linalgOps);
+    this->contextPool->materializeCandidates(optList);
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    AS_LOG(LogLevel::Info, "Time taken by candaidte generation: " << duration.count() << " microseconds");
+    changed = false;
+    bestEval->setChildrenNodes(optList);
+    treeNodes.insert(optList.begin(), optList.end());
+    for (auto node : optList)
+    {
+      nodesToVect.push_back(node);
+      auto start_node = std::chrono::high_resolution_clock::now();
+
+      std::string evel = evaluator.evaluateTransformation(node);
+      node->setEvaluation(evel);
+
+      if (std::stod(bestEval->getEvaluation()) > std::stod(evel))
+      {
+        AS_LOG(LogLevel::Info, "We changed the node");
+        Node *previousBest = bestEval;
+        bestEval = node;
+        stage = bestEval->getCurrentStage();
+        changed = true;
+        pruneCandidate(previousBest, bestEval, treeNodes);
+      }
+
+      // ## VECTORIZE ONE OP
+      llvm::timeTraceProfilerBegin("Vectorize candidate", [&]()
+                                   { return getTraceCandidateName(node); });
+      MLIRCodeIR *CodeIrVect = (MLIRCodeIR *)node->getTransformedCodeIr();
+      MLIRCodeIR *ClonedCodeVect = (MLIRCodeIR *)CodeIrVect->cloneIr();
+      Node *VectNode = SearchTreeArena::get().createNode(ClonedCodeVect, node->getCurrentStage());
+
+      std::vector<Transformation *> TransList = node->getTransformationList();
+      VectNode->setTransformationList(TransList);
+
+      // The vectorization is a recipe (the identifier of the operation) like
+      // the other transformations, a stored schedule replays it
+      Vectorization *vectorization =
+          SearchTreeArena::get().createTransformation<Vectorization>(OpToVectId,
+                                                                     OpToVectStage,
+                                                                     &context);
+
+      VectNode->setTransformation(vectorization);
+
+      VectNode->addTransformation(vectorization);
+      AS_LOG(LogLevel::Debug, "FINISHED CREATING NODE");
+      vectorization->applyTransformation(*ClonedCodeVect);
+      llvm::timeTraceProfilerEnd();
+
+      evel = evaluator.evaluateTransformation(VectNode);
+      VectNode->setEvaluation(evel);
+      if (std::stod(bestEval->getEvaluation()) > std::stod(evel))
+      {
+        AS_LOG(LogLevel::Info, "We changed the node");
+        Node *previousBest = bestEval;
+        bestEval = VectNode;
+        stage = bestEval->getCurrentStage();
+        changed = true;
+        pruneCandidate(previousBest, bestEval, treeNodes);
+      }
+      else
+        pruneCandidate(VectNode, bestEval, treeNodes);
+      // The parallelization candidate is kept for the tiling phase, its code is
+      // parked until then
+      if (node != bestEval)
+        ((MLIRCodeIR *)node->getTransformedCodeIr())->park();
+
+      auto end_node = std::chrono::high_resolution_clock::now();
+      duration = std::chrono::duration_cast<std::chrono::microseconds>(end_node - start_node);
+      AS_LOG(LogLevel::Info, "Time taken by one node: " << duration.count() << " microseconds");
+      AS_LOG(LogLevel::Debug, "END PARA");
+    }
+  }
+  // The best schedule of the parallelization phase is not used anymore, each
+  // parallelization candidate is the root of the next phases
+  pruneCandidate(bestEval, nullptr, treeNodes);
+
+  for (Node *node : nodesToVect)
+  {
+    stage = 0;
+    bestEval = node;
+    mlir::Operation *BestTarget = ((mlir::Operation *)(*((MLIRCodeIR *)bestEval->getTransformedCodeIr()))
+                                       .getIr());
+    // A parallelization candidate whose code cannot be materialized is failed
+    if (BestTarget == nullptr)
+    {
+      AS_LOG(LogLevel::Warning, "Could not materialize a parallelization candidate, it is skipped");
+      bestEval->setEvaluation("9000000000000000000");
+      continue;
+    }
+    linalgOps = getStageOps(BestTarget, stageOpIds);
+    AS_LOG(LogLevel::Debug, "Numbes of opeartions Tiling  = " << linalgOps.size());
+
+    while (stage < (int)linalgOps.size())
+    {
+      AS_LOG(LogLevel::Debug, "STAGe = " << stage);
+
+      if (linalgOps[stage] && (linalgOps[stage]->getParentOp()->getName().getStringRef()).str() != "scf.forall" && (linalgOps[stage]->getParentOp()->getName().getStringRef()).str() != "scf.for")
+      {
+        SmallVector<Node *, 2> optList1 = Tiling::createTilingCandidates(bestEval, &context, stage, linalgOps);
+        selectBest(optList1, bestEval, evaluator, treeNodes);
+      }
+
+      stage++;
+      bestEval->setCurrentStage(stage);
+    }
+
+    // ## INTER-OP CONCURRENCY: runs the independent operations at the same time,
+    // each one with a part of the threads
+    SmallVector<Node *, 2> concurrencyList = InterOpConcurrency::createConcurrencyCandidates(bestEval, &context);
+    AS_LOG(LogLevel::Debug, "Number of concurrency candidates = " << concurrencyList.size());
+    selectBest(concurrencyList, bestEval, evaluator, treeNodes);
+
+    // ## BUFFERIZATION: searches the bufferization options of the best schedule
+    SmallVector<Node *, 2> bufferizationList = BufferizationStrategy::createBufferizationCandidates(bestEval, &context);
+    selectBest(bufferizationList, bestEval, evaluator, treeNodes);
+
+    // ## FAST-MATH: only when the outputs are verified against the baseline
+    if (config.fastMath)
+    {
+      SmallVector<Node *, 2> fastMathList = FastMath::createFastMathCandidates(bestEval, &context);
+      selectBest(fastMathList, bestEval, evaluator, treeNodes);
+    }
+
+    // The schedules of this parallelization candidate are logged, the best one
+    // and the code of the candidate are freed
+    pruneCandidate(bestEval, nullptr, treeNodes);
+    ((MLIRCodeIR *)node->getTransformedCodeIr())->release();
+  }
+
+  // The best node of the search is freed by now, the evaluator keeps its
+  // evaluation and its schedule
+  result.treeNodes.assign(treeNodes.begin(), treeNodes.end());
+  result.bestEvaluation = evaluator.getBestEvaluation();
+  result.bestSchedule = evaluator.getBestSchedule();
+  result.evaluations = evaluator.getNumEvaluations();
+  result.cachedEvaluations = evaluator.getCachedEvaluations();
+  result.skippedEvaluations = evaluator.getSkippedEvaluations();
+  result.verificationFailures = evaluator.getVerificationFailures();
+  result.targetReached = evaluator.isTargetReached();
+
+  // The best schedule is stored for the regression runs
+  if (config.recordSchedule && !result.bestEvaluation.empty())
+    result.recorded = TuningDatabase::get().record(config.name, std::stod(result.rootEvaluation),
+                                                   std::stod(result.bestEvaluation), result.bestSchedule);
+  return result;
+}
+
+void AutoScheduler::releaseSearch(MLIRCodeIR *code, TuningResult &result)
+{
+  // The parallelization candidates first, the lazy codes hold references to
+  // the code of the root
+  for (Node *node : result.treeNodes)
+    if (node != result.root)
+      SearchTreeArena::get().freeNode(node);
+  // The reference of the root node is the last one to the code, the code is
+  // deleted with it. Without search tree (the code was only transformed by
+  // applySchedule) the reference of the scheduler is dropped.
+  auto owned = llvm::find_if(this->codes, [&](const std::unique_ptr<MLIRCodeIR> &candidate)
+                             { return candidate.get() == code; });
+  bool wasOwned = owned != this->codes.end();
+  if (wasOwned)
+  {
+    owned->release();
+    this->codes.erase(owned);
+  }
+  if (result.root)
+    SearchTreeArena::get().freeNode(result.root);
+  else if (wasOwned)
+    code->dropReference();
+  result.root = nullptr;
+  result.treeNodes.clear();
+}
+
+mlir::OwningOpRef<mlir::Operation *> AutoScheduler::applySchedule(MLIRCodeIR *code,
+                                                                  const std::vector<Transformation *> &schedule)
+{
+  // The transformations get the code through the base class, the clone is
+  // materialized before the schedule is replayed
+  MLIRCodeIR *transformed = (MLIRCodeIR *)code->cloneIr();
+  if (!transformed->materialize())
+  {
+    AS_LOG(LogLevel::Error, "Could not apply the schedule: the code cannot be materialized");
+    transformed->dropReference();
+    return nullptr;
+  }
+  for (Transformation *transformation : schedule)
+    transformation->applyTransformation(*transformed);
+  mlir::OwningOpRef<mlir::Operation *> module = transformed->assembleModule();
+  transformed->dropReference();
+  return module;
+}
+
+bool AutoScheduler::lookupSchedule(const TuningConfig &config, TuningRecord &record)
+{
+  if (!config.tuningDbPath.empty() && config.tuningDbPath != TuningDatabase::get().getPath())
+    TuningDatabase::get().open(config.tuningDbPath);
+  return TuningDatabase::get().isEnabled() &&
+         TuningDatabase::get().lookup(config.name, record, this->context.get());
+}
+
+RegressionResult AutoScheduler::checkRegression(MLIRCodeIR *code, const TuningConfig &config)
+{
+  RegressionResult result;
+  // Each run must execute the code, a stored run of the evaluation cache
+  // would repeat the first measure
+  bool cacheEnabled = EvaluationCache::get().isEnabled();
+  EvaluationCache::get().setEnabled(false);
+  // The root node takes its own reference, the code stays owned by the
+  // scheduler
+  code->retain();
+  Node *root = SearchTreeArena::get().createNode(code, 0);
+  EvaluationByExecution evaluator(config.getLogsFileName());
+  result.rootEvaluation = evaluator.evaluateTransformation(root);
+  root->setEvaluation(result.rootEvaluation);
+  if (this->lookupSchedule(config, result.record))
+  {
+    result.found = true;
+    MLIRCodeIR *transformed = (MLIRCodeIR *)code->cloneIr();
+    if (transformed->materialize())
+      for (Transformation *transformation : result.record.schedule)
+        transformation->applyTransformation(*transformed);
+    Node *node = SearchTreeArena::get().createNode(transformed, 0);
+    node->setTransformationList(result.record.schedule);
+    if (!result.record.schedule.empty())
+      node->setTransformation(result.record.schedule.back());
+
+    // The fastest run is kept, the others are noise of the machine
+    for (int i = 0; i < config.regressRepeat; ++i)
+    {
+      std::string evaluation = evaluator.evaluateTransformation(node);
+      if (evaluation.empty() || evaluation == "9000000000000000000")
+        continue;
+      double runTime = std::stod(evaluation);
+      if (!result.time || runTime < *result.time)
+        result.time = runTime;
+    }
+    if (result.time && result.record.time > 0)
+      result.slowdown = (*result.time - result.record.time) / result.record.time * 100;
+    result.regression = !result.time || result.slowdown > config.regressThreshold;
+    // The replayed code is dropped with the node
+    SearchTreeArena::get().freeNode(node);
+  }
+  result.evaluations = evaluator.getNumEvaluations();
+  SearchTreeArena::get().freeNode(root);
+  EvaluationCache::get().setEnabled(cacheEnabled);
+  return result;
+}
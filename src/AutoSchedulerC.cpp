@@ -0,0 +1,229 @@
+//===--------------------- AutoSchedulerC.cpp AutoScheduler ---------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the C API of the MLAutoScheduler
+/// library, a wrapper of the AutoScheduler class
+///
+//===----------------------------------------------------------------------===//
+#include "AutoSchedulerC.h"
+#include "AutoScheduler.h"
+
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace mlir;
+
+struct AsScheduler{
+    AutoScheduler scheduler;
+    std::string lastError;
+};
+
+/// Returns a copy of the string allocated with malloc, freed by asFreeString.
+static char *copyString(llvm::StringRef string)
+{
+  char *copy = (char *)std::malloc(string.size() + 1);
+  std::memcpy(copy, string.data(), string.size());
+  copy[string.size()] = '\0';
+  return copy;
+}
+
+static char *printModule(mlir::Operation *module)
+{
+  std::string text;
+  llvm::raw_string_ostream output(text);
+  module->print(output);
+  return copyString(output.str());
+}
+
+static char *printSchedule(const std::vector<Transformation *> &schedule)
+{
+  std::string text;
+  llvm::raw_string_ostream output(text);
+  output << llvm::json::Value(TuningDatabase::serializeSchedule(schedule));
+  return copyString(output.str());
+}
+
+static TuningConfig toTuningConfig(const AsTuningConfig *config)
+{
+  TuningConfig tuningConfig;
+  tuningConfig.name = config->name ? config->name : "module";
+  tuningConfig.maxEvaluations = config->maxEvaluations;
+  tuningConfig.timeBudget = config->timeBudget;
+  tuningConfig.fastMath = config->fastMath != 0;
+  tuningConfig.roofline = config->roofline != 0;
+  tuningConfig.rooflineStopFraction = config->rooflineStopFraction;
+  if (config->tuningDbPath)
+    tuningConfig.tuningDbPath = config->tuningDbPath;
+  tuningConfig.recordSchedule = config->recordSchedule != 0;
+  tuningConfig.seed = config->seed;
+  return tuningConfig;
+}
+
+/// Parses the module, the diagnostics of the parser are the last error.
+static mlir::OwningOpRef<mlir::Operation *> parseModule(AsScheduler *scheduler, const char *module)
+{
+  std::string diagnostics;
+  mlir::OwningOpRef<mlir::Operation *> parsed = scheduler->scheduler.parseSource(module ? module : "", &diagnostics);
+  if (!parsed)
+    scheduler->lastError = "Could not parse the module: " + diagnostics;
+  return parsed;
+}
+
+static int tuneCode(AsScheduler *scheduler, MLIRCodeIR *code, const AsTuningConfig *config, AsTuningResult *result)
+{
+  TuningResult tuningResult = scheduler->scheduler.tune(code, toTuningConfig(config));
+  result->rootTime = std::strtod(tuningResult.rootEvaluation.c_str(), nullptr);
+  result->evaluations = tuningResult.evaluations;
+  result->cachedEvaluations = tuningResult.cachedEvaluations;
+  result->skippedEvaluations = tuningResult.skippedEvaluations;
+  result->verificationFailures = tuningResult.verificationFailures;
+  result->recorded = tuningResult.recorded;
+  if (tuningResult.bestEvaluation.empty())
+  {
+    scheduler->scheduler.releaseSearch(code, tuningResult);
+    SearchTreeArena::get().releaseTransformations();
+    scheduler->lastError = "Every candidate of the search failed";
+    return 1;
+  }
+  result->bestTime = std::stod(tuningResult.bestEvaluation);
+  result->schedule = printSchedule(tuningResult.bestSchedule);
+  mlir::OwningOpRef<mlir::Operation *> transformed =
+      scheduler->scheduler.applySchedule(code, tuningResult.bestSchedule);
+  if (transformed)
+    result->module = printModule(transformed.get());
+  // The result holds the schedule as JSON, the search tree and its
+  // transformations are freed as the daemon does after each request
+  scheduler->scheduler.releaseSearch(code, tuningResult);
+  SearchTreeArena::get().releaseTransformations();
+  scheduler->lastError.clear();
+  return 0;
+}
+
+extern "C" {
+
+AsScheduler *asSchedulerCreate(void)
+{
+  return new AsScheduler();
+}
+
+void asSchedulerDestroy(AsScheduler *scheduler)
+{
+  delete scheduler;
+}
+
+const char *asGetLastError(AsScheduler *scheduler)
+{
+  return scheduler->lastError.c_str();
+}
+
+void asTuningConfigInit(AsTuningConfig *config, const char *name)
+{
+  TuningConfig tuningConfig = TuningConfig::fromEnvironment(name ? name : "module");
+  config->name = name;
+  config->maxEvaluations = tuningConfig.maxEvaluations;
+  config->timeBudget = tuningConfig.timeBudget;
+  config->fastMath = tuningConfig.fastMath;
+  config->roofline = tuningConfig.roofline;
+  config->rooflineStopFraction = tuningConfig.rooflineStopFraction;
+  config->tuningDbPath = std::getenv("AS_TUNING_DB");
+  config->recordSchedule = tuningConfig.recordSchedule;
+  config->seed = tuningConfig.seed;
+}
+
+int asTune(AsScheduler *scheduler, const char *module, const AsTuningConfig *config, AsTuningResult *result)
+{
+  std::memset(result, 0, sizeof(AsTuningResult));
+  mlir::OwningOpRef<mlir::Operation *> parsed = parseModule(scheduler, module);
+  if (!parsed)
+    return 1;
+  return tuneCode(scheduler, scheduler->scheduler.loadModule(parsed.get()), config, result);
+}
+
+int asTuneFile(AsScheduler *scheduler, const char *filename, const AsTuningConfig *config,
+               AsTuningResult *result)
+{
+  std::memset(result, 0, sizeof(AsTuningResult));
+  MLIRCodeIR *code = nullptr;
+  mlir::OwningOpRef<mlir::Operation *> parsed = scheduler->scheduler.parseFile(filename, code);
+  if (!parsed)
+  {
+    scheduler->lastError = std::string("Could not parse the file ") + filename;
+    return 1;
+  }
+  return tuneCode(scheduler, code, config, result);
+}
+
+void asTuningResultDispose(AsTuningResult *result)
+{
+  asFreeString(result->schedule);
+  asFreeString(result->module);
+  result->schedule = nullptr;
+  result->module = nullptr;
+}
+
+int asApplySchedule(AsScheduler *scheduler, const char *module, const char *schedule,
+                    char **transformedModule)
+{
+  mlir::OwningOpRef<mlir::Operation *> parsed = parseModule(scheduler, module);
+  if (!parsed)
+    return 1;
+  llvm::Expected<llvm::json::Value> steps = llvm::json::parse(schedule ? schedule : "");
+  if (!steps || !steps->getAsArray())
+  {
+    scheduler->lastError = "The schedule is not a JSON array";
+    if (!steps)
+      scheduler->lastError += ": " + llvm::toString(steps.takeError());
+    return 1;
+  }
+  std::vector<Transformation *> transformations;
+  if (!TuningDatabase::deserializeSchedule(*steps->getAsArray(), scheduler->scheduler.getContext(), transformations))
+  {
+    SearchTreeArena::get().releaseTransformations();
+    scheduler->lastError = "Unknown transformation in the schedule";
+    return 1;
+  }
+  MLIRCodeIR *code = scheduler->scheduler.loadModule(parsed.get());
+  mlir::OwningOpRef<mlir::Operation *> transformed = scheduler->scheduler.applySchedule(code, transformations);
+  TuningResult empty;
+  scheduler->scheduler.releaseSearch(code, empty);
+  SearchTreeArena::get().releaseTransformations();
+  if (!transformed)
+  {
+    scheduler->lastError = "The schedule could not be applied to the module";
+    return 1;
+  }
+  *transformedModule = printModule(transformed.get());
+  scheduler->lastError.clear();
+  return 0;
+}
+
+int asLookupSchedule(AsScheduler *scheduler, const char *tuningDbPath, const char *name,
+                     char **schedule, double *time)
+{
+  TuningConfig config;
+  config.name = name ? name : "";
+  if (tuningDbPath)
+    config.tuningDbPath = tuningDbPath;
+  TuningRecord record;
+  if (!scheduler->scheduler.lookupSchedule(config, record))
+  {
+    scheduler->lastError = "No stored schedule for " + config.name;
+    return 1;
+  }
+  *schedule = printSchedule(record.schedule);
+  *time = record.time;
+  scheduler->lastError.clear();
+  return 0;
+}
+
+void asFreeString(char *string)
+{
+  std::free(string);
+}
+
+} // extern "C"
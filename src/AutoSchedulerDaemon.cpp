@@ -0,0 +1,361 @@
+//===----------------- AutoSchedulerDaemon.cpp AutoSchedulerDaemon --------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the AutoSchedulerDaemon class, which
+/// serves the tune and apply requests of a Unix socket with a warm context
+///
+//===----------------------------------------------------------------------===//
+#include "AutoSchedulerDaemon.h"
+#include "EvaluationCache.h"
+#include "Logger.h"
+#include "SearchTreeArena.h"
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace mlir;
+
+/// Largest message accepted, a module of the build farm is far smaller.
+static constexpr uint32_t kMaxMessageSize = 256u << 20;
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void handleStopSignal(int)
+{
+  stopRequested = 1;
+}
+
+static llvm::json::Object makeError(const std::string &error)
+{
+  return llvm::json::Object{{"status", "error"}, {"error", error}};
+}
+
+static std::string printModule(mlir::Operation *module)
+{
+  std::string text;
+  llvm::raw_string_ostream output(text);
+  module->print(output);
+  return output.str();
+}
+
+AutoSchedulerDaemon::AutoSchedulerDaemon(const std::string &socketPath) : socketPath(socketPath)
+{
+  if (std::getenv("AS_DAEMON_CACHE_SIZE") != nullptr)
+    this->resultCapacity = std::max(0, std::stoi(std::getenv("AS_DAEMON_CACHE_SIZE")));
+  // The lowered modules of a search are often lowered again by the next
+  // searches of the same kernels
+  EvaluationCache::get().setEnabled(std::getenv("AS_EVALUATION_CACHE") == nullptr ||
+                                    std::stoi(std::getenv("AS_EVALUATION_CACHE")) != 0);
+}
+
+AutoSchedulerDaemon::~AutoSchedulerDaemon()
+{
+  if (this->listenSocket >= 0)
+  {
+    close(this->listenSocket);
+    unlink(this->socketPath.c_str());
+  }
+}
+
+int AutoSchedulerDaemon::run()
+{
+  struct sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (this->socketPath.size() >= sizeof(address.sun_path))
+  {
+    std::cerr << "The socket path is too long: " << this->socketPath << std::endl;
+    return 1;
+  }
+  std::strncpy(address.sun_path, this->socketPath.c_str(), sizeof(address.sun_path) - 1);
+  this->listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(this->socketPath.c_str());
+  if (this->listenSocket < 0 || bind(this->listenSocket, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+      listen(this->listenSocket, 64) != 0)
+  {
+    perror("Failed to open the daemon socket");
+    return 1;
+  }
+
+  signal(SIGINT, handleStopSignal);
+  signal(SIGTERM, handleStopSignal);
+  // A client closing its connection early must not stop the daemon
+  signal(SIGPIPE, SIG_IGN);
+  std::cout << "AutoSchedulerML daemon listening on " << this->socketPath << std::endl;
+
+  while (!this->stopping && !stopRequested)
+  {
+    struct pollfd fd = {this->listenSocket, POLLIN, 0};
+    // The timeout bounds the latency of the stop signals
+    if (poll(&fd, 1, 200) <= 0 || !(fd.revents & POLLIN))
+      continue;
+    int client = accept(this->listenSocket, nullptr, nullptr);
+    if (client >= 0)
+      this->serveClient(client);
+  }
+  std::cout << "AutoSchedulerML daemon stopped after " << this->numRequests << " requests" << std::endl;
+  return 0;
+}
+
+bool AutoSchedulerDaemon::readMessage(int client, std::string &message)
+{
+  auto readAll = [&](char *buffer, size_t size)
+  {
+    size_t received = 0;
+    while (received < size)
+    {
+      ssize_t bytes = recv(client, buffer + received, size - received, 0);
+      if (bytes <= 0)
+        return false;
+      received += bytes;
+    }
+    return true;
+  };
+  unsigned char header[4];
+  if (!readAll((char *)header, sizeof(header)))
+    return false;
+  uint32_t size = ((uint32_t)header[0] << 24) | ((uint32_t)header[1] << 16) | ((uint32_t)header[2] << 8) | header[3];
+  if (size > kMaxMessageSize)
+    return false;
+  message.resize(size);
+  return readAll(&message[0], size);
+}
+
+bool AutoSchedulerDaemon::writeMessage(int client, const std::string &message)
+{
+  uint32_t size = message.size();
+  std::string framed = {(char)(size >> 24), (char)(size >> 16), (char)(size >> 8), (char)size};
+  framed += message;
+  size_t sent = 0;
+  while (sent < framed.size())
+  {
+    ssize_t bytes = send(client, framed.data() + sent, framed.size() - sent, MSG_NOSIGNAL);
+    if (bytes <= 0)
+      return false;
+    sent += bytes;
+  }
+  return true;
+}
+
+void AutoSchedulerDaemon::serveClient(int client)
+{
+  // A client may send several requests on its connection, an idle client is
+  // dropped after a minute to let the others in
+  struct timeval timeout = {60, 0};
+  setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  std::string message;
+  while (!this->stopping && readMessage(client, message))
+  {
+    auto start = std::chrono::steady_clock::now();
+    llvm::json::Object response = this->handleRequest(message);
+    // The response holds the schedules as JSON, the transformations of the
+    // request are freed so that the arena does not grow with the requests
+    SearchTreeArena::get().releaseTransformations();
+    response["elapsed_s"] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::string text;
+    llvm::raw_string_ostream output(text);
+    output << llvm::json::Value(std::move(response));
+    if (!writeMessage(client, output.str()))
+      break;
+  }
+  close(client);
+  Logger::get().flush();
+}
+
+llvm::json::Object AutoSchedulerDaemon::handleRequest(llvm::StringRef message)
+{
+  this->numRequests++;
+  llvm::Expected<llvm::json::Value> parsed = llvm::json::parse(message);
+  if (!parsed)
+    return makeError("Invalid JSON: " + llvm::toString(parsed.takeError()));
+  const llvm::json::Object *request = parsed->getAsObject();
+  if (!request)
+    return makeError("The request is not a JSON object");
+
+  std::string op = request->getString("op").value_or("").str();
+  AS_LOG(LogLevel::Info, "Daemon request " << this->numRequests << ": " << op);
+  if (op == "tune")
+    return this->handleTune(*request);
+  if (op == "apply")
+    return this->handleApply(*request);
+  if (op == "lookup")
+    return this->handleLookup(*request);
+  if (op == "stats")
+    return this->handleStats();
+  if (op == "ping")
+    return llvm::json::Object{{"status", "ok"}};
+  if (op == "shutdown")
+  {
+    this->stopping = true;
+    return llvm::json::Object{{"status", "ok"}};
+  }
+  return makeError("Unknown op: " + op);
+}
+
+bool AutoSchedulerDaemon::readModuleSource(const llvm::json::Object &request, std::string &source, std::string &error)
+{
+  if (std::optional<llvm::StringRef> module = request.getString("module"))
+  {
+    source = module->str();
+    return true;
+  }
+  std::optional<llvm::StringRef> file = request.getString("file");
+  if (!file)
+  {
+    error = "The request has no module";
+    return false;
+  }
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer = llvm::MemoryBuffer::getFile(*file);
+  if (!buffer)
+  {
+    error = "Could not open " + file->str() + ": " + buffer.getError().message();
+    return false;
+  }
+  source = (*buffer)->getBuffer().str();
+  return true;
+}
+
+llvm::json::Object AutoSchedulerDaemon::handleTune(const llvm::json::Object &request)
+{
+  std::string source;
+  std::string error;
+  if (!readModuleSource(request, source, error))
+    return makeError(error);
+
+  // The defaults of the options are the environment of the daemon
+  TuningConfig config = TuningConfig::fromEnvironment(request.getString("name").value_or("module").str());
+  config.maxEvaluations = (int)request.getInteger("max_evaluations").value_or(config.maxEvaluations);
+  config.timeBudget = request.getNumber("time_budget").value_or(config.timeBudget);
+  config.fastMath = request.getBoolean("fast_math").value_or(config.fastMath);
+  config.recordSchedule = request.getBoolean("record").value_or(config.recordSchedule);
+  config.seed = request.getInteger("seed").value_or(config.seed);
+
+  std::string key;
+  llvm::raw_string_ostream keyStream(key);
+  keyStream << config.name << '\0' << config.maxEvaluations << '\0' << config.timeBudget << '\0'
+            << config.fastMath << '\0' << config.seed << '\0' << source;
+  uint64_t hash = llvm::xxh3_64bits(llvm::arrayRefFromStringRef(keyStream.str()));
+  auto cached = this->results.find(hash);
+  if (cached != this->results.end())
+  {
+    this->resultHits++;
+    llvm::json::Object response = cached->second;
+    response["cached"] = true;
+    return response;
+  }
+
+  std::string diagnostics;
+  mlir::OwningOpRef<mlir::Operation *> module = this->scheduler.parseSource(source, &diagnostics);
+  if (!module)
+    return makeError("Could not parse the module: " + diagnostics);
+  MLIRCodeIR *code = this->scheduler.loadModule(module.get());
+  this->numSearches++;
+  TuningResult result = this->scheduler.tune(code, config);
+
+  llvm::json::Object response{{"status", "ok"},
+                              {"name", config.name},
+                              {"root_time", std::strtod(result.rootEvaluation.c_str(), nullptr)},
+                              {"evaluations", result.evaluations},
+                              {"cached_evaluations", result.cachedEvaluations},
+                              {"skipped_evaluations", result.skippedEvaluations},
+                              {"verification_failures", result.verificationFailures},
+                              {"recorded", result.recorded},
+                              {"cached", false}};
+  if (result.bestEvaluation.empty())
+  {
+    this->scheduler.releaseSearch(code, result);
+    return makeError("Every candidate of the search failed");
+  }
+  double rootTime = std::stod(result.rootEvaluation);
+  double bestTime = std::stod(result.bestEvaluation);
+  response["best_time"] = bestTime;
+  response["speedup"] = bestTime > 0 ? rootTime / bestTime : 0;
+  response["schedule"] = TuningDatabase::serializeSchedule(result.bestSchedule);
+  mlir::OwningOpRef<mlir::Operation *> transformed = this->scheduler.applySchedule(code, result.bestSchedule);
+  if (transformed)
+    response["module"] = printModule(transformed.get());
+  this->scheduler.releaseSearch(code, result);
+
+  if (this->resultCapacity > 0)
+  {
+    this->results[hash] = response;
+    this->resultOrder.push_back(hash);
+    while (this->resultOrder.size() > this->resultCapacity)
+    {
+      this->results.erase(this->resultOrder.front());
+      this->resultOrder.pop_front();
+    }
+  }
+  return response;
+}
+
+llvm::json::Object AutoSchedulerDaemon::handleApply(const llvm::json::Object &request)
+{
+  std::string source;
+  std::string error;
+  if (!readModuleSource(request, source, error))
+    return makeError(error);
+  const llvm::json::Array *steps = request.getArray("schedule");
+  if (!steps)
+    return makeError("The request has no schedule");
+  std::vector<Transformation *> schedule;
+  if (!TuningDatabase::deserializeSchedule(*steps, this->scheduler.getContext(), schedule))
+    return makeError("Unknown transformation in the schedule");
+
+  std::string diagnostics;
+  mlir::OwningOpRef<mlir::Operation *> module = this->scheduler.parseSource(source, &diagnostics);
+  if (!module)
+    return makeError("Could not parse the module: " + diagnostics);
+  MLIRCodeIR *code = this->scheduler.loadModule(module.get());
+  mlir::OwningOpRef<mlir::Operation *> transformed = this->scheduler.applySchedule(code, schedule);
+  TuningResult empty;
+  this->scheduler.releaseSearch(code, empty);
+  if (!transformed)
+    return makeError("The schedule could not be applied to the module");
+  return llvm::json::Object{{"status", "ok"}, {"module", printModule(transformed.get())}};
+}
+
+llvm::json::Object AutoSchedulerDaemon::handleLookup(const llvm::json::Object &request)
+{
+  TuningConfig config = TuningConfig::fromEnvironment(request.getString("name").value_or("").str());
+  TuningRecord record;
+  if (!this->scheduler.lookupSchedule(config, record))
+    return makeError("No stored schedule for " + config.name);
+  return llvm::json::Object{{"status", "ok"},
+                            {"name", config.name},
+                            {"root_time", record.rootTime},
+                            {"time", record.time},
+                            {"date", record.date},
+                            {"schedule", TuningDatabase::serializeSchedule(record.schedule)}};
+}
+
+llvm::json::Object AutoSchedulerDaemon::handleStats()
+{
+  return llvm::json::Object{{"status", "ok"},
+                            {"requests", this->numRequests},
+                            {"searches", this->numSearches},
+                            {"result_cache_hits", this->resultHits},
+                            {"result_cache_size", (int64_t)this->results.size()},
+                            {"evaluation_cache_hits", EvaluationCache::get().getHits()},
+                            {"evaluation_cache_misses", EvaluationCache::get().getMisses()},
+                            {"evaluation_cache_collisions", EvaluationCache::get().getCollisions()},
+                            {"evaluation_cache_size", EvaluationCache::get().getSize()},
+                            {"tuning_db", TuningDatabase::get().getPath()}};
+}
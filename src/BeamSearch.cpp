@@ -28,7 +28,7 @@ Node *BeamSearch::runSearchMethod(Node *root)
     // Clone the root's MLIR code for evaluation
     MLIRCodeIR *CodeIr = (MLIRCodeIR *)root->getTransformedCodeIr();
     MLIRCodeIR *ClonedCode = (MLIRCodeIR *)CodeIr->cloneIr();
-    Node *clone = new Node(ClonedCode, root->getCurrentStage());
+    Node *clone = SearchTreeArena::get().createNode(ClonedCode, root->getCurrentStage());
     Node *BestNode = clone;
 
     // Create an evaluator for transformation evaluations
@@ -36,11 +36,14 @@ Node *BeamSearch::runSearchMethod(Node *root)
 
     while (!exploration_queue.empty() && level != 3)
     {
-        std::cout << "################# Level = " << level << " ###############\n";
+        AS_LOG(LogLevel::Info, "################# Level = " << level << " ###############");
         // SmallVector<Node *,2> parent_nodes;
 
         // Create a list to store schedule nodes at the current level
         SmallVector<Node *, 2> level_schedules;
+        // The expanded nodes with their children, to detach the children that
+        // fall out of the beam
+        SmallVector<std::pair<Node *, SmallVector<Node *, 2>>, 2> expanded_nodes;
 
         // Iterate through nodes in the exploration queue at the current level
         while (!exploration_queue.empty())
@@ -95,6 +98,7 @@ Node *BeamSearch::runSearchMethod(Node *root)
 
             // Set the children nodes of the current node (for printing the tree)
             node->setChildrenNodes(candidates);
+            expanded_nodes.push_back({node, candidates});
             // Save the best node at level 0 (the root node of the resulting tree)
             if (level == 0)
                 BestNode = node;
@@ -114,10 +118,21 @@ Node *BeamSearch::runSearchMethod(Node *root)
         level_schedules.insert(level_schedules.begin(), parent_nodes.begin(), parent_nodes.end());*/
 
         // keep the top 'beam_size' children and delete the rest
-        /*for (int i = this->beamSize; i < level_schedules.size(); ++i)
-            delete level_schedules[i];*/
+        for (int i = this->beamSize; i < level_schedules.size(); ++i)
+            SearchTreeArena::get().freeNode(level_schedules[i]);
         level_schedules.resize(std::min(this->beamSize, (int)level_schedules.size()));
 
+        for (auto &expanded : expanded_nodes)
+        {
+            SmallVector<Node *, 2> kept;
+            for (Node *child : expanded.second)
+            {
+                if (llvm::is_contained(level_schedules, child))
+                    kept.push_back(child);
+            }
+            expanded.first->setChildrenNodes(kept);
+        }
+
         // Add the level's schedule nodes to the exploration queue for the next level
         for (Node *child : level_schedules)
         {
@@ -0,0 +1,150 @@
+//===------------ BufferizationTransformation.cpp BufferizationTransformation -----------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the BufferizationTransformation class, which
+/// contains the declartion of the bufferization strategy
+///
+//===----------------------------------------------------------------------===//
+#include "BufferizationTransformation.h"
+
+using namespace mlir;
+
+using AnalysisHeuristic = bufferization::OneShotBufferizationOptions::AnalysisHeuristic;
+
+BufferizationStrategy::BufferizationStrategy(mlir::MLIRContext *context)
+{
+  this->functionBoundaryLayout = bufferization::LayoutMapOption::IdentityLayoutMap;
+  this->heuristic = AnalysisHeuristic::BottomUp;
+  this->copyBeforeWrite = false;
+  this->emptyTensorElimination = true;
+  this->context = context;
+}
+
+BufferizationStrategy::BufferizationStrategy(bufferization::LayoutMapOption functionBoundaryLayout,
+                                             AnalysisHeuristic heuristic,
+                                             bool copyBeforeWrite,
+                                             bool emptyTensorElimination,
+                                             mlir::MLIRContext *context)
+{
+  this->functionBoundaryLayout = functionBoundaryLayout;
+  this->heuristic = heuristic;
+  this->copyBeforeWrite = copyBeforeWrite;
+  this->emptyTensorElimination = emptyTensorElimination;
+  this->context = context;
+}
+
+std::string BufferizationStrategy::getType()
+{
+  return "Bufferization";
+}
+
+std::string BufferizationStrategy::printTransformation()
+{
+  std::string result = "B( ";
+  switch (functionBoundaryLayout)
+  {
+  case bufferization::LayoutMapOption::IdentityLayoutMap:
+    result += "identity";
+    break;
+  case bufferization::LayoutMapOption::FullyDynamicLayoutMap:
+    result += "fully-dynamic";
+    break;
+  case bufferization::LayoutMapOption::InferLayoutMap:
+    result += "infer";
+    break;
+  }
+  result += heuristic == AnalysisHeuristic::TopDown ? ", top-down" : ", bottom-up";
+  if (copyBeforeWrite)
+    result += ", copy-before-write";
+  if (!emptyTensorElimination)
+    result += ", no-empty-tensor-elimination";
+  result += " )";
+
+  return result;
+}
+
+void BufferizationStrategy::applyTransformation(CodeIR CodeIr)
+{
+  llvm::TimeTraceScope traceScope("Apply transformation", [&]()
+                                { return this->printTransformation(); });
+}
+
+void BufferizationStrategy::configureOptions(bufferization::OneShotBufferizationOptions &options)
+{
+  options.bufferizeFunctionBoundaries = true;
+  options.setFunctionBoundaryTypeConversion(functionBoundaryLayout);
+  options.analysisHeuristic = heuristic;
+  options.copyBeforeWrite = copyBeforeWrite;
+}
+
+bool BufferizationStrategy::getEmptyTensorElimination()
+{
+  return emptyTensorElimination;
+}
+
+bufferization::LayoutMapOption BufferizationStrategy::getFunctionBoundaryLayout()
+{
+  return functionBoundaryLayout;
+}
+
+AnalysisHeuristic BufferizationStrategy::getHeuristic()
+{
+  return heuristic;
+}
+
+bool BufferizationStrategy::getCopyBeforeWrite()
+{
+  return copyBeforeWrite;
+}
+
+BufferizationStrategy *BufferizationStrategy::getBufferizationStrategy(Node *node)
+{
+  BufferizationStrategy *strategy = NULL;
+  for (Transformation *transformation : node->getTransformationList())
+  {
+    if (transformation->getType() == "Bufferization")
+      strategy = (BufferizationStrategy *)transformation;
+  }
+  return strategy;
+}
+
+SmallVector<Node *, 2> BufferizationStrategy::createBufferizationCandidates(Node *node,
+                                                                           mlir::MLIRContext *context)
+{
+  llvm::TimeTraceScope traceScope("Generate candidates", "Bufferization");
+  SmallVector<Node *, 2> ChildNodes;
+  MLIRCodeIR *CodeIr = (MLIRCodeIR *)node->getTransformedCodeIr();
+
+  // Each candidate changes one option of the default strategy, the options are
+  // searched one at a time like the stages of the other transformations.
+  std::vector<BufferizationStrategy *> strategies;
+  strategies.push_back(SearchTreeArena::get().createTransformation<BufferizationStrategy>(bufferization::LayoutMapOption::FullyDynamicLayoutMap,
+                                                 AnalysisHeuristic::BottomUp, false, true, context));
+  strategies.push_back(SearchTreeArena::get().createTransformation<BufferizationStrategy>(bufferization::LayoutMapOption::InferLayoutMap,
+                                                 AnalysisHeuristic::BottomUp, false, true, context));
+  strategies.push_back(SearchTreeArena::get().createTransformation<BufferizationStrategy>(bufferization::LayoutMapOption::IdentityLayoutMap,
+                                                 AnalysisHeuristic::TopDown, false, true, context));
+  strategies.push_back(SearchTreeArena::get().createTransformation<BufferizationStrategy>(bufferization::LayoutMapOption::IdentityLayoutMap,
+                                                 AnalysisHeuristic::BottomUp, true, true, context));
+  strategies.push_back(SearchTreeArena::get().createTransformation<BufferizationStrategy>(bufferization::LayoutMapOption::IdentityLayoutMap,
+                                                 AnalysisHeuristic::BottomUp, false, false, context));
+
+  for (BufferizationStrategy *strategy : strategies)
+  {
+    MLIRCodeIR *ClonedCode = (MLIRCodeIR *)CodeIr->cloneIr();
+    Node *ChildNode = SearchTreeArena::get().createNode(ClonedCode, node->getCurrentStage());
+
+    std::vector<Transformation *> TransList = node->getTransformationList();
+    ChildNode->setTransformationList(TransList);
+
+    strategy->applyTransformation(*ClonedCode);
+
+    ChildNode->setTransformation(strategy);
+    ChildNode->addTransformation(strategy);
+
+    ChildNodes.push_back(ChildNode);
+  }
+  return ChildNodes;
+}
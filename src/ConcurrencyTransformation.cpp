@@ -0,0 +1,197 @@
+//===------------ ConcurrencyTransformation.cpp ConcurrencyTransformation -----------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the ConcurrencyTransformation class, which
+/// contains the declartion of the inter-op concurrency transformation
+///
+//===----------------------------------------------------------------------===//
+#include "ConcurrencyTransformation.h"
+
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+
+#include <cmath>
+
+using namespace mlir;
+
+InterOpConcurrency::InterOpConcurrency(llvm::SmallVector<int, 4> stages,
+                                       llvm::SmallVector<int64_t, 4> numThreads,
+                                       int groupId,
+                                       mlir::MLIRContext *context)
+{
+  this->stages = stages;
+  this->numThreads = numThreads;
+  this->groupId = groupId;
+  this->context = context;
+}
+
+llvm::SmallVector<int, 4> InterOpConcurrency::getStages()
+{
+  return this->stages;
+}
+
+llvm::SmallVector<int64_t, 4> InterOpConcurrency::getNumThreads()
+{
+  return this->numThreads;
+}
+
+int InterOpConcurrency::getGroupId()
+{
+  return this->groupId;
+}
+
+std::string InterOpConcurrency::getType()
+{
+  return "InterOpConcurrency";
+}
+
+std::string InterOpConcurrency::printTransformation()
+{
+  std::string result = "C( ";
+  for (size_t i = 0; i < stages.size(); ++i)
+  {
+    result += std::to_string(stages[i]) + ":" + std::to_string(numThreads[i]);
+
+    if (i != stages.size() - 1)
+    {
+      result += ", ";
+    }
+  }
+  result += " )";
+
+  return result;
+}
+
+/// Tags the top level operation containing each stage, and the operations nested
+/// in it that survive the bufferization (the top level operation itself may be
+/// recreated by it). Pure operations are not tagged, they may be hoisted out of
+/// the top level operation by the cleanups.
+void InterOpConcurrency::applyTransformation(CodeIR CodeIr)
+{
+  llvm::TimeTraceScope traceScope("Apply transformation", [&]()
+                                { return this->printTransformation(); });
+  mlir::Operation *target = ((mlir::Operation *)CodeIr.getIr());
+  SmallVector<mlir::linalg::LinalgOp, 4> linalgOps = getLinalgOps(target);
+  Builder builder(target->getContext());
+
+  for (auto [stage, threads] : llvm::zip(this->stages, this->numThreads))
+  {
+    mlir::Operation *anchor = getTopLevelAncestor(linalgOps[stage]);
+    anchor->walk([&](mlir::Operation *op)
+                 {
+      if (op != anchor && op->getNumRegions() == 0 && isMemoryEffectFree(op))
+        return;
+      op->setAttr(kConcurrentGroupAttrName, builder.getI64IntegerAttr(this->groupId));
+      op->setAttr(kNumThreadsAttrName, builder.getI64IntegerAttr(threads)); });
+  }
+}
+
+int64_t getAvailableThreads()
+{
+  if (std::getenv("AS_NUM_THREADS") != nullptr)
+  {
+    int64_t numThreads = std::stoll(std::getenv("AS_NUM_THREADS"));
+    if (numThreads > 0)
+      return numThreads;
+  }
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/// Returns the thread allotments tried for a group: an equal split, a split
+/// proportional to the work of each stage, and for pairs an unbalanced split
+/// in both directions.
+static std::vector<llvm::SmallVector<int64_t, 4>> getThreadAllotments(llvm::ArrayRef<int64_t> work,
+                                                                    int64_t totalThreads)
+{
+  std::vector<llvm::SmallVector<int64_t, 4>> allotments;
+  int64_t groupSize = work.size();
+  auto addAllotment = [&](llvm::SmallVector<int64_t, 4> allotment)
+  {
+    for (int64_t &threads : allotment)
+    {
+      threads = std::max<int64_t>(1, threads);
+    }
+    if (std::find(allotments.begin(), allotments.end(), allotment) == allotments.end())
+      allotments.push_back(allotment);
+  };
+
+  addAllotment(llvm::SmallVector<int64_t, 4>(groupSize, totalThreads / groupSize));
+
+  double totalWork = 0;
+  for (int64_t w : work)
+  {
+    totalWork += w;
+  }
+  if (totalWork > 0)
+  {
+    llvm::SmallVector<int64_t, 4> proportional;
+    for (int64_t w : work)
+    {
+      proportional.push_back(std::llround(totalThreads * (w / totalWork)));
+    }
+    addAllotment(proportional);
+  }
+
+  if (groupSize == 2 && totalThreads >= 4)
+  {
+    addAllotment({totalThreads * 3 / 4, totalThreads / 4});
+    addAllotment({totalThreads / 4, totalThreads * 3 / 4});
+  }
+  return allotments;
+}
+
+SmallVector<Node *, 2> InterOpConcurrency::createConcurrencyCandidates(Node *node,
+                                                                      mlir::MLIRContext *context)
+{
+  llvm::TimeTraceScope traceScope("Generate candidates", "Concurrency");
+  SmallVector<Node *, 2> ChildNodes;
+  MLIRCodeIR *CodeIr = (MLIRCodeIR *)node->getTransformedCodeIr();
+  Operation *target = ((Operation *)(*CodeIr).getIr());
+
+  // The group ids already used by the schedule of the node.
+  int groupId = 0;
+  for (Transformation *transformation : node->getTransformationList())
+  {
+    if (transformation->getType() == "InterOpConcurrency")
+      groupId++;
+  }
+
+  OpDependenceGraph graph(target);
+  int64_t totalThreads = getAvailableThreads();
+
+  for (const std::vector<int> &group : graph.getIndependentGroups())
+  {
+    llvm::SmallVector<int, 4> stages;
+    llvm::SmallVector<int64_t, 4> work;
+    for (int stage : group)
+    {
+      // Skips the stages that already run concurrently.
+      if (graph.getAnchor(stage)->hasAttr(kConcurrentGroupAttrName))
+        continue;
+      stages.push_back(stage);
+      work.push_back(graph.estimateWork(stage));
+    }
+    if (stages.size() < 2 || (int64_t)stages.size() > totalThreads)
+      continue;
+
+    for (const auto &allotment : getThreadAllotments(work, totalThreads))
+    {
+      MLIRCodeIR *ClonedCode = (MLIRCodeIR *)CodeIr->cloneIr();
+      Node *ChildNode = SearchTreeArena::get().createNode(ClonedCode, node->getCurrentStage());
+
+      std::vector<Transformation *> TransList = node->getTransformationList();
+      ChildNode->setTransformationList(TransList);
+
+      InterOpConcurrency *concurrency =
+          SearchTreeArena::get().createTransformation<InterOpConcurrency>(stages, allotment, groupId, context);
+      concurrency->applyTransformation(*ClonedCode);
+
+      ChildNode->setTransformation(concurrency);
+      ChildNode->addTransformation(concurrency);
+
+      ChildNodes.push_back(ChildNode);
+    }
+  }
+  return ChildNodes;
+}
@@ -0,0 +1,151 @@
+//===------------------------ ContextPool.cpp ContextPool -----------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the ContextPool class, which applies
+/// the transformations of the lazy candidates on worker threads
+///
+//===----------------------------------------------------------------------===//
+#include "ContextPool.h"
+#include "OpIdentity.h"
+
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/AsmState.h"
+#include "mlir/IR/Block.h"
+#include "llvm/ADT/DenseMap.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace mlir;
+
+/// Writes the code to bytecode, returns false on failure.
+static bool writeBytecode(Operation *op, std::string &bytecode)
+{
+  llvm::raw_string_ostream os(bytecode);
+  if (failed(writeBytecodeToFile(op, os)))
+    return false;
+  os.flush();
+  return true;
+}
+
+ContextPool::ContextPool(const DialectRegistry &registry, MLIRContext *context)
+{
+  this->context = context;
+  int numWorkers = getWorkerThreads();
+  if (numWorkers <= 1)
+    return;
+  for (int i = 0; i < numWorkers; ++i)
+  {
+    // The workers already run in parallel, the contexts do not have their own
+    // thread pool
+    auto workerContext = std::make_unique<MLIRContext>(registry, MLIRContext::Threading::DISABLED);
+    workerContext->loadAllAvailableDialects();
+    workerContexts.push_back(std::move(workerContext));
+  }
+}
+
+int ContextPool::getNumWorkers()
+{
+  return this->workerContexts.size();
+}
+
+int ContextPool::getWorkerThreads()
+{
+  if (std::getenv("AS_WORKER_THREADS") != nullptr)
+    return std::stoi(std::getenv("AS_WORKER_THREADS"));
+  return 1;
+}
+
+bool ContextPool::isContextIndependent(Transformation *transformation)
+{
+  // The tiling options hold attributes of the context of the search
+  std::string type = transformation->getType();
+  return type == "Parallelization" || type == "Interchange";
+}
+
+void ContextPool::materializeCandidates(llvm::ArrayRef<Node *> candidates)
+{
+  if (this->workerContexts.empty())
+    return;
+  llvm::TimeTraceScope traceScope("Materialize candidates");
+
+  struct Task
+  {
+    MLIRCodeIR *code;
+    const std::string *parentBytecode;
+    std::string bytecode;
+    bool succeeded = false;
+  };
+
+  // Each parent is sent once to the workers
+  llvm::DenseMap<MLIRCodeIR *, std::unique_ptr<std::string>> parentBytecodes;
+  std::vector<Task> tasks;
+  for (Node *node : candidates)
+  {
+    MLIRCodeIR *code = (MLIRCodeIR *)node->getTransformedCodeIr();
+    if (!code->hasRecipe() || code->isMaterialized() || code->isParked() ||
+        !isContextIndependent(code->getRecipe()))
+      continue;
+
+    MLIRCodeIR *parent = code->getParent();
+    auto it = parentBytecodes.find(parent);
+    if (it == parentBytecodes.end())
+    {
+      bool wasMaterialized = parent->isMaterialized();
+      bool wasParked = parent->isParked();
+      auto bytecode = std::make_unique<std::string>();
+      Operation *parentOp = (Operation *)parent->getIr();
+      bool written = parentOp != nullptr && writeBytecode(parentOp, *bytecode);
+      if (wasParked)
+        parent->park();
+      else if (!wasMaterialized)
+        parent->release();
+      if (!written)
+        continue;
+      it = parentBytecodes.insert({parent, std::move(bytecode)}).first;
+    }
+    tasks.push_back({code, it->second.get()});
+  }
+
+  std::atomic<size_t> nextTask(0);
+  std::vector<std::thread> workers;
+  for (size_t w = 0; w < this->workerContexts.size(); ++w)
+  {
+    MLIRContext *ctx = this->workerContexts[w].get();
+    workers.emplace_back([&tasks, &nextTask, ctx, w]()
+                         {
+      initThreadTracing("worker " + std::to_string(w));
+      for (size_t i = nextTask++; i < tasks.size(); i = nextTask++)
+      {
+        Task &task = tasks[i];
+        llvm::TimeTraceScope taskScope("Materialize candidate", [&]()
+                                       { return task.code->getRecipe()->printTransformation(); });
+        Block block;
+        llvm::MemoryBufferRef buffer(*task.parentBytecode, "parent");
+        if (failed(readBytecodeFile(buffer, &block, ParserConfig(ctx))))
+          continue;
+        Operation *op = &block.front();
+        op->remove();
+
+        // The recipe is replayed on the copy of the parent owned by the worker
+        MLIRCodeIR code;
+        code.setIr(op);
+        task.code->getRecipe()->applyTransformation(code);
+        task.succeeded = writeBytecode(op, task.bytecode);
+        invalidateOpIdentityIndex(op);
+        op->erase();
+      }
+      finishThreadTracing(); });
+  }
+  for (std::thread &worker : workers)
+    worker.join();
+
+  for (Task &task : tasks)
+  {
+    if (task.succeeded)
+      task.code->parkBytecode(task.bytecode, this->context);
+  }
+}
@@ -0,0 +1,211 @@
+//===------------ BufferArenaPlanning.cpp BufferArenaPlanning -------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implementation of the memory planning pass, which
+/// computes the lifetimes of the intermediate buffers of a function and packs
+/// them in a single arena, the buffers that are never alive at the same time
+/// share the same offsets
+///
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Interfaces/ViewLikeInterface.h"
+
+#include "Passes.h"
+using namespace mlir;
+namespace
+{
+
+  /// An intermediate buffer and its lifetime, expressed as the positions of the
+  /// first and last operations of the function body using it.
+  struct BufferInterval
+  {
+    memref::AllocOp allocOp;
+    memref::DeallocOp deallocOp;
+    int64_t size;
+    int64_t start;
+    int64_t end;
+    int64_t offset = 0;
+  };
+
+  /// Returns the size in bytes of the buffer, or 0 if the buffer can not be
+  /// placed in the arena (dynamic shape, layout, memory space...).
+  int64_t getBufferSize(memref::AllocOp allocOp)
+  {
+    MemRefType type = allocOp.getType();
+    if (!type.hasStaticShape() || !type.getLayout().isIdentity() ||
+        type.getMemorySpace() || !allocOp.getSymbolOperands().empty())
+      return 0;
+    Type elementType = type.getElementType();
+    if (!elementType.isIntOrFloat() || elementType.getIntOrFloatBitWidth() % 8 != 0)
+      return 0;
+    return type.getNumElements() * (elementType.getIntOrFloatBitWidth() / 8);
+  }
+
+  /// Computes the lifetime of the buffer allocated by allocOp in the function
+  /// body, following the views and casts of the buffer. Fails if the buffer
+  /// escapes (returned, yielded...) or is not deallocated in the body.
+  FailureOr<BufferInterval> getBufferInterval(memref::AllocOp allocOp,
+                                              llvm::DenseMap<Operation *, int64_t> &positions)
+  {
+    Block *body = allocOp->getBlock();
+    BufferInterval interval;
+    interval.allocOp = allocOp;
+    interval.size = getBufferSize(allocOp);
+    interval.start = positions[allocOp];
+    interval.end = interval.start;
+    if (interval.size == 0)
+      return failure();
+
+    SmallVector<Value> worklist = {allocOp.getResult()};
+    while (!worklist.empty())
+    {
+      Value value = worklist.pop_back_val();
+      for (OpOperand &use : value.getUses())
+      {
+        Operation *user = use.getOwner();
+        if (auto deallocOp = dyn_cast<memref::DeallocOp>(user))
+        {
+          if (value != allocOp.getResult() || deallocOp->getBlock() != body ||
+              interval.deallocOp)
+            return failure();
+          interval.deallocOp = deallocOp;
+          continue;
+        }
+        if (user->hasTrait<OpTrait::IsTerminator>() || isa<CallOpInterface>(user))
+          return failure();
+        if (auto viewLikeOp = dyn_cast<ViewLikeOpInterface>(user))
+        {
+          if (viewLikeOp.getViewSource() == value)
+            worklist.append(user->result_begin(), user->result_end());
+        }
+        // The buffer itself is stored somewhere, its lifetime is unknown.
+        if (auto storeOp = dyn_cast<memref::StoreOp>(user))
+        {
+          if (storeOp.getValueToStore() == value)
+            return failure();
+        }
+        Operation *ancestor = body->findAncestorOpInBlock(*user);
+        if (!ancestor)
+          return failure();
+        interval.end = std::max(interval.end, positions[ancestor]);
+      }
+    }
+    if (!interval.deallocOp)
+      return failure();
+    return interval;
+  }
+
+  /// Assigns the offsets of the buffers, the biggest buffers first, each one at
+  /// the lowest aligned offset that does not overlap with the buffers already
+  /// placed and alive at the same time. Returns the size of the arena.
+  int64_t assignOffsets(SmallVector<BufferInterval> &intervals, int64_t alignment)
+  {
+    llvm::stable_sort(intervals, [](const BufferInterval &a, const BufferInterval &b)
+                      { return a.size > b.size; });
+    int64_t arenaSize = 0;
+    for (size_t i = 0; i < intervals.size(); ++i)
+    {
+      // The placed buffers alive during the lifetime of the current one, sorted
+      // by offset.
+      SmallVector<BufferInterval *> alive;
+      for (size_t j = 0; j < i; ++j)
+      {
+        if (intervals[j].start <= intervals[i].end && intervals[i].start <= intervals[j].end)
+          alive.push_back(&intervals[j]);
+      }
+      llvm::sort(alive, [](BufferInterval *a, BufferInterval *b)
+                 { return a->offset < b->offset; });
+
+      int64_t offset = 0;
+      for (BufferInterval *placed : alive)
+      {
+        if (offset + intervals[i].size <= placed->offset)
+          break;
+        offset = std::max<int64_t>(offset, llvm::alignTo(placed->offset + placed->size, alignment));
+      }
+      intervals[i].offset = offset;
+      arenaSize = std::max(arenaSize, offset + intervals[i].size);
+    }
+    return arenaSize;
+  }
+
+} // namespace
+
+namespace mlir
+{
+
+#define GEN_PASS_DEF_BUFFERARENAPLANNING
+#include "CustomPasses/Passes.h.inc"
+
+  class BufferArenaPlanning final
+      : public impl::BufferArenaPlanningBase<BufferArenaPlanning>
+  {
+  public:
+    using BufferArenaPlanningBase::BufferArenaPlanningBase;
+
+    void runOnOperation() override
+    {
+      func::FuncOp funcOp = getOperation();
+      if (funcOp.getBody().empty() || alignment <= 0)
+        return;
+      Block &body = funcOp.getBody().front();
+
+      llvm::DenseMap<Operation *, int64_t> positions;
+      int64_t position = 0;
+      for (Operation &op : body)
+      {
+        positions[&op] = position++;
+      }
+
+      SmallVector<BufferInterval> intervals;
+      int64_t totalSize = 0;
+      for (auto allocOp : body.getOps<memref::AllocOp>())
+      {
+        FailureOr<BufferInterval> interval = getBufferInterval(allocOp, positions);
+        if (failed(interval))
+          continue;
+        totalSize += interval->size;
+        intervals.push_back(*interval);
+      }
+      if (intervals.size() < 2)
+        return;
+
+      int64_t arenaSize = assignOffsets(intervals, alignment);
+      if (arenaSize >= totalSize)
+        return;
+
+      OpBuilder builder(&body, body.begin());
+      Location loc = funcOp.getLoc();
+      auto arenaType = MemRefType::get({arenaSize}, builder.getI8Type());
+      Value arena = builder.create<memref::AllocOp>(
+          loc, arenaType, builder.getI64IntegerAttr(alignment));
+
+      for (BufferInterval &interval : intervals)
+      {
+        builder.setInsertionPoint(interval.allocOp);
+        Value offset = builder.create<arith::ConstantIndexOp>(interval.allocOp.getLoc(),
+                                                              interval.offset);
+        Value view = builder.create<memref::ViewOp>(
+            interval.allocOp.getLoc(), interval.allocOp.getType(), arena, offset,
+            ValueRange());
+        interval.allocOp.getResult().replaceAllUsesExcept(view, interval.deallocOp);
+        interval.deallocOp->erase();
+        interval.allocOp->erase();
+      }
+
+      builder.setInsertionPoint(body.getTerminator());
+      builder.create<memref::DeallocOp>(loc, arena);
+    }
+  };
+
+  std::unique_ptr<Pass> createBufferArenaPlanning()
+  {
+    return std::make_unique<BufferArenaPlanning>();
+  }
+
+} // namespace mlir
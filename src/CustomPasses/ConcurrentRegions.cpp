@@ -0,0 +1,232 @@
+//===------------ ConcurrentRegions.cpp ConcurrentRegions -----------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implementation of the passes that run the
+/// independent operations tagged by the InterOpConcurrency transformation
+/// concurrently, each one in its own OpenMP section with its own number of
+/// threads
+///
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/Dialect/OpenMP/OpenMPDialect.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Interfaces/ViewLikeInterface.h"
+#include "llvm/ADT/MapVector.h"
+
+#include "Passes.h"
+using namespace mlir;
+namespace
+{
+
+  /// Returns the buffer a memref value is a view of.
+  Value getRootBuffer(Value value)
+  {
+    while (Operation *definingOp = value.getDefiningOp())
+    {
+      auto viewLikeOp = dyn_cast<ViewLikeOpInterface>(definingOp);
+      if (!viewLikeOp)
+        break;
+      value = viewLikeOp.getViewSource();
+    }
+    return value;
+  }
+
+  /// Collects the buffers read and written by op and its nested operations.
+  /// Returns failure if the effects of an operation are unknown (calls...).
+  LogicalResult collectAccessedBuffers(Operation *op, llvm::DenseSet<Value> &reads,
+                                       llvm::DenseSet<Value> &writes)
+  {
+    std::optional<SmallVector<MemoryEffects::EffectInstance>> effects =
+        getEffectsRecursively(op);
+    if (!effects)
+      return failure();
+    for (MemoryEffects::EffectInstance &effect : *effects)
+    {
+      if (isa<MemoryEffects::Allocate>(effect.getEffect()))
+        continue;
+      Value value = effect.getValue();
+      if (!value)
+        return failure();
+      if (isa<MemoryEffects::Read>(effect.getEffect()))
+        reads.insert(getRootBuffer(value));
+      else
+        writes.insert(getRootBuffer(value));
+    }
+    return success();
+  }
+
+  /// Returns true if the two operations may access the same buffer, one of
+  /// them writing it.
+  bool haveMemoryConflict(Operation *opA, Operation *opB)
+  {
+    llvm::DenseSet<Value> readsA, writesA, readsB, writesB;
+    if (failed(collectAccessedBuffers(opA, readsA, writesA)) ||
+        failed(collectAccessedBuffers(opB, readsB, writesB)))
+      return true;
+    for (Value buffer : writesA)
+    {
+      if (readsB.contains(buffer) || writesB.contains(buffer))
+        return true;
+    }
+    for (Value buffer : writesB)
+    {
+      if (readsA.contains(buffer))
+        return true;
+    }
+    return false;
+  }
+
+  /// Returns true if the anchors (sorted in program order) can all be moved
+  /// right before the last one and run concurrently.
+  bool canRunConcurrently(ArrayRef<Operation *> anchors)
+  {
+    Operation *last = anchors.back();
+    for (Operation *anchor : anchors)
+    {
+      // After bufferization the anchors should not have used results.
+      for (Value result : anchor->getResults())
+      {
+        if (!result.use_empty())
+          return false;
+      }
+      if (anchor == last)
+        continue;
+      for (Operation *op = anchor->getNextNode(); op; op = op->getNextNode())
+      {
+        if (haveMemoryConflict(anchor, op))
+          return false;
+        if (op == last)
+          break;
+      }
+    }
+    return true;
+  }
+
+  /// Wraps the anchors in an omp.parallel { omp.sections { omp.section ... } }
+  /// created right before the last anchor.
+  void createSections(ArrayRef<Operation *> anchors, ArrayRef<int64_t> numThreads)
+  {
+    Operation *last = anchors.back();
+    Location loc = last->getLoc();
+    OpBuilder builder(last);
+
+    auto parallelOp = builder.create<omp::ParallelOp>(loc);
+    builder.createBlock(&parallelOp.getRegion());
+    auto sectionsOp = builder.create<omp::SectionsOp>(
+        loc, /*reduction_vars=*/ValueRange(), /*reductions=*/nullptr,
+        /*allocate_vars=*/ValueRange(), /*allocators_vars=*/ValueRange(),
+        /*nowait=*/nullptr);
+    builder.create<omp::TerminatorOp>(loc);
+
+    builder.createBlock(&sectionsOp.getRegion());
+    for (auto [anchor, threads] : llvm::zip(anchors, numThreads))
+    {
+      auto sectionOp = builder.create<omp::SectionOp>(anchor->getLoc());
+      if (threads > 0)
+        sectionOp->setAttr(kNumThreadsAttrName, builder.getI64IntegerAttr(threads));
+      OpBuilder::InsertionGuard guard(builder);
+      Block *sectionBlock = builder.createBlock(&sectionOp.getRegion());
+      anchor->moveBefore(sectionBlock, sectionBlock->end());
+      builder.setInsertionPointToEnd(sectionBlock);
+      builder.create<omp::TerminatorOp>(anchor->getLoc());
+    }
+    builder.create<omp::TerminatorOp>(loc);
+  }
+
+} // namespace
+
+namespace mlir
+{
+
+#define GEN_PASS_DEF_CONCURRENTREGIONSLOWERING
+#define GEN_PASS_DEF_CONCURRENTTHREADALLOTMENT
+#include "CustomPasses/Passes.h.inc"
+
+  class ConcurrentRegionsLowering final
+      : public impl::ConcurrentRegionsLoweringBase<ConcurrentRegionsLowering>
+  {
+  public:
+    void runOnOperation() override
+    {
+      func::FuncOp funcOp = getOperation();
+      if (funcOp.getBody().empty())
+        return;
+      Block &body = funcOp.getBody().front();
+
+      // Groups the top level operations containing the tagged operations.
+      llvm::MapVector<int64_t, llvm::SetVector<Operation *>> groups;
+      llvm::DenseMap<Operation *, int64_t> anchorThreads;
+      funcOp.walk([&](Operation *op)
+                  {
+        auto groupAttr = op->getAttrOfType<IntegerAttr>(kConcurrentGroupAttrName);
+        if (!groupAttr)
+          return;
+        Operation *anchor = body.findAncestorOpInBlock(*op);
+        if (anchor && !isMemoryEffectFree(anchor))
+        {
+          groups[groupAttr.getInt()].insert(anchor);
+          if (auto threadsAttr = op->getAttrOfType<IntegerAttr>(kNumThreadsAttrName))
+            anchorThreads[anchor] = threadsAttr.getInt();
+        }
+        op->removeAttr(kConcurrentGroupAttrName);
+        op->removeAttr(kNumThreadsAttrName); });
+
+      for (auto &group : groups)
+      {
+        SmallVector<Operation *> anchors(group.second.begin(), group.second.end());
+        if (anchors.size() < 2)
+          continue;
+        llvm::sort(anchors, [](Operation *a, Operation *b)
+                   { return a->isBeforeInBlock(b); });
+        if (!canRunConcurrently(anchors))
+          continue;
+
+        SmallVector<int64_t> numThreads;
+        for (Operation *anchor : anchors)
+        {
+          numThreads.push_back(anchorThreads.lookup(anchor));
+        }
+        createSections(anchors, numThreads);
+      }
+    }
+  };
+
+  class ConcurrentThreadAllotment final
+      : public impl::ConcurrentThreadAllotmentBase<ConcurrentThreadAllotment>
+  {
+  public:
+    void runOnOperation() override
+    {
+      getOperation().walk([&](omp::SectionOp sectionOp)
+                          {
+        auto threadsAttr = sectionOp->getAttrOfType<IntegerAttr>(kNumThreadsAttrName);
+        if (!threadsAttr)
+          return;
+        sectionOp->removeAttr(kNumThreadsAttrName);
+        sectionOp.walk([&](omp::ParallelOp parallelOp)
+                       {
+          if (parallelOp.getNumThreadsVar())
+            return;
+          OpBuilder builder(parallelOp);
+          Value numThreads = builder.create<LLVM::ConstantOp>(
+              parallelOp.getLoc(), builder.getI32Type(),
+              builder.getI32IntegerAttr(threadsAttr.getInt()));
+          parallelOp.getNumThreadsVarMutable().assign(numThreads); }); });
+    }
+  };
+
+  std::unique_ptr<Pass> createConcurrentRegionsLowering()
+  {
+    return std::make_unique<ConcurrentRegionsLowering>();
+  }
+
+  std::unique_ptr<Pass> createConcurrentThreadAllotment()
+  {
+    return std::make_unique<ConcurrentThreadAllotment>();
+  }
+
+} // namespace mlir
@@ -0,0 +1,55 @@
+//===------------ FastMathFlagsLowering.cpp FastMathFlagsLowering ---------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implementation of the pass setting the LLVM fast-math
+/// flags of the kernel functions selected by the FastMath transformation. The
+/// arith flags of the transformation are lost by the vector lowerings, the flags
+/// are set again on the LLVM operations of the function
+///
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Conversion/ArithCommon/AttrToLLVMConverter.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/IR/BuiltinOps.h"
+
+#include "Passes.h"
+using namespace mlir;
+
+namespace mlir
+{
+
+#define GEN_PASS_DEF_FASTMATHFLAGSLOWERING
+#include "CustomPasses/Passes.h.inc"
+
+  class FastMathFlagsLowering final
+      : public impl::FastMathFlagsLoweringBase<FastMathFlagsLowering>
+  {
+  public:
+    void runOnOperation() override
+    {
+      MLIRContext *ctx = &getContext();
+      getOperation().walk([&](LLVM::LLVMFuncOp funcOp)
+                          {
+        auto flagsAttr = funcOp->getAttrOfType<arith::FastMathFlagsAttr>(kFastMathAttrName);
+        if (!flagsAttr)
+          return;
+        funcOp->removeAttr(kFastMathAttrName);
+        LLVM::FastmathFlags flags = convertArithFastMathFlagsToLLVM(flagsAttr.getValue());
+
+        funcOp.walk([&](LLVM::FastmathFlagsInterface fmfOp)
+                    {
+          LLVM::FastmathFlags opFlags = fmfOp.getFastmathFlags() | flags;
+          fmfOp->setAttr(fmfOp.getFastmathAttrName(),
+                         LLVM::FastmathFlagsAttr::get(ctx, opFlags)); }); });
+    }
+  };
+
+  std::unique_ptr<Pass> createFastMathFlagsLowering()
+  {
+    return std::make_unique<FastMathFlagsLowering>();
+  }
+
+} // namespace mlir
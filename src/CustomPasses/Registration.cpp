@@ -0,0 +1,33 @@
+//===--------------------- Registration.cpp Registration ------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implementation of the registration of the custom
+/// passes in the pass registry
+///
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Pass/PassRegistry.h"
+
+#include "Passes.h"
+using namespace mlir;
+
+namespace mlir
+{
+
+  void registerCustomPasses()
+  {
+    registerPass([]()
+                 { return createForEachThreadLowering(); });
+    registerPass([]()
+                 { return createConcurrentRegionsLowering(); });
+    registerPass([]()
+                 { return createConcurrentThreadAllotment(); });
+    registerPass([]()
+                 { return createBufferArenaPlanning(); });
+    registerPass([]()
+                 { return createFastMathFlagsLowering(); });
+  }
+
+} // namespace mlir
@@ -12,114 +12,118 @@
 #include "EvaluationByExecution.h"
 
 using namespace mlir;
-std::string getTransformedCode(std::string inputCode, std::string transfromDialectString);
-std::string getEvaluation(std::string inputCode);
+std::string getEvaluation(std::string inputCode, std::string *rawOutput = nullptr);
 std::string removeExtraModuleTagCreated(std::string input);
 pid_t popen2(const char *command, int *infp, int *outfp);
-pid_t popen22(const char *command, int *infp, int *outfp);
+
+/// Returns true if the environment variable is set to 1.
+static bool isEnvFlagSet(const char *name)
+{
+    return std::getenv(name) != nullptr && std::stoi(std::getenv(name)) == 1;
+}
+
+bool isCpuRunnerAvailable()
+{
+    return (std::getenv("AS_CPU_RUNNER") != nullptr || std::getenv("LLVM_PATH") != nullptr) &&
+           std::getenv("SHARED_LIBS") != nullptr;
+}
 
 EvaluationByExecution::EvaluationByExecution()
 {
+  this->readBudget();
 }
 EvaluationByExecution::EvaluationByExecution(std::string LogsFileName)
 {
   this->LogsFileName = LogsFileName;
+  this->readBudget();
 }
-std::string EvaluationByExecution::evaluateTransformation(Node *node)
+void EvaluationByExecution::readBudget()
 {
-    std::string str1;
-    llvm::raw_string_ostream output(str1);
-
-    MLIRCodeIR *CodeIr = (MLIRCodeIR *)node->getTransformedCodeIr();
-    MLIRCodeIR* ClonedCode =  (MLIRCodeIR*)CodeIr->cloneIr();
-    
-    //Operation *ClonedTarget = ((Operation *)(*node->getTransformedCodeIr()).getIr());
-    mlir::Operation *op = ((mlir::Operation *)(*(ClonedCode))
-                                     .getIr());
-    // Printing the transformed code
-    if (std::getenv("AS_VERBOSE") != nullptr)
+  this->startTime = std::chrono::steady_clock::now();
+  if (std::getenv("AS_MAX_EVALUATIONS") != nullptr)
+    this->maxEvaluations = std::stoi(std::getenv("AS_MAX_EVALUATIONS"));
+  if (std::getenv("AS_TIME_BUDGET") != nullptr)
+    this->timeBudget = std::stod(std::getenv("AS_TIME_BUDGET"));
+
+  if (std::getenv("AS_ANYTIME_FILE") != nullptr)
+  {
+    std::error_code ec;
+    this->anytimeFile = std::make_unique<llvm::raw_fd_ostream>(std::getenv("AS_ANYTIME_FILE"), ec);
+    if (ec)
     {
-        int asVerbose = std::stoi(std::getenv("AS_VERBOSE"));
-        if (asVerbose == 1)
-        {
-            std::ofstream debugFile;
-            /*time_t now = time(0);
-            char* dt = ctime(&now); // Assuming you have this correctly defined elsewhere
-
-            std::string dtString(dt); // Convert char* to std::string
-
-            std::string logs = "logs_" + dtString + ".txt";*/
-            debugFile.open(LogsFileName, std::ios_base::app);
-            if (debugFile.is_open())
-            {
-                std::string str;
-                llvm::raw_string_ostream debugOut(str);
-                if (node->getTransformation() != NULL)
-                {
-                    debugFile << "###################################" << std::endl;
-                    debugFile << "Transformtion : " << std::endl;
-                    for (const auto &transformation : node->getTransformationList())
-                    {
-                        debugFile << transformation->printTransformation();
-                    }
-                    debugFile << std::endl;
-                }
-                op->print(debugOut);
-
-                debugFile << str << std::endl;
-                debugFile.close();
-            }
-        }
+      llvm::errs() << "Could not open the anytime trace: " << ec.message() << "\n";
+      this->anytimeFile.reset();
+      return;
     }
-    /*mlir::PassManager pmBefore((*op).get()->getName());
-
-    // Apply any generic pass manager command line options and run the pipeline.
-    applyPassManagerCLOptions(pmBefore);
-
-    bufferization::OneShotBufferizationOptions options;
-    options.allowReturnAllocs = true;
-    options.bufferizeFunctionBoundaries = true;
-    options.createDeallocs = true;
-    options.setFunctionBoundaryTypeConversion(mlir::bufferization::LayoutMapOption::IdentityLayoutMap);
-
-    pmBefore.addPass(mlir::createLoopInvariantCodeMotionPass());
-    pmBefore.addPass(mlir::createCSEPass());
-    pmBefore.addPass(mlir::createCanonicalizerPass());
-    pmBefore.addPass(mlir::createCSEPass());
-    pmBefore.addPass(mlir::bufferization::createOneShotBufferizePass(options));
-    mlir::OpPassManager &optPMBefore = pmBefore.nest<mlir::func::FuncOp>();
-    optPMBefore.addPass(mlir::bufferization::createBufferDeallocationPass());
-    optPMBefore.addPass(mlir::bufferization::createFinalizingBufferizePass());
-    pmBefore.addPass(mlir::createBufferizationToMemRefPass());
-    optPMBefore.addPass(mlir::bufferization::createBufferDeallocationPass());
-    if (!mlir::failed(pmBefore.run(*(*op))))*/
-
-    // TEMP : Transforming the code using the transform dialect interpreter; it uses a system call, and applies lowerings to the results of the vectorization
-    //op->print(output);
-   
-
-   //std::string transformDialectString = "transform.sequence failures(propagate) { \n ^bb1(%variant_op: !transform.any_op): \n %f = transform.structured.match ops{[\"func.func\"]} in %variant_op : (!transform.any_op) -> !transform.any_op \n transform.apply_patterns to %f {  \n transform.apply_patterns.vector.lower_contraction lowering_strategy = \"outerproduct\" \n transform.apply_patterns.vector.transfer_permutation_patterns \n transform.apply_patterns.vector.lower_multi_reduction lowering_strategy = \"innerparallel\" \n transform.apply_patterns.vector.split_transfer_full_partial split_transfer_strategy = \"vector-transfer\" \n transform.apply_patterns.vector.transfer_to_scf max_transfer_rank = 1 full_unroll = true \n transform.apply_patterns.vector.lower_transfer max_transfer_rank = 1 \n transform.apply_patterns.vector.lower_shape_cast \n transform.apply_patterns.vector.lower_transpose lowering_strategy = \"shuffle_1d\" \n transform.apply_patterns.canonicalization} \n : !transform.any_op}";
-    /*std::string transformedString = getTransformedCode(str1, transformDialectString);
-    if (transformedString == "process did not exit normally")
-    {
-        return "-1";
-    }*/
-    // TEMP : The interpreter introduces an extra "module {}", removing it
-    // std::string cleanedString = removeExtraModuleTagCreated(transformedString);
-    //std::cout<<cleanedString<<std::endl;
-    // Continue the lowerings of the code to llvm runnable code*/
-    //std::string transformDialectString = "transform.sequence failures(propagate) { \n ^bb1(%variant_op: !transform.any_op): \n %named_conv = transform.structured.match ops{[\"linalg.matmul\"]} in %variant_op : (!transform.any_op) -> !transform.any_op \n %forall_l1, %conv_l1 = transform.structured.tile_to_forall_op %named_conv tile_sizes [10, 10]: (!transform.any_op) -> (!transform.any_op, !transform.any_op) }";
-
-  
-    //mlir::OwningOpRef<Operation *> module = parseSourceString(transformDialectString, (op)->getContext());
-    //(*module)->dump();
-    std::string outString;
-    llvm::raw_string_ostream output_run(outString);
-
-
+    *this->anytimeFile << "evaluation,elapsed_s,evaluation_ns,failed,incumbent_ns\n";
+  }
+}
+void EvaluationByExecution::recordAnytime(const std::string &evaluation, bool failed)
+{
+  if (!this->anytimeFile)
+    return;
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->startTime).count();
+  *this->anytimeFile << this->numEvaluations << "," << elapsed << "," << (failed ? "" : evaluation) << ","
+                     << (failed ? 1 : 0) << "," << this->bestEvaluation << "\n";
+  this->anytimeFile->flush();
+}
+int EvaluationByExecution::getVerificationFailures()
+{
+  return this->verificationFailures;
+}
+void EvaluationByExecution::setBudget(int maxEvaluations, double timeBudget)
+{
+  this->maxEvaluations = maxEvaluations;
+  this->timeBudget = timeBudget;
+  this->startTime = std::chrono::steady_clock::now();
+}
+void EvaluationByExecution::setTargetEvaluation(double evaluation)
+{
+  this->targetEvaluation = evaluation;
+}
+bool EvaluationByExecution::isTargetReached()
+{
+  return this->targetEvaluation > 0 && !this->bestEvaluation.empty() &&
+         std::stod(this->bestEvaluation) <= this->targetEvaluation;
+}
+bool EvaluationByExecution::isBudgetExhausted()
+{
+  if (this->numEvaluations == 0)
+    return false;
+  if (this->isTargetReached())
+    return true;
+  if (this->maxEvaluations > 0 && this->numEvaluations >= this->maxEvaluations)
+    return true;
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->startTime).count();
+  return this->timeBudget > 0 && elapsed >= this->timeBudget;
+}
+int EvaluationByExecution::getNumEvaluations()
+{
+  return this->numEvaluations;
+}
+int EvaluationByExecution::getCachedEvaluations()
+{
+  return this->cachedEvaluations;
+}
+int EvaluationByExecution::getSkippedEvaluations()
+{
+  return this->skippedEvaluations;
+}
+std::string EvaluationByExecution::getBestEvaluation()
+{
+  return this->bestEvaluation;
+}
+std::vector<Transformation *> EvaluationByExecution::getBestSchedule()
+{
+  return this->bestSchedule;
+}
+bool EvaluationByExecution::lowerModule(mlir::Operation *op, Node *node, bool timePasses)
+{
     std::string transformDialectString = "module attributes {transform.with_named_sequence} { \n transform.named_sequence @__transform_main(%variant_op: !transform.any_op {transform.readonly})  { %f = transform.structured.match ops{[\"func.func\"]} in %variant_op : (!transform.any_op) -> !transform.any_op \n transform.apply_patterns to %f {  \n transform.apply_patterns.vector.lower_contraction lowering_strategy = \"outerproduct\" \n transform.apply_patterns.vector.transfer_permutation_patterns \n transform.apply_patterns.vector.lower_multi_reduction lowering_strategy = \"innerparallel\" \n transform.apply_patterns.vector.split_transfer_full_partial split_transfer_strategy = \"vector-transfer\" \n transform.apply_patterns.vector.transfer_to_scf max_transfer_rank = 1 full_unroll = true \n transform.apply_patterns.vector.lower_transfer max_transfer_rank = 1 \n transform.apply_patterns.vector.lower_shape_cast \n transform.apply_patterns.vector.lower_transpose lowering_strategy = \"shuffle_1d\" \n transform.apply_patterns.canonicalization} \n : !transform.any_op \n transform.yield}}";
-    std::cout << "START VECT\n";
+    AS_LOG(LogLevel::Debug, "START VECT");
 
+    llvm::timeTraceProfilerBegin("Lower vector operations", "");
+    auto vectorLoweringStart = std::chrono::steady_clock::now();
     mlir::transform::TransformOptions options1;
     mlir::OwningOpRef<mlir::ModuleOp> moduleFromFile = parseSourceString<mlir::ModuleOp>(transformDialectString, op->getContext());
     llvm::StringRef entryPoint = "__transform_main";
@@ -128,6 +132,10 @@ std::string EvaluationByExecution::evaluateTransformation(Node *node)
     transform::applyTransformNamedSequence(
         op, transformEntryPoint, *moduleFromFile,
         options1.enableExpensiveChecks(false));
+    llvm::timeTraceProfilerEnd();
+    if (timePasses)
+        PassTiming::get().addRun("Lower vector operations (transform interpreter)",
+                                 std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - vectorLoweringStart).count());
 
     //auto start = std::chrono::high_resolution_clock::now();
     mlir::PassManager pm((op)->getName());
@@ -135,12 +143,23 @@ std::string EvaluationByExecution::evaluateTransformation(Node *node)
     
     // Apply any generic pass manager command line options and run the pipeline.
     applyPassManagerCLOptions(pm);
+    // Each pass is an event of the trace, nested in the lowering event
+    addPassTracing(pm);
+    // The time and the statistics of the passes (AS_PASS_TIMING)
+    if (timePasses)
+        PassTiming::get().instrument(pm);
     
+    // The bufferization options are part of the schedule (the last bufferization
+    // strategy of the node), the default strategy otherwise
+    BufferizationStrategy defaultStrategy(op->getContext());
+    BufferizationStrategy *strategy = BufferizationStrategy::getBufferizationStrategy(node);
+    if (strategy == NULL)
+        strategy = &defaultStrategy;
+
     bufferization::OneShotBufferizationOptions options;
     //options.allowReturnAllocs = true;
-    options.bufferizeFunctionBoundaries = true;
     //options.createDeallocs = true;
-    options.setFunctionBoundaryTypeConversion(mlir::bufferization::LayoutMapOption::IdentityLayoutMap);
+    strategy->configureOptions(options);
     //pm.addPass(createTransformDialectInterpreterPass(transformDialectString));
 
     //pm.addPass(createTestTransformDialectEraseSchedulePass());
@@ -149,7 +168,8 @@ std::string EvaluationByExecution::evaluateTransformation(Node *node)
     pm.addPass(mlir::createCanonicalizerPass());
     pm.addPass(mlir::createCSEPass());
 
-    pm.addPass(mlir::bufferization::createEmptyTensorEliminationPass());
+    if (strategy->getEmptyTensorElimination())
+        pm.addPass(mlir::bufferization::createEmptyTensorEliminationPass());
     pm.addPass(mlir::bufferization::createEmptyTensorToAllocTensorPass());
     
     pm.addPass(mlir::bufferization::createOneShotBufferizePass(options));
@@ -157,6 +177,11 @@ std::string EvaluationByExecution::evaluateTransformation(Node *node)
     mlir::OpPassManager &optPM = pm.nest<mlir::func::FuncOp>();
     
     optPM.addPass(mlir::bufferization::createBufferDeallocationPass());
+    // Runs the operations tagged by the InterOpConcurrency transformation in OpenMP sections
+    optPM.addPass(mlir::createConcurrentRegionsLowering());
+    // Packs the intermediate buffers in a shared arena (AS_MEMORY_PLANNING=1)
+    if (isEnvFlagSet("AS_MEMORY_PLANNING"))
+        optPM.addPass(mlir::createBufferArenaPlanning());
     //optPM.addPass(mlir::bufferization::createFinalizingBufferizePass());
     //pm.addPass(mlir::createBufferizationToMemRefPass());
     //optPM.addPass(mlir::bufferization::createBufferDeallocationPass());
@@ -165,6 +190,7 @@ std::string EvaluationByExecution::evaluateTransformation(Node *node)
     optPM.addPass(mlir::createForEachThreadLowering());
     pm.addPass(mlir::createConvertVectorToSCFPass());
     pm.addPass(mlir::createConvertSCFToOpenMPPass());
+    pm.addNestedPass<mlir::func::FuncOp>(mlir::createConcurrentThreadAllotment());
     pm.addPass(mlir::createCanonicalizerPass());
     optPM.addPass(mlir::createLowerAffinePass());
     optPM.addPass(memref::createExpandStridedMetadataPass());
@@ -176,11 +202,194 @@ std::string EvaluationByExecution::evaluateTransformation(Node *node)
     pm.addPass(createConvertOpenMPToLLVMPass());
      pm.addPass(createConvertVectorToLLVMPass());
     pm.addPass(createConvertControlFlowToLLVMPass());
+    // The math operations of the normalizations (exp, rsqrt) become LLVM
+    // intrinsics, those without one become calls to libm
+    pm.addPass(mlir::createConvertMathToLLVMPass());
+    pm.addPass(mlir::createConvertMathToLibmPass());
     pm.addPass(mlir::createConvertFuncToLLVMPass());
     pm.addPass(mlir::createReconcileUnrealizedCastsPass());
+    pm.addPass(mlir::createFastMathFlagsLowering());
+
+    llvm::timeTraceProfilerBegin("Lower to LLVM", "");
+    bool lowered = !mlir::failed(pm.run((op)));
+    llvm::timeTraceProfilerEnd();
+    return lowered;
+}
+
+void EvaluationByExecution::setReferenceCode(MLIRCodeIR *code)
+{
+    if (this->patternCode != nullptr)
+        this->patternCode->dropReference();
+    this->patternCode = nullptr;
+    if (this->referenceCode != nullptr)
+        this->referenceCode->dropReference();
+    this->referenceCode = code;
+    if (code != nullptr)
+        code->retain();
+}
+
+EvaluationByExecution::~EvaluationByExecution()
+{
+    this->setReferenceCode(nullptr);
+}
+
+std::optional<double> EvaluationByExecution::computeChecksum(Node *node)
+{
+    llvm::TimeTraceScope traceScope("Verify output");
+    if (this->referenceCode == nullptr)
+        return std::nullopt;
+    // The inputs of the copy of the root code are filled with a pattern once,
+    // the search itself works on the code given to it
+    if (this->patternCode == nullptr)
+    {
+        this->patternCode = (MLIRCodeIR *)this->referenceCode->cloneIr();
+        mlir::Operation *patternModule = (mlir::Operation *)this->patternCode->getIr();
+        invalidateOpIdentityIndex(patternModule);
+        int numFills = fillInputsWithPattern(patternModule);
+        AS_LOG(LogLevel::Debug, "Filled " << numFills << " inputs of the verified code with a pattern");
+    }
+
+    // The schedule of the node is replayed on the pattern code, the operations
+    // are found by their identifiers which the pattern keeps
+    MLIRCodeIR *code = (MLIRCodeIR *)this->patternCode->cloneIr();
+    if (code->materialize())
+        for (Transformation *transformation : node->getTransformationList())
+            transformation->applyTransformation(*code);
+    mlir::Operation *module = code->assembleModule();
+    code->dropReference();
+    if (module == nullptr)
+        return std::nullopt;
+
+    std::optional<double> checksum;
+    if (!instrumentOutputChecksum(module))
+        AS_LOG(LogLevel::Error, "No main function calling a kernel, the output cannot be verified");
+    else if (lowerModule(module, node, false))
+    {
+        std::string lowered;
+        llvm::raw_string_ostream loweredStream(lowered);
+        module->print(loweredStream);
+        loweredStream.flush();
+        std::string rawOutput;
+        getEvaluation(lowered, &rawOutput);
+        checksum = parseOutputChecksum(rawOutput);
+    }
+    invalidateOpIdentityIndex(module);
+    module->erase();
+    return checksum;
+}
+
+std::string EvaluationByExecution::evaluateTransformation(Node *node)
+{
+    // The candidates left once the budget is spent get the evaluation of a
+    // failed candidate, the search ends without running them
+    if (this->isBudgetExhausted())
+    {
+        if (this->skippedEvaluations++ == 0 && this->isTargetReached())
+            AS_LOG(LogLevel::Info, "Target of the roofline reached after " << this->numEvaluations << " evaluations");
+        else if (this->skippedEvaluations == 1)
+            AS_LOG(LogLevel::Info, "Evaluation budget spent after " << this->numEvaluations << " evaluations");
+        return "9000000000000000000";
+    }
+    this->numEvaluations++;
+
+    llvm::TimeTraceScope evaluationScope("Evaluate candidate", [&]()
+                                         { return getTraceCandidateName(node); });
+    std::string str1;
+    llvm::raw_string_ostream output(str1);
+
+    MLIRCodeIR *CodeIr = (MLIRCodeIR *)node->getTransformedCodeIr();
+    // The code stays materialized after the evaluation, the best candidate is
+    // expanded next: the search parks or frees the candidates that leave the
+    // frontier.
+    bool wasMaterialized = CodeIr->isMaterialized();
+    bool wasParked = CodeIr->isParked();
+    MetricsRegistry::get().addCodeCacheLookup(wasMaterialized || wasParked);
+    // The full module is assembled from the kernels of the candidate
+    mlir::Operation *op = CodeIr->assembleModule();
+    if (op == nullptr)
+    {
+        AS_LOG(LogLevel::Warning, "Could not materialize the code of " << getTraceCandidateName(node));
+        return "9000000000000000000";
+    }
+    
+    //Operation *ClonedTarget = ((Operation *)(*node->getTransformedCodeIr()).getIr());
+    // Printing the transformed code, the logger writes it in the background
+    if (isEnvFlagSet("AS_VERBOSE"))
+    {
+        std::string header;
+        if (node->getTransformation() != NULL)
+        {
+            header += "###################################\n";
+            header += "Transformtion : \n";
+            for (const auto &transformation : node->getTransformationList())
+            {
+                header += transformation->printTransformation();
+            }
+            header += "\n";
+        }
+        Logger::get().appendIR(LogsFileName, header, op);
+    }
+    /*mlir::PassManager pmBefore((*op).get()->getName());
+
+    // Apply any generic pass manager command line options and run the pipeline.
+    applyPassManagerCLOptions(pmBefore);
+
+    bufferization::OneShotBufferizationOptions options;
+    options.allowReturnAllocs = true;
+    options.bufferizeFunctionBoundaries = true;
+    options.createDeallocs = true;
+    options.setFunctionBoundaryTypeConversion(mlir::bufferization::LayoutMapOption::IdentityLayoutMap);
+
+    pmBefore.addPass(mlir::createLoopInvariantCodeMotionPass());
+    pmBefore.addPass(mlir::createCSEPass());
+    pmBefore.addPass(mlir::createCanonicalizerPass());
+    pmBefore.addPass(mlir::createCSEPass());
+    pmBefore.addPass(mlir::bufferization::createOneShotBufferizePass(options));
+    mlir::OpPassManager &optPMBefore = pmBefore.nest<mlir::func::FuncOp>();
+    optPMBefore.addPass(mlir::bufferization::createBufferDeallocationPass());
+    optPMBefore.addPass(mlir::bufferization::createFinalizingBufferizePass());
+    pmBefore.addPass(mlir::createBufferizationToMemRefPass());
+    optPMBefore.addPass(mlir::bufferization::createBufferDeallocationPass());
+    if (!mlir::failed(pmBefore.run(*(*op))))*/
 
-    if (!mlir::failed(pm.run((op))))
+    // TEMP : Transforming the code using the transform dialect interpreter; it uses a system call, and applies lowerings to the results of the vectorization
+    //op->print(output);
+   
+
+   //std::string transformDialectString = "transform.sequence failures(propagate) { \n ^bb1(%variant_op: !transform.any_op): \n %f = transform.structured.match ops{[\"func.func\"]} in %variant_op : (!transform.any_op) -> !transform.any_op \n transform.apply_patterns to %f {  \n transform.apply_patterns.vector.lower_contraction lowering_strategy = \"outerproduct\" \n transform.apply_patterns.vector.transfer_permutation_patterns \n transform.apply_patterns.vector.lower_multi_reduction lowering_strategy = \"innerparallel\" \n transform.apply_patterns.vector.split_transfer_full_partial split_transfer_strategy = \"vector-transfer\" \n transform.apply_patterns.vector.transfer_to_scf max_transfer_rank = 1 full_unroll = true \n transform.apply_patterns.vector.lower_transfer max_transfer_rank = 1 \n transform.apply_patterns.vector.lower_shape_cast \n transform.apply_patterns.vector.lower_transpose lowering_strategy = \"shuffle_1d\" \n transform.apply_patterns.canonicalization} \n : !transform.any_op}";
+    /*std::string transformedString = getTransformedCode(str1, transformDialectString);
+    if (transformedString == "process did not exit normally")
+    {
+        return "-1";
+    }*/
+    // TEMP : The interpreter introduces an extra "module {}", removing it
+    // std::string cleanedString = removeExtraModuleTagCreated(transformedString);
+    //std::cout<<cleanedString<<std::endl;
+    // Continue the lowerings of the code to llvm runnable code*/
+    //std::string transformDialectString = "transform.sequence failures(propagate) { \n ^bb1(%variant_op: !transform.any_op): \n %named_conv = transform.structured.match ops{[\"linalg.matmul\"]} in %variant_op : (!transform.any_op) -> !transform.any_op \n %forall_l1, %conv_l1 = transform.structured.tile_to_forall_op %named_conv tile_sizes [10, 10]: (!transform.any_op) -> (!transform.any_op, !transform.any_op) }";
+
+  
+    //mlir::OwningOpRef<Operation *> module = parseSourceString(transformDialectString, (op)->getContext());
+    //(*module)->dump();
+    // The root (baseline) code and the verified candidates are checked against
+    // the checksum of their output: all the candidates with AS_VERIFY=1, the
+    // candidates changing the numerics of the kernels with AS_FASTMATH=1
+    bool isRoot = node->getTransformation() == NULL;
+    bool verifyOutput = false;
+    if (isEnvFlagSet("AS_VERIFY"))
+        verifyOutput = true;
+    else if (isEnvFlagSet("AS_FASTMATH"))
+        verifyOutput = isRoot || FastMath::hasFastMath(node);
+
+    std::string outString;
+    llvm::raw_string_ostream output_run(outString);
+    bool lowered = lowerModule(op, node, true);
+    PassTiming::get().recordCandidate(getTraceCandidateName(node), lowered);
+    if (lowered)
+    {
+        llvm::TimeTraceScope traceScope("Print LLVM module");
         (op)->print(output_run);
+    }
     /*auto end = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);*/
     
@@ -188,32 +397,73 @@ std::string EvaluationByExecution::evaluateTransformation(Node *node)
 
     // Getting the evaluation uisng mlir-cpu-runner, the function uses a system call
     //auto start_eval = std::chrono::high_resolution_clock::now();
-    std::string OutputData = getEvaluation(outString);
+    std::string RawOutput;
+    std::string OutputData;
+    // A module run before gets its stored evaluation (AS_EVALUATION_CACHE=1),
+    // which does not spend the budget
+    bool cached = lowered && EvaluationCache::get().lookup(outString, OutputData, RawOutput);
+    if (lowered && EvaluationCache::get().isEnabled())
+        MetricsRegistry::get().addEvaluationCacheLookup(cached);
+    if (cached)
+    {
+        this->numEvaluations--;
+        this->cachedEvaluations++;
+    }
+    else
+    {
+        OutputData = getEvaluation(outString, &RawOutput);
+        if (lowered)
+            EvaluationCache::get().insert(outString, OutputData, RawOutput);
+    }
+
+    // Rejects the candidates whose output is not within the tolerance of the
+    // output of the baseline code, a candidate is verified when it ran
+    bool ran = !OutputData.empty() && OutputData != "9000000000000000000";
+    if (verifyOutput && (isRoot || ran))
+    {
+        std::optional<double> checksum = this->computeChecksum(node);
+        if (isRoot)
+        {
+            this->hasReferenceChecksum = checksum.has_value();
+            if (checksum)
+                this->referenceChecksum = *checksum;
+            else
+                AS_LOG(LogLevel::Error, "The root code printed no checksum, the verified candidates fail");
+        }
+        else if (!this->hasReferenceChecksum || !checksum ||
+                 !isWithinTolerance(this->referenceChecksum, *checksum, getVerificationTolerance()))
+        {
+            AS_LOG(LogLevel::Warning, "Output verification failed for " << getTraceCandidateName(node));
+            this->verificationFailures++;
+            OutputData = "9000000000000000000";
+        }
+    }
         //op->dump();
    
     /*auto end_eval = std::chrono::high_resolution_clock::now();
     auto duration_eval = std::chrono::duration_cast<std::chrono::microseconds>(end_eval - start_eval);*/
     
     // Printing the evaluation 
-    if (std::getenv("AS_VERBOSE") != nullptr)
+    if (isEnvFlagSet("AS_VERBOSE") && node->getTransformation() != NULL)
     {
-        int asVerbose = std::stoi(std::getenv("AS_VERBOSE"));
-        if (asVerbose == 1)
-        {
-            std::ofstream debugFile;
-            debugFile.open(LogsFileName, std::ios_base::app);
-            if (debugFile.is_open())
-            {
-                if (node->getTransformation() != NULL)
-                {
-                    debugFile << OutputData << std::endl;
-                    /*debugFile << "Time taken by Lowerings: " << duration.count() << " microseconds" << std::endl;
-                    debugFile << "Time taken by Evaluation: " << duration_eval.count() << " microseconds" << std::endl;*/
-                }
-                debugFile.close();
-            }
-        }
+        Logger::get().append(LogsFileName, OutputData + "\n");
+        /*debugFile << "Time taken by Lowerings: " << duration.count() << " microseconds" << std::endl;
+        debugFile << "Time taken by Evaluation: " << duration_eval.count() << " microseconds" << std::endl;*/
     }
+    bool failed = OutputData.empty() || OutputData == "9000000000000000000";
+    MetricsRegistry::get().addEvaluation(std::strtod(OutputData.c_str(), nullptr), isRoot, failed);
+    SearchTreeRecorder::get().recordEvaluation(node, OutputData, failed);
+    if (!failed && (this->bestEvaluation.empty() ||
+                    std::stod(OutputData) < std::stod(this->bestEvaluation)))
+    {
+        this->bestEvaluation = OutputData;
+        this->bestSchedule = node->getTransformationList();
+    }
+    this->recordAnytime(OutputData, failed);
+
+    // Frees the lowered copy of the code
+    invalidateOpIdentityIndex(op);
+    op->erase();
     return OutputData;
 }
 
@@ -246,18 +496,28 @@ pid_t popen2(const char *command, int *infp, int *outfp)
         dup2(p_stdout[WRITE], WRITE);
         dup2(p_stdout[WRITE], STDERR_FILENO);
 
-        if (std::getenv("LLVM_PATH") != nullptr && std::getenv("SHARED_LIBS") != nullptr)
+        // The parallel loops of the concurrent sections are nested parallel regions
+        setenv("OMP_MAX_ACTIVE_LEVELS", "2", 0);
+
+        // AS_CPU_RUNNER is the path of mlir-cpu-runner, by default the one of
+        // the LLVM build in LLVM_PATH
+        if (isCpuRunnerAvailable())
         {
-            std::string llvm_path = std::getenv("LLVM_PATH");
-            std::string runner = llvm_path + "/build/bin/mlir-cpu-runner";
+            std::string runner;
+            if (std::getenv("AS_CPU_RUNNER") != nullptr)
+                runner = std::getenv("AS_CPU_RUNNER");
+            else
+                runner = std::string(std::getenv("LLVM_PATH")) + "/build/bin/mlir-cpu-runner";
             char *shared_libs = std::getenv("SHARED_LIBS");
             execl(runner.c_str(),
                   "mlir-cpu-runner", "-e", "main", "-entry-point-result=void",
                   "-shared-libs", shared_libs,
                   NULL);
         }
+        // _exit: the destructors of the statics (logger, metrics) must not run
+        // in the child, it does not have their threads
         perror("execl");
-        exit(1);
+        _exit(127);
     }
 
     // Parent process
@@ -275,60 +535,6 @@ pid_t popen2(const char *command, int *infp, int *outfp)
 
     return pid;
 }
-/*pid_t popen22(const char *command, int *infp, int *outfp)
-{
-    int p_stdin[2], p_stdout[2];
-    pid_t pid;
-
-    if (pipe(p_stdin) != 0 || pipe(p_stdout) != 0)
-        return -1;
-
-    pid = fork();
-
-    if (pid < 0)
-    {
-        close(p_stdin[READ]);
-        close(p_stdin[WRITE]);
-        close(p_stdout[READ]);
-        close(p_stdout[WRITE]);
-
-        return pid;
-    }
-    else if (pid == 0)
-    {
-        close(p_stdin[WRITE]);
-        dup2(p_stdin[READ], READ);
-        close(p_stdout[READ]);
-        dup2(p_stdout[WRITE], WRITE);
-        dup2(p_stdout[WRITE], STDERR_FILENO);
-        if (std::getenv("LLVM_PATH") != nullptr)
-        {
-            std::string llvm_path = std::getenv("LLVM_PATH");
-            std::string opt = llvm_path + "/build/bin/mlir-opt";
-            execl(opt.c_str(),
-                  "mlir-opt", "--test-transform-dialect-interpreter", "--test-transform-dialect-erase-schedule",
-                  NULL);
-        }
-
-        perror("execl");
-        exit(1);
-    }
-
-    // Parent process
-    close(p_stdin[READ]);
-    close(p_stdout[WRITE]);
-    if (infp == NULL)
-        close(p_stdin[WRITE]);
-    else
-        *infp = p_stdin[WRITE];
-
-    if (outfp == NULL)
-        close(p_stdout[READ]);
-    else
-        *outfp = p_stdout[READ];
-
-    return pid;
-}*/
 
 std::string removeExtraModuleTagCreated(std::string input) // TODO: Figure out why Transform Dialect Interpreter introduces an extra module
 {
@@ -348,13 +554,15 @@ std::string removeExtraModuleTagCreated(std::string input) // TODO: Figure out w
 /// Returns the captured output as a string, optionally stripping
 /// newline characters from the output.
 
-std::string getEvaluation(std::string inputCode)
+std::string getEvaluation(std::string inputCode, std::string *rawOutput)
 {
 
     std::string command = "";
     int in_fd, out_fd;
     pid_t pid;
 
+    // The runner event covers the execution and the reading of its output
+    llvm::timeTraceProfilerBegin("Run", "mlir-cpu-runner");
     // Call popen2 to execute the command and get the input and output file descriptors
     pid = popen2(command.c_str(), &in_fd, &out_fd);
 
@@ -403,22 +611,26 @@ std::string getEvaluation(std::string inputCode)
 
     // Remove newline characters from the output data
     output_data.erase(std::remove(output_data.begin(), output_data.end(), '\n'), output_data.end());
-    printf("Command output:\n%s\n", output_data.data());
+    AS_LOG(LogLevel::Debug, "Command output:\n" << output_data.data());
 
     close(out_fd); // Close the output file descriptor
 
     // Wait for the child process to finish
     int status;
     waitpid(pid, &status, 0);
+    llvm::timeTraceProfilerEnd();
 
     // Check if the child process exited normally
     if (WIFEXITED(status))
     {
         int exit_status = WEXITSTATUS(status);
-        printf("Cpu Runner Child process exited with status: %d\n", exit_status);
+        AS_LOG(LogLevel::Debug, "Cpu Runner Child process exited with status: " << exit_status);
+        llvm::TimeTraceScope traceScope("Parse result");
          
         std::string evalString = "";
         std::string data(output_data.begin(), output_data.end());
+        if (rawOutput != nullptr)
+            *rawOutput = data;
 
         size_t lastGFLOPSPos = data.rfind("GFLOPS"); // Find the position of the last "GFLOPS"
         if (lastGFLOPSPos != std::string::npos) {
@@ -429,93 +641,16 @@ std::string getEvaluation(std::string inputCode)
                 evalString = substring.substr(spacePos + 6); // Extract the number string after the last space   
             }
         } else {
-            std::cout << "No GFLOPS found in the input string." << std::endl;
+            AS_LOG(LogLevel::Warning, "No GFLOPS found in the input string.");
             return "9000000000000000000";
         }
-        std::cout<<evalString<<std::endl;
+        AS_LOG(LogLevel::Debug, evalString);
 
         return evalString;
     }
     else
     {
-        printf("Cpu Runner Child process did not exit normally.\n");
+        AS_LOG(LogLevel::Warning, "Cpu Runner Child process did not exit normally.");
         return "9000000000000000000";
     }
 }
-
-/// Transforms the input code using the transform dialect string. 
-/// The function uses the mlir-opt tool to run the transform dialect
-/// interprter, returns the transformed code
-
-/*std::string getTransformedCode(std::string inputCode, std::string transfromDialectString)
-{
-    int in_fd, out_fd;
-    pid_t pid;
-
-    // std::string str2 = str1 + "transform.sequence failures(propagate) {^bb0(%arg1: !transform.any_op): \n   %func = transform.structured.match ops{[\"func.func\"]} in %arg1: (!transform.any_op) -> !transform.any_op \n  %func_0 = transform.structured.vectorize %func {vectorize_padding} : (!transform.any_op) -> (!transform.any_op) \n %func_01 = transform.structured.hoist_redundant_vector_transfers %func_0 : (!transform.any_op) -> (!transform.any_op) \n  transform.structured.hoist_redundant_tensor_subsets %func_01 : (!transform.any_op) -> ()}";
-    std::string str = inputCode + transfromDialectString;
-
-    //  Call popen2 to execute the command and get the input and output file descriptors
-    pid = popen22("", &in_fd, &out_fd);
-
-    if (pid < 0)
-    {
-        perror("Failed to execute command");
-        exit(EXIT_FAILURE);
-    }
-    // Measure the start time
-    write(in_fd, str.c_str(), str.size());
-
-    close(in_fd);
-    // Read the output of the executed command
-    const int max_output_size = INT_MAX;
-    std::vector<char> output_data(max_output_size); // Using a dynamic buffer
-
-    ssize_t total_bytes_read = 0;
-
-    while (true)
-    {
-        ssize_t bytes_read = read(out_fd, output_data.data() + total_bytes_read, output_data.size() - total_bytes_read);
-
-        if (bytes_read > 0)
-        {
-            total_bytes_read += bytes_read;
-
-            // Check if the buffer is full (you can adjust this condition based on your needs)
-            if (total_bytes_read == max_output_size)
-            {
-                break; // Exit the loop to avoid buffer overflow
-            }
-        }
-        else if (bytes_read == 0)
-        {
-            // No more data available to read
-            break;
-        }
-        else
-        {
-            // Error occurred while reading
-            perror("Error while reading output");
-            break;
-        }
-    }
-
-    close(out_fd); // Close the output file descriptor
-
-    // Wait for the child process to finish
-    int status;
-    waitpid(pid, &status, 0);
-
-    // Check if the child process exited normally
-    if (WIFEXITED(status))
-    {
-        int exit_status = WEXITSTATUS(status);
-        printf("OPT Child process exited with status: %d\n", exit_status);
-        return output_data.data();
-    }
-    else
-    {
-        printf("OPT process did not exit normally.\n");
-        return "process did not exit normally";
-    }
-}*/
\ No newline at end of file
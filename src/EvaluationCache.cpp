@@ -0,0 +1,113 @@
+//===-------------------- EvaluationCache.cpp EvaluationCache -------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the EvaluationCache class, which
+/// keeps the output of the runner for the lowered modules already run
+///
+//===----------------------------------------------------------------------===//
+#include "EvaluationCache.h"
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/xxhash.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+/// Returns the key of the module.
+static uint64_t hashModule(llvm::StringRef loweredModule)
+{
+  return llvm::xxh3_64bits(llvm::arrayRefFromStringRef(loweredModule));
+}
+
+/// Returns the hash checked by the lookups, computed by another function than
+/// the key.
+static uint64_t checkHashModule(llvm::StringRef loweredModule)
+{
+  return llvm::xxHash64(loweredModule);
+}
+
+EvaluationCache::EvaluationCache()
+{
+  this->enabled = std::getenv("AS_EVALUATION_CACHE") != nullptr && std::stoi(std::getenv("AS_EVALUATION_CACHE")) == 1;
+  if (std::getenv("AS_EVALUATION_CACHE_SIZE") != nullptr)
+    this->capacity = std::max(1, std::stoi(std::getenv("AS_EVALUATION_CACHE_SIZE")));
+}
+
+EvaluationCache &EvaluationCache::get()
+{
+  static EvaluationCache cache;
+  return cache;
+}
+
+bool EvaluationCache::isEnabled()
+{
+  return this->enabled;
+}
+
+void EvaluationCache::setEnabled(bool enabled)
+{
+  this->enabled = enabled;
+}
+
+bool EvaluationCache::lookup(llvm::StringRef loweredModule, std::string &evaluation, std::string &rawOutput)
+{
+  if (!this->enabled)
+    return false;
+  auto entry = this->entries.find(hashModule(loweredModule));
+  if (entry == this->entries.end())
+  {
+    this->misses++;
+    return false;
+  }
+  if (entry->second.size != loweredModule.size() || entry->second.checkHash != checkHashModule(loweredModule))
+  {
+    this->collisions++;
+    this->misses++;
+    return false;
+  }
+  this->hits++;
+  evaluation = entry->second.evaluation;
+  rawOutput = entry->second.rawOutput;
+  return true;
+}
+
+void EvaluationCache::insert(llvm::StringRef loweredModule, const std::string &evaluation,
+                             const std::string &rawOutput)
+{
+  if (!this->enabled || evaluation.empty() || evaluation == "9000000000000000000")
+    return;
+  uint64_t key = hashModule(loweredModule);
+  // The entry of another module with the same key is kept
+  if (!this->entries.try_emplace(key, Entry{evaluation, rawOutput, loweredModule.size(),
+                                            checkHashModule(loweredModule)})
+           .second)
+    return;
+  this->order.push_back(key);
+  while (this->order.size() > this->capacity)
+  {
+    this->entries.erase(this->order.front());
+    this->order.pop_front();
+  }
+}
+
+int EvaluationCache::getHits()
+{
+  return this->hits;
+}
+
+int EvaluationCache::getMisses()
+{
+  return this->misses;
+}
+
+int EvaluationCache::getCollisions()
+{
+  return this->collisions;
+}
+
+int EvaluationCache::getSize()
+{
+  return (int)this->entries.size();
+}
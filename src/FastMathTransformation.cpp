@@ -0,0 +1,103 @@
+//===------------ FastMathTransformation.cpp FastMathTransformation -----------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the FastMathTransformation class, which
+/// contains the declartion of the fast-math transformation
+///
+//===----------------------------------------------------------------------===//
+#include "FastMathTransformation.h"
+
+using namespace mlir;
+
+FastMath::FastMath(arith::FastMathFlags flags, mlir::MLIRContext *context)
+{
+  this->flags = flags;
+  this->context = context;
+}
+
+arith::FastMathFlags FastMath::getFlags()
+{
+  return this->flags;
+}
+
+std::string FastMath::getType()
+{
+  return "FastMath";
+}
+
+std::string FastMath::printTransformation()
+{
+  std::string result = "FM( ";
+  result += arith::stringifyFastMathFlags(flags);
+  result += " )";
+
+  return result;
+}
+
+void FastMath::applyTransformation(CodeIR CodeIr)
+{
+  llvm::TimeTraceScope traceScope("Apply transformation", [&]()
+                                { return this->printTransformation(); });
+  mlir::Operation *target = ((mlir::Operation *)CodeIr.getIr());
+  MLIRContext *ctx = target->getContext();
+
+  target->walk([&](func::FuncOp funcOp)
+               {
+    if (funcOp.isExternal() || getLinalgOps(funcOp).empty())
+      return;
+
+    arith::FastMathFlags funcFlags = flags;
+    if (auto flagsAttr = funcOp->getAttrOfType<arith::FastMathFlagsAttr>(kFastMathAttrName))
+      funcFlags = funcFlags | flagsAttr.getValue();
+    funcOp->setAttr(kFastMathAttrName, arith::FastMathFlagsAttr::get(ctx, funcFlags));
+
+    // The arith operations already in the function (bodies of the generic
+    // operations, vectorized code...).
+    funcOp.walk([&](arith::ArithFastMathInterface fmfOp)
+                {
+      arith::FastMathFlags opFlags = fmfOp.getFastMathFlagsAttr().getValue() | flags;
+      fmfOp->setAttr(fmfOp.getFastMathAttrName(), arith::FastMathFlagsAttr::get(ctx, opFlags)); }); });
+}
+
+bool FastMath::hasFastMath(Node *node)
+{
+  for (Transformation *transformation : node->getTransformationList())
+  {
+    if (transformation->getType() == "FastMath")
+      return true;
+  }
+  return false;
+}
+
+SmallVector<Node *, 2> FastMath::createFastMathCandidates(Node *node,
+                                                          mlir::MLIRContext *context)
+{
+  llvm::TimeTraceScope traceScope("Generate candidates", "FastMath");
+  SmallVector<Node *, 2> ChildNodes;
+  MLIRCodeIR *CodeIr = (MLIRCodeIR *)node->getTransformedCodeIr();
+
+  std::vector<arith::FastMathFlags> flagsList = {
+      arith::FastMathFlags::contract,
+      arith::FastMathFlags::reassoc | arith::FastMathFlags::contract,
+      arith::FastMathFlags::fast};
+
+  for (arith::FastMathFlags flags : flagsList)
+  {
+    MLIRCodeIR *ClonedCode = (MLIRCodeIR *)CodeIr->cloneIr();
+    Node *ChildNode = SearchTreeArena::get().createNode(ClonedCode, node->getCurrentStage());
+
+    std::vector<Transformation *> TransList = node->getTransformationList();
+    ChildNode->setTransformationList(TransList);
+
+    FastMath *fastMath = SearchTreeArena::get().createTransformation<FastMath>(flags, context);
+    fastMath->applyTransformation(*ClonedCode);
+
+    ChildNode->setTransformation(fastMath);
+    ChildNode->addTransformation(fastMath);
+
+    ChildNodes.push_back(ChildNode);
+  }
+  return ChildNodes;
+}
@@ -47,7 +47,37 @@ std::string Interchange::printTransformation()
 }
 void Interchange::applyTransformation(CodeIR CodeIr)
 {
-  IRRewriter rewriter(this->context);
+  llvm::TimeTraceScope traceScope("Apply transformation", [&]()
+                                { return this->printTransformation(); });
+  Operation *ClonedTarget = ((Operation *)CodeIr.getIr());
+  ArrayRef<unsigned> interchangeVector(this->InterchangeVector);
+  // The generalization replaces the named operations
+  invalidateOpIdentityIndex(ClonedTarget);
+
+  // Walk through operations in the cloned target operation
+  ClonedTarget->walk([&](Operation *op)
+                     {
+    if (linalg::LinalgOp ClonedInterchangeableOp = 
+              dyn_cast<linalg::LinalgOp>(op)) {
+        // TEMP: Check if the operation is not 'linalg.fill'
+        if ((op->getName().getStringRef()).str() != "linalg.fill"  ){
+            IRRewriter rewriter(ClonedTarget->getContext());
+            rewriter.setInsertionPoint(ClonedInterchangeableOp);
+            int64_t opId = getOpId(ClonedInterchangeableOp);
+            FailureOr<linalg::GenericOp> generalizeResult =
+                generalizeNamedOp(rewriter, ClonedInterchangeableOp);
+            if (failed(generalizeResult))
+              return;
+            // The generic operation replaces the named one
+            setOpId(*generalizeResult, opId);
+
+            // Perform interchange on the cloned operation
+            FailureOr<linalg::GenericOp> interOp = 
+                linalg::interchangeGenericOp(rewriter,
+                                            *generalizeResult, 
+                                            interchangeVector);
+        }
+      } });
 }
 
 std::vector<unsigned> Interchange::getInterchangeVector()
@@ -59,6 +89,7 @@ SmallVector<Node *, 2> Interchange::createInterchangeCandidates(
     Node *node,
     mlir::MLIRContext *context)
 {
+  llvm::TimeTraceScope traceScope("Generate candidates", "Interchange");
   // Initialize a list to store ChildNodes
   // SmallVector<SmallVector<Node *, 2>> ChildNodesList;
   SmallVector<Node* , 2> ChildNodes;
@@ -87,19 +118,20 @@ SmallVector<Node *, 2> Interchange::createInterchangeCandidates(
                 
         for (const auto& candidate : values){
 
-          // Clone the code, create a new node, and set its transformation list
-          MLIRCodeIR* ClonedCode =  (MLIRCodeIR*)CodeIr->cloneIr();
-          Node* ChildNode = new Node (ClonedCode, node->getCurrentStage());        
-
-          std::vector<Transformation*> TransList= node->getTransformationList();
-          ChildNode->setTransformationList(TransList);
-
-          // Create an interchange transformation and add it to the child node
+          // Create an interchange transformation
           Interchange *interchange = 
-            new Interchange(&InterchangeableOp,
+            SearchTreeArena::get().createTransformation<Interchange>(&InterchangeableOp,
                             candidate, 
                             context);
 
+          // Create a new node whose code is replayed from the parent code when it
+          // is evaluated, and set its transformation list
+          MLIRCodeIR* ChildCode = new MLIRCodeIR(CodeIr, interchange);
+          Node* ChildNode = SearchTreeArena::get().createNode(ChildCode, node->getCurrentStage());        
+
+          std::vector<Transformation*> TransList= node->getTransformationList();
+          ChildNode->setTransformationList(TransList);
+
           ChildNode->setTransformation(interchange);
           ChildNode->addTransformation(interchange);
 
@@ -111,49 +143,6 @@ SmallVector<Node *, 2> Interchange::createInterchangeCandidates(
       } 
       counter++; 
     } });
-  int OpIndex = 0;
-  // for (auto ChildNodes : ChildNodesList)
-  // {
-    for (auto node : ChildNodes)
-    {
-      // Get the target operation from the child node's transformed code
-      Operation *ClonedTarget = ((Operation *)(*((MLIRCodeIR *)node->getTransformedCodeIr()))
-                                     .getIr());
-      Interchange *inter = (Interchange *)node->getTransformation();
-
-      std::vector<unsigned> candidate = inter->getInterchangeVector();
-      ArrayRef<unsigned> interchangeVector(candidate);
-      int ClonedOpIndex = 0;
-
-      // Walk through operations in the cloned target operation
-      ClonedTarget->walk([&](Operation *op)
-                         {
-        if (linalg::LinalgOp ClonedInterchangeableOp = 
-                  dyn_cast<linalg::LinalgOp>(op)) {
-             // TEMP: Check if the operation is not 'linalg.fill' and ClonedOpIndex is 3 
-            if ((op->getName().getStringRef()).str() != "linalg.fill"  ){
-                //auto start = std::chrono::high_resolution_clock::now();
-                IRRewriter rewriter(context);
-                rewriter.setInsertionPoint(ClonedInterchangeableOp);
-                FailureOr<linalg::GenericOp> generalizeResult =
-                    generalizeNamedOp(rewriter, ClonedInterchangeableOp);
-                
-                auto genericOp = *generalizeResult;
-
-                // Perform interchange on the cloned operation
-                FailureOr<linalg::GenericOp> interOp = 
-                    linalg::interchangeGenericOp(rewriter,
-                                                genericOp, 
-                                                interchangeVector);
-                /*auto end = std::chrono::high_resolution_clock::now();
-                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-                std::cout << "Time taken by Interchange: " << duration.count() << " microseconds" << std::endl;*/
-               
-            }
-          ClonedOpIndex++;
-          } });
-    }
-    OpIndex++;
   // }
   // Merge the child nodes into a single list and return it
   /*SmallVector<Node *, 2> ResChildNodes;
@@ -0,0 +1,200 @@
+//===---------------------------- Logger.cpp Logger -----------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the Logger class, the logging of the
+/// search
+///
+//===----------------------------------------------------------------------===//
+#include "Logger.h"
+
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+
+/// Returns the level named by the string, info if it is unknown.
+static LogLevel parseLogLevel(const std::string &name)
+{
+  if (name == "error")
+    return LogLevel::Error;
+  if (name == "warning")
+    return LogLevel::Warning;
+  if (name == "debug")
+    return LogLevel::Debug;
+  if (name == "trace")
+    return LogLevel::Trace;
+  return LogLevel::Info;
+}
+
+Logger::Logger()
+{
+  if (std::getenv("AS_LOG") != nullptr)
+    this->level = parseLogLevel(std::getenv("AS_LOG"));
+  if (std::getenv("AS_LOG_FILE") != nullptr)
+    this->logFile = std::getenv("AS_LOG_FILE");
+  if (std::getenv("AS_LOG_IR_DIR") != nullptr)
+    this->irDirectory = std::getenv("AS_LOG_IR_DIR");
+  size_t capacity = 4096;
+  if (std::getenv("AS_LOG_BUFFER") != nullptr)
+    capacity = std::max(1, std::stoi(std::getenv("AS_LOG_BUFFER")));
+  this->buffer.resize(capacity);
+  this->writer = std::thread([this]()
+                             { this->runWriter(); });
+}
+
+Logger::~Logger()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stopping = true;
+  }
+  this->available.notify_one();
+  this->room.notify_all();
+  this->writer.join();
+}
+
+Logger &Logger::get()
+{
+  static Logger logger;
+  return logger;
+}
+
+bool Logger::isEnabled(LogLevel level)
+{
+  return level <= this->level;
+}
+
+void Logger::push(Entry entry, bool wait)
+{
+  {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    if (wait)
+      this->room.wait(lock, [this]()
+                      { return this->count < this->buffer.size() || this->stopping; });
+    if (this->count == this->buffer.size())
+    {
+      this->dropped++;
+      return;
+    }
+    this->buffer[(this->head + this->count) % this->buffer.size()] = std::move(entry);
+    this->count++;
+  }
+  this->available.notify_one();
+}
+
+void Logger::log(LogLevel level, std::string message)
+{
+  if (!this->isEnabled(level))
+    return;
+  if (level == LogLevel::Error)
+    message = "error: " + message;
+  else if (level == LogLevel::Warning)
+    message = "warning: " + message;
+  message += "\n";
+  this->push({this->logFile, std::move(message)}, level < LogLevel::Info);
+}
+
+void Logger::append(const std::string &file, std::string text)
+{
+  this->push({file, std::move(text)}, true);
+}
+
+void Logger::appendIR(const std::string &file, const std::string &header, mlir::Operation *op)
+{
+  std::string text = header;
+  if (!this->irDirectory.empty())
+  {
+    // The bytecode is written without the printing of the code
+    std::string bytecode;
+    llvm::raw_string_ostream os(bytecode);
+    if (succeeded(mlir::writeBytecodeToFile(op, os)))
+    {
+      os.flush();
+      std::string path = this->irDirectory + "/ir-" + std::to_string(this->irDumps++) + ".mlirbc";
+      text += "IR: " + path + "\n";
+      this->push({path, std::move(bytecode), true}, true);
+      this->push({file, std::move(text)}, true);
+      return;
+    }
+  }
+  llvm::raw_string_ostream os(text);
+  op->print(os);
+  os << "\n";
+  os.flush();
+  this->push({file, std::move(text)}, true);
+}
+
+void Logger::logIR(LogLevel level, const std::string &header, mlir::Operation *op)
+{
+  if (this->isEnabled(level))
+    this->appendIR(this->logFile, header + "\n", op);
+}
+
+void Logger::flush()
+{
+  std::unique_lock<std::mutex> lock(this->mutex);
+  this->drained.wait(lock, [this]()
+                     { return this->count == 0 && !this->writing; });
+}
+
+void Logger::runWriter()
+{
+  std::map<std::string, std::unique_ptr<std::ofstream>> files;
+  std::vector<Entry> batch;
+  while (true)
+  {
+    uint64_t droppedMessages;
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->writing = false;
+      this->drained.notify_all();
+      this->available.wait(lock, [this]()
+                           { return this->count > 0 || this->stopping; });
+      if (this->count == 0 && this->stopping && this->dropped == 0)
+        return;
+      // The whole buffer is taken at once, the producers are not blocked
+      // during the writes
+      batch.clear();
+      for (; this->count > 0; this->count--)
+      {
+        batch.push_back(std::move(this->buffer[this->head]));
+        this->head = (this->head + 1) % this->buffer.size();
+      }
+      droppedMessages = this->dropped;
+      this->dropped = 0;
+      this->writing = true;
+    }
+    this->room.notify_all();
+
+    if (droppedMessages > 0)
+      batch.push_back({this->logFile, "warning: " + std::to_string(droppedMessages) + " log messages dropped\n"});
+    for (Entry &entry : batch)
+    {
+      if (entry.isBytecode)
+      {
+        std::ofstream dump(entry.file, std::ios_base::binary);
+        dump.write(entry.data.data(), entry.data.size());
+        continue;
+      }
+      if (entry.file.empty())
+      {
+        std::fwrite(entry.data.data(), 1, entry.data.size(), stderr);
+        continue;
+      }
+      std::unique_ptr<std::ofstream> &file = files[entry.file];
+      if (!file)
+        file = std::make_unique<std::ofstream>(entry.file, std::ios_base::app);
+      *file << entry.data;
+    }
+    for (auto &file : files)
+      file.second->flush();
+    std::fflush(stderr);
+  }
+}
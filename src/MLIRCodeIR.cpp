@@ -9,6 +9,18 @@
 //===----------------------------------------------------------------------===//
 
 #include "MLIRCodeIR.h"
+#include "Transformation.h"
+#include "Utils.h"
+#include "OpIdentity.h"
+#include "Logger.h"
+
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/SymbolTable.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Compression.h"
+#include "llvm/Support/FileSystem.h"
 
 // MLIRCodeIR::MLIRCodeIR(void* Ir){
 //     this->Ir = Ir;
@@ -26,6 +38,7 @@ mlir::OwningOpRef<Operation *> MLIRCodeIR::parseInputFile(StringRef InputFilenam
     if (std::error_code ec = fileOrErr.getError())
     {
         llvm::errs() << "Could not open input file: " << ec.message() << "\n";
+        return nullptr;
     }
 
     // Parse the input mlir.
@@ -36,10 +49,94 @@ mlir::OwningOpRef<Operation *> MLIRCodeIR::parseInputFile(StringRef InputFilenam
     if (!module)
     {
         llvm::errs() << "Error can't load file " << InputFilename << "\n";
+        return nullptr;
     }
     // module->dump();
-    Operation *newop = (module.get())->clone();
+    this->loadModule(module.get());
+    return module;
+}
+
+void MLIRCodeIR::loadModule(Operation *module)
+{
+    Operation *newop = module->clone();
+    assignOpIds(newop);
+    // The functions that are not transformed are kept apart, unless
+    // AS_FUNCTION_SCOPED_IR=0
+    if (std::getenv("AS_FUNCTION_SCOPED_IR") == nullptr || std::stoi(std::getenv("AS_FUNCTION_SCOPED_IR")) != 0)
+        newop = this->scopeModule(newop);
     this->setIr(newop);
+}
+
+Operation *MLIRCodeIR::scopeModule(Operation *module)
+{
+    ModuleOp moduleOp = dyn_cast<ModuleOp>(module);
+    if (!moduleOp)
+        return module;
+
+    ModuleOp scoped = ModuleOp::create(moduleOp.getLoc());
+    scoped->setAttrs(moduleOp->getAttrDictionary());
+    OpBuilder scopedBuilder = OpBuilder::atBlockEnd(scoped.getBody());
+    OpBuilder skeletonBuilder(module->getContext());
+
+    for (Operation &op : llvm::make_early_inc_range(*moduleOp.getBody()))
+    {
+        func::FuncOp funcOp = dyn_cast<func::FuncOp>(op);
+        if (!funcOp || funcOp.isExternal())
+        {
+            scopedBuilder.clone(op);
+            continue;
+        }
+        if (getLinalgOps(funcOp).empty())
+        {
+            // Declaration of the function, so that the calls of the kernels verify
+            auto declaration = scopedBuilder.create<func::FuncOp>(funcOp.getLoc(), funcOp.getName(),
+                                                                  funcOp.getFunctionType());
+            declaration.setPrivate();
+            continue;
+        }
+        // The kernel is moved to the code, the skeleton keeps its position
+        skeletonBuilder.setInsertionPoint(funcOp);
+        auto declaration = skeletonBuilder.create<func::FuncOp>(funcOp.getLoc(), funcOp.getName(),
+                                                                funcOp.getFunctionType());
+        declaration.setPrivate();
+        funcOp->moveBefore(scoped.getBody(), scoped.getBody()->end());
+    }
+
+    this->skeleton = std::shared_ptr<Operation>(module, [](Operation *skeleton)
+                                                { skeleton->erase(); });
+    return scoped;
+}
+
+Operation *MLIRCodeIR::assembleModule()
+{
+    llvm::TimeTraceScope traceScope("Assemble module");
+    Operation *code = (Operation *)this->getIr();
+    if (code == nullptr)
+        return nullptr;
+    if (this->skeleton == nullptr)
+        return code->clone();
+
+    ModuleOp module = cast<ModuleOp>(this->skeleton->clone());
+    ModuleOp scoped = cast<ModuleOp>(code);
+    for (NamedAttribute attr : scoped->getAttrs())
+        module->setAttr(attr.getName(), attr.getValue());
+
+    SymbolTable symbolTable(module);
+    for (func::FuncOp funcOp : scoped.getOps<func::FuncOp>())
+    {
+        func::FuncOp existing = symbolTable.lookup<func::FuncOp>(funcOp.getName());
+        // Declarations of the functions of the skeleton
+        if (funcOp.isExternal() && existing)
+            continue;
+        Operation *clone = funcOp->clone();
+        if (existing)
+        {
+            existing->getBlock()->getOperations().insert(Block::iterator(existing), clone);
+            existing.erase();
+        }
+        else
+            module.push_back(clone);
+    }
     return module;
 }
 
@@ -48,16 +145,264 @@ CodeIR *MLIRCodeIR::setMLIRIR( Operation * module)
     MLIRCodeIR *clone = new MLIRCodeIR();
     Operation *newop = (module)->clone();
     clone->setIr(newop);
+    clone->skeleton = this->skeleton;
     return clone;
 }
 CodeIR *MLIRCodeIR::cloneIr()
 {
+    llvm::TimeTraceScope traceScope("Clone IR");
     MLIRCodeIR *clone = new MLIRCodeIR();
 
     // Create a clone of the Operation object stored in the current MLIRCodeIR's 
     // internal code representation. The cloned Operation is wrapped in an
     // OwningOpRef pointer.
-    Operation *op = ((Operation *)(this->getIr()))->clone();
-    clone->setIr(op);
+    // A code that cannot be materialized gives a clone without code, which
+    // fails to materialize in turn
+    Operation *op = (Operation *)this->getIr();
+    clone->setIr(op != nullptr ? op->clone() : nullptr);
+    clone->skeleton = this->skeleton;
     return clone;
 }
+
+MLIRCodeIR::MLIRCodeIR(MLIRCodeIR *parent, Transformation *recipe)
+{
+    this->parent = parent;
+    this->recipe = recipe;
+    this->skeleton = parent->skeleton;
+    this->setIr(nullptr);
+    parent->retain();
+}
+
+bool MLIRCodeIR::isMaterialized()
+{
+    return CodeIR::getIr() != nullptr;
+}
+
+bool MLIRCodeIR::hasRecipe()
+{
+    return this->parent != nullptr;
+}
+
+void *MLIRCodeIR::getIr()
+{
+    if (!this->isMaterialized() && this->isParked())
+        this->unpark();
+    if (!this->isMaterialized() && this->hasRecipe())
+    {
+        llvm::TimeTraceScope traceScope("Replay candidate");
+        // The parent is only kept if it was already materialized, so that a chain
+        // of lazy candidates does not keep all its intermediate code alive: the
+        // code of a parked parent is read without unparking it, and the code a
+        // lazy parent materialized for this replay is taken over instead of
+        // being cloned, so a chain is replayed with a single clone.
+        Operation *parentOp = nullptr;
+        if (this->parent->isMaterialized())
+            parentOp = ((Operation *)this->parent->getIr())->clone();
+        else if (this->parent->isParked())
+            parentOp = this->parent->readParked();
+        else
+        {
+            parentOp = (Operation *)this->parent->getIr();
+            this->parent->setIr(nullptr);
+        }
+        if (parentOp == nullptr)
+        {
+            AS_LOG(LogLevel::Error, "Could not replay " << this->recipe->printTransformation()
+                                    << ": the code of its parent cannot be materialized");
+            return nullptr;
+        }
+        this->setIr(parentOp);
+        this->recipe->applyTransformation(*this);
+    }
+    return CodeIR::getIr();
+}
+
+bool MLIRCodeIR::materialize()
+{
+    return this->getIr() != nullptr;
+}
+
+void MLIRCodeIR::release()
+{
+    if (!this->hasRecipe() || !this->isMaterialized())
+        return;
+    invalidateOpIdentityIndex((Operation *)CodeIR::getIr());
+    ((Operation *)CodeIR::getIr())->erase();
+    this->setIr(nullptr);
+}
+
+void MLIRCodeIR::retain()
+{
+    this->refCount++;
+}
+
+void MLIRCodeIR::dropReference()
+{
+    if (--this->refCount > 0)
+        return;
+    if (this->isMaterialized())
+    {
+        invalidateOpIdentityIndex((Operation *)CodeIR::getIr());
+        ((Operation *)CodeIR::getIr())->erase();
+    }
+    this->setIr(nullptr);
+    this->discardParked();
+    this->skeleton.reset();
+    if (this->hasRecipe())
+        this->parent->dropReference();
+    delete this;
+}
+
+MLIRCodeIR *MLIRCodeIR::getParent()
+{
+    return this->parent;
+}
+
+Transformation *MLIRCodeIR::getRecipe()
+{
+    return this->recipe;
+}
+
+bool MLIRCodeIR::isParked()
+{
+    return this->parked;
+}
+
+void MLIRCodeIR::park()
+{
+    if (this->isParked() || !this->isMaterialized())
+        return;
+    llvm::TimeTraceScope traceScope("Park");
+    Operation *op = (Operation *)CodeIR::getIr();
+    this->context = op->getContext();
+
+    std::string bytecode;
+    llvm::raw_string_ostream os(bytecode);
+    if (failed(writeBytecodeToFile(op, os)))
+        return;
+    os.flush();
+
+    invalidateOpIdentityIndex(op);
+    op->erase();
+    this->setIr(nullptr);
+    this->parkBytecode(bytecode, this->context);
+}
+
+void MLIRCodeIR::parkBytecode(llvm::StringRef bytecode, mlir::MLIRContext *context)
+{
+    if (this->isMaterialized())
+    {
+        invalidateOpIdentityIndex((Operation *)CodeIR::getIr());
+        ((Operation *)CodeIR::getIr())->erase();
+    }
+    this->setIr(nullptr);
+    this->discardParked();
+    this->context = context;
+    llvm::ArrayRef<uint8_t> data((const uint8_t *)bytecode.data(), bytecode.size());
+
+    bool compress = llvm::compression::zlib::isAvailable();
+    if (std::getenv("AS_PARK_COMPRESS") != nullptr)
+        compress = compress && std::stoi(std::getenv("AS_PARK_COMPRESS")) != 0;
+    if (compress)
+    {
+        llvm::compression::zlib::compress(data, this->parkedBytecode);
+        this->uncompressedSize = bytecode.size();
+    }
+    else
+    {
+        this->parkedBytecode.assign(data.begin(), data.end());
+        this->uncompressedSize = 0;
+    }
+
+    // Large modules are spilled to a temporary file
+    size_t spillBytes = 64 << 20;
+    if (std::getenv("AS_PARK_SPILL_BYTES") != nullptr)
+        spillBytes = std::stoull(std::getenv("AS_PARK_SPILL_BYTES"));
+    if (this->parkedBytecode.size() > spillBytes)
+    {
+        int fd;
+        llvm::SmallString<128> path;
+        if (!llvm::sys::fs::createTemporaryFile("as-parked", "mlirbc", fd, path))
+        {
+            llvm::raw_fd_ostream file(fd, /*shouldClose=*/true);
+            file.write((const char *)this->parkedBytecode.data(), this->parkedBytecode.size());
+            file.close();
+            if (!file.has_error())
+            {
+                this->parkedFile = path.str().str();
+                this->parkedBytecode.clear();
+                this->parkedBytecode.shrink_to_fit();
+            }
+            else
+            {
+                file.clear_error();
+                llvm::sys::fs::remove(path);
+            }
+        }
+    }
+
+    this->parked = true;
+}
+
+void MLIRCodeIR::unpark()
+{
+    llvm::TimeTraceScope traceScope("Unpark");
+    // A parked code that cannot be read is dropped: a lazy code is replayed
+    // from its recipe, the other codes have no code anymore (getIr() returns
+    // null)
+    Operation *op = this->readParked();
+    this->discardParked();
+    if (op != nullptr)
+        this->setIr(op);
+}
+
+Operation *MLIRCodeIR::readParked()
+{
+    std::unique_ptr<llvm::MemoryBuffer> file;
+    llvm::ArrayRef<uint8_t> data = this->parkedBytecode;
+    if (!this->parkedFile.empty())
+    {
+        llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> fileOrErr =
+            llvm::MemoryBuffer::getFile(this->parkedFile);
+        if (std::error_code ec = fileOrErr.getError())
+        {
+            llvm::errs() << "Could not read parked code: " << ec.message() << "\n";
+            return nullptr;
+        }
+        file = std::move(*fileOrErr);
+        data = llvm::ArrayRef<uint8_t>((const uint8_t *)file->getBufferStart(), file->getBufferSize());
+    }
+
+    llvm::SmallVector<uint8_t, 0> decompressed;
+    if (this->uncompressedSize != 0)
+    {
+        if (llvm::Error err = llvm::compression::zlib::decompress(data, decompressed, this->uncompressedSize))
+        {
+            llvm::errs() << "Could not decompress parked code: " << llvm::toString(std::move(err)) << "\n";
+            return nullptr;
+        }
+        data = decompressed;
+    }
+
+    Block block;
+    llvm::MemoryBufferRef buffer(llvm::StringRef((const char *)data.data(), data.size()), "parked");
+    if (failed(readBytecodeFile(buffer, &block, ParserConfig(this->context))))
+    {
+        llvm::errs() << "Could not read parked code\n";
+        return nullptr;
+    }
+    Operation *op = &block.front();
+    op->remove();
+    return op;
+}
+
+void MLIRCodeIR::discardParked()
+{
+    if (!this->parkedFile.empty())
+        llvm::sys::fs::remove(this->parkedFile);
+    this->parkedFile.clear();
+    this->parkedBytecode.clear();
+    this->parkedBytecode.shrink_to_fit();
+    this->uncompressedSize = 0;
+    this->parked = false;
+}
@@ -0,0 +1,303 @@
+//===--------------------------- Metrics.cpp Metrics ----------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the MetricsRegistry class, which
+/// exposes the metrics of the search
+///
+//===----------------------------------------------------------------------===//
+#include "Metrics.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+/// Adds a metric and its description to the exposition.
+static void addMetric(std::ostringstream &out, const char *name, const char *type,
+                      const char *help, double value)
+{
+  out << "# HELP " << name << " " << help << "\n";
+  out << "# TYPE " << name << " " << type << "\n";
+  out << name << " " << value << "\n";
+}
+
+/// Returns the resident memory of the process in bytes.
+static double getResidentMemory()
+{
+  long pages = 0, residentPages = 0;
+  std::ifstream statm("/proc/self/statm");
+  if (!(statm >> pages >> residentPages))
+    return 0;
+  return (double)residentPages * sysconf(_SC_PAGESIZE);
+}
+
+/// Returns the peak resident memory of the process in bytes.
+static double getPeakResidentMemory()
+{
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+  return (double)usage.ru_maxrss * 1024;
+}
+
+MetricsRegistry::MetricsRegistry()
+{
+  this->startTime = std::chrono::steady_clock::now();
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+  this->stop();
+  // The exporter of a forked copy does not run in this process, its handle is
+  // detached since the destructor of a joinable thread terminates the process
+  if (this->exporter.joinable())
+    this->exporter.detach();
+}
+
+MetricsRegistry &MetricsRegistry::get()
+{
+  static MetricsRegistry registry;
+  return registry;
+}
+
+void MetricsRegistry::start()
+{
+  if (std::getenv("AS_METRICS_PORT") != nullptr)
+  {
+    int port = std::stoi(std::getenv("AS_METRICS_PORT"));
+    this->tcpSocket = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(this->tcpSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (this->tcpSocket < 0 || bind(this->tcpSocket, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(this->tcpSocket, 8) != 0)
+    {
+      perror("Failed to open the metrics port");
+      if (this->tcpSocket >= 0)
+        close(this->tcpSocket);
+      this->tcpSocket = -1;
+    }
+  }
+  if (std::getenv("AS_METRICS_SOCKET") != nullptr)
+  {
+    this->unixSocketPath = std::getenv("AS_METRICS_SOCKET");
+    this->unixSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, this->unixSocketPath.c_str(), sizeof(address.sun_path) - 1);
+    unlink(this->unixSocketPath.c_str());
+    if (this->unixSocket < 0 || bind(this->unixSocket, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(this->unixSocket, 8) != 0)
+    {
+      perror("Failed to open the metrics socket");
+      if (this->unixSocket >= 0)
+        close(this->unixSocket);
+      this->unixSocket = -1;
+      this->unixSocketPath.clear();
+    }
+  }
+  if (std::getenv("AS_METRICS_FILE") != nullptr)
+    this->dumpFile = std::getenv("AS_METRICS_FILE");
+  if (std::getenv("AS_METRICS_INTERVAL") != nullptr)
+    this->dumpInterval = std::max(1, std::stoi(std::getenv("AS_METRICS_INTERVAL")));
+
+  if (this->tcpSocket < 0 && this->unixSocket < 0 && this->dumpFile.empty())
+    return;
+  this->ownerPid = getpid();
+  this->exporter = std::thread([this]()
+                               { this->runExporter(); });
+}
+
+void MetricsRegistry::stop()
+{
+  if (!this->exporter.joinable() || getpid() != this->ownerPid)
+    return;
+  this->stopping = true;
+  this->exporter.join();
+  if (this->tcpSocket >= 0)
+    close(this->tcpSocket);
+  if (this->unixSocket >= 0)
+  {
+    close(this->unixSocket);
+    unlink(this->unixSocketPath.c_str());
+  }
+  this->tcpSocket = -1;
+  this->unixSocket = -1;
+  if (!this->dumpFile.empty())
+    this->writeDump();
+}
+
+void MetricsRegistry::runExporter()
+{
+  auto nextDump = std::chrono::steady_clock::now();
+  while (!this->stopping)
+  {
+    struct pollfd fds[2];
+    int numFds = 0;
+    for (int listenSocket : {this->tcpSocket, this->unixSocket})
+    {
+      if (listenSocket >= 0)
+        fds[numFds++] = {listenSocket, POLLIN, 0};
+    }
+    // The timeout bounds the latency of stop()
+    if (poll(fds, numFds, 200) > 0)
+    {
+      for (int i = 0; i < numFds; ++i)
+      {
+        if (!(fds[i].revents & POLLIN))
+          continue;
+        int client = accept(fds[i].fd, nullptr, nullptr);
+        if (client >= 0)
+          this->serveClient(client);
+      }
+    }
+    if (!this->dumpFile.empty() && std::chrono::steady_clock::now() >= nextDump)
+    {
+      this->writeDump();
+      nextDump += std::chrono::seconds(this->dumpInterval);
+    }
+  }
+}
+
+void MetricsRegistry::serveClient(int client)
+{
+  // The request is not parsed, any request gets the metrics
+  struct timeval timeout = {1, 0};
+  setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  char request[4096];
+  recv(client, request, sizeof(request), 0);
+
+  std::string body = this->render();
+  std::string response = "HTTP/1.0 200 OK\r\n"
+                         "Content-Type: text/plain; version=0.0.4\r\n"
+                         "Content-Length: " +
+                         std::to_string(body.size()) + "\r\n\r\n" + body;
+  size_t sent = 0;
+  while (sent < response.size())
+  {
+    ssize_t bytes = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+    if (bytes <= 0)
+      break;
+    sent += bytes;
+  }
+  close(client);
+}
+
+void MetricsRegistry::writeDump()
+{
+  // The dump is replaced atomically, a reader never sees a partial file
+  std::string temporaryFile = this->dumpFile + ".tmp";
+  std::ofstream out(temporaryFile);
+  if (!out.is_open())
+    return;
+  out << this->render();
+  out.close();
+  std::rename(temporaryFile.c_str(), this->dumpFile.c_str());
+}
+
+void MetricsRegistry::addGeneratedCandidate()
+{
+  this->candidatesGenerated++;
+}
+
+void MetricsRegistry::addEvaluation(double evaluation, bool isRoot, bool failed)
+{
+  this->candidatesEvaluated++;
+  if (failed)
+  {
+    this->candidatesFailed++;
+    return;
+  }
+  if (isRoot)
+    this->rootEvaluation = evaluation;
+  double incumbent = this->incumbentEvaluation;
+  while ((incumbent == 0 || evaluation < incumbent) &&
+         !this->incumbentEvaluation.compare_exchange_weak(incumbent, evaluation))
+  {
+  }
+}
+
+void MetricsRegistry::addCodeCacheLookup(bool hit)
+{
+  if (hit)
+    this->codeCacheHits++;
+  else
+    this->codeCacheMisses++;
+}
+
+void MetricsRegistry::addEvaluationCacheLookup(bool hit)
+{
+  if (hit)
+    this->evaluationCacheHits++;
+  else
+    this->evaluationCacheMisses++;
+}
+
+std::string MetricsRegistry::render()
+{
+  double uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->startTime).count();
+  double generated = this->candidatesGenerated;
+  double evaluated = this->candidatesEvaluated;
+  double failed = this->candidatesFailed;
+  double hits = this->codeCacheHits;
+  double misses = this->codeCacheMisses;
+  double evaluationHits = this->evaluationCacheHits;
+  double evaluationMisses = this->evaluationCacheMisses;
+  double root = this->rootEvaluation;
+  double incumbent = this->incumbentEvaluation;
+
+  std::ostringstream out;
+  out.precision(15);
+  addMetric(out, "as_uptime_seconds", "gauge", "Time since the start of the search.", uptime);
+  addMetric(out, "as_candidates_generated_total", "counter", "Candidates created in the search tree.", generated);
+  addMetric(out, "as_candidates_evaluated_total", "counter", "Candidates evaluated by the runner.", evaluated);
+  addMetric(out, "as_candidates_failed_total", "counter",
+            "Evaluations that failed or were rejected by the output verification.", failed);
+  addMetric(out, "as_candidates_generated_per_second", "gauge", "Candidates created per second since the start.",
+            uptime > 0 ? generated / uptime : 0);
+  addMetric(out, "as_candidates_evaluated_per_second", "gauge", "Candidates evaluated per second since the start.",
+            uptime > 0 ? evaluated / uptime : 0);
+  addMetric(out, "as_candidates_failed_per_second", "gauge", "Failed evaluations per second since the start.",
+            uptime > 0 ? failed / uptime : 0);
+  addMetric(out, "as_code_cache_hits_total", "counter",
+            "Evaluations whose code was materialized or parked.", hits);
+  addMetric(out, "as_code_cache_misses_total", "counter",
+            "Evaluations whose code was replayed from the parent code.", misses);
+  addMetric(out, "as_code_cache_hit_ratio", "gauge", "Ratio of the evaluations hitting the code cache.",
+            hits + misses > 0 ? hits / (hits + misses) : 0);
+  addMetric(out, "as_evaluation_cache_hits_total", "counter",
+            "Evaluations given the stored run of a module already run.", evaluationHits);
+  addMetric(out, "as_evaluation_cache_misses_total", "counter",
+            "Evaluations run while the evaluation cache is enabled.", evaluationMisses);
+  addMetric(out, "as_evaluation_cache_hit_ratio", "gauge", "Ratio of the evaluations hitting the evaluation cache.",
+            evaluationHits + evaluationMisses > 0 ? evaluationHits / (evaluationHits + evaluationMisses) : 0);
+  addMetric(out, "as_evaluator_queue_depth", "gauge", "Candidates created and not evaluated yet.",
+            generated > evaluated ? generated - evaluated : 0);
+  addMetric(out, "as_root_time", "gauge", "Evaluation of the root code, as reported by the runner.", root);
+  addMetric(out, "as_incumbent_time", "gauge", "Evaluation of the best candidate, as reported by the runner.",
+            incumbent);
+  addMetric(out, "as_incumbent_speedup", "gauge", "Speedup of the best candidate over the root code.",
+            incumbent > 0 && root > 0 ? root / incumbent : 0);
+  addMetric(out, "as_resident_memory_bytes", "gauge", "Resident memory of the process.", getResidentMemory());
+  addMetric(out, "as_peak_resident_memory_bytes", "gauge", "Peak resident memory of the process.",
+            getPeakResidentMemory());
+  return out.str();
+}
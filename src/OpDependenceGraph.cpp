@@ -0,0 +1,245 @@
+//===------------ OpDependenceGraph.cpp OpDependenceGraph -----------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the OpDependenceGraph class, which
+/// builds the producer-consumer DAG of the linalg operations of a module
+///
+//===----------------------------------------------------------------------===//
+#include "OpDependenceGraph.h"
+
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Transforms/RegionUtils.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SetVector.h"
+
+#include <functional>
+#include <map>
+
+using namespace mlir;
+
+mlir::Operation *getTopLevelAncestor(mlir::Operation *op)
+{
+  func::FuncOp funcOp = op->getParentOfType<func::FuncOp>();
+  if (!funcOp || funcOp.getBody().empty())
+    return op;
+  mlir::Operation *ancestor = funcOp.getBody().front().findAncestorOpInBlock(*op);
+  return ancestor ? ancestor : op;
+}
+
+OpDependenceGraph::OpDependenceGraph(mlir::Operation *prog)
+{
+  this->linalgOps = getLinalgOps(prog);
+
+  for (mlir::linalg::LinalgOp linalgOp : this->linalgOps)
+  {
+    mlir::Operation *anchor = getTopLevelAncestor(linalgOp);
+    auto it = this->anchorIndex.find(anchor);
+    if (it == this->anchorIndex.end())
+    {
+      it = this->anchorIndex.insert({anchor, (int)this->anchorOps.size()}).first;
+      this->anchorOps.push_back(anchor);
+    }
+    this->stageAnchor.push_back(it->second);
+  }
+
+  this->producers.resize(this->anchorOps.size());
+  this->consumers.resize(this->anchorOps.size());
+  for (size_t i = 0; i < this->anchorOps.size(); ++i)
+  {
+    addDependences(i);
+  }
+}
+
+/// Collects the producers of an anchor: the values it uses (directly or inside
+/// its regions) are traced back through the non linalg operations of the
+/// function body (tensor.cast, tensor.insert, calls...) up to the anchors of
+/// other linalg operations.
+void OpDependenceGraph::addDependences(int anchor)
+{
+  mlir::Operation *anchorOp = this->anchorOps[anchor];
+  mlir::Block *block = anchorOp->getBlock();
+
+  llvm::SetVector<Value> usedValues;
+  usedValues.insert(anchorOp->getOperands().begin(), anchorOp->getOperands().end());
+  getUsedValuesDefinedAbove(anchorOp->getRegions(), usedValues);
+
+  SmallVector<Value> worklist(usedValues.begin(), usedValues.end());
+  llvm::DenseSet<mlir::Operation *> visited;
+  while (!worklist.empty())
+  {
+    Value value = worklist.pop_back_val();
+    mlir::Operation *definingOp = value.getDefiningOp();
+    // Function arguments do not create dependences.
+    if (!definingOp)
+      continue;
+    mlir::Operation *producer = block->findAncestorOpInBlock(*definingOp);
+    if (!producer || producer == anchorOp || !visited.insert(producer).second)
+      continue;
+
+    auto it = this->anchorIndex.find(producer);
+    if (it != this->anchorIndex.end())
+    {
+      this->producers[anchor].insert(it->second);
+      this->consumers[it->second].insert(anchor);
+      continue;
+    }
+    llvm::SetVector<Value> producerValues;
+    producerValues.insert(producer->getOperands().begin(), producer->getOperands().end());
+    getUsedValuesDefinedAbove(producer->getRegions(), producerValues);
+    worklist.append(producerValues.begin(), producerValues.end());
+  }
+}
+
+int OpDependenceGraph::getNumStages()
+{
+  return this->linalgOps.size();
+}
+
+mlir::linalg::LinalgOp OpDependenceGraph::getOp(int stage)
+{
+  return this->linalgOps[stage];
+}
+
+mlir::Operation *OpDependenceGraph::getAnchor(int stage)
+{
+  return this->anchorOps[this->stageAnchor[stage]];
+}
+
+std::set<int> OpDependenceGraph::getProducerStages(int stage)
+{
+  std::set<int> stages;
+  const std::set<int> &producerAnchors = this->producers[this->stageAnchor[stage]];
+  for (size_t i = 0; i < this->stageAnchor.size(); ++i)
+  {
+    if (producerAnchors.count(this->stageAnchor[i]))
+      stages.insert(i);
+  }
+  return stages;
+}
+
+std::set<int> OpDependenceGraph::getConsumerStages(int stage)
+{
+  std::set<int> stages;
+  const std::set<int> &consumerAnchors = this->consumers[this->stageAnchor[stage]];
+  for (size_t i = 0; i < this->stageAnchor.size(); ++i)
+  {
+    if (consumerAnchors.count(this->stageAnchor[i]))
+      stages.insert(i);
+  }
+  return stages;
+}
+
+bool OpDependenceGraph::areDependent(int stageA, int stageB)
+{
+  int anchorA = this->stageAnchor[stageA];
+  int anchorB = this->stageAnchor[stageB];
+  if (anchorA == anchorB)
+    return true;
+
+  // Searches a path from 'from' to 'to' following the consumer edges.
+  auto reaches = [&](int from, int to)
+  {
+    std::vector<bool> visited(this->anchorOps.size(), false);
+    std::vector<int> worklist = {from};
+    while (!worklist.empty())
+    {
+      int current = worklist.back();
+      worklist.pop_back();
+      if (current == to)
+        return true;
+      if (visited[current])
+        continue;
+      visited[current] = true;
+      worklist.insert(worklist.end(), this->consumers[current].begin(), this->consumers[current].end());
+    }
+    return false;
+  };
+  return reaches(anchorA, anchorB) || reaches(anchorB, anchorA);
+}
+
+std::vector<std::vector<int>> OpDependenceGraph::getIndependentGroups()
+{
+  // Depth of each anchor: the length of the longest producer chain above it.
+  // Anchors with the same depth can not reach each other.
+  std::vector<int> depth(this->anchorOps.size(), -1);
+  std::function<int(int)> computeDepth = [&](int anchor)
+  {
+    if (depth[anchor] != -1)
+      return depth[anchor];
+    int result = 0;
+    for (int producer : this->producers[anchor])
+    {
+      result = std::max(result, computeDepth(producer) + 1);
+    }
+    depth[anchor] = result;
+    return result;
+  };
+
+  // Representative stage of each anchor, anchors containing only linalg.fill
+  // operations are too cheap to be overlapped.
+  std::vector<int> representative(this->anchorOps.size(), -1);
+  for (size_t stage = 0; stage < this->linalgOps.size(); ++stage)
+  {
+    int anchor = this->stageAnchor[stage];
+    if (representative[anchor] == -1 && !isa<linalg::FillOp>(this->linalgOps[stage]))
+      representative[anchor] = stage;
+  }
+
+  std::map<int, std::vector<int>> levels;
+  for (size_t anchor = 0; anchor < this->anchorOps.size(); ++anchor)
+  {
+    if (representative[anchor] == -1)
+      continue;
+    levels[computeDepth(anchor)].push_back(representative[anchor]);
+  }
+
+  std::vector<std::vector<int>> groups;
+  for (auto &level : levels)
+  {
+    if (level.second.size() >= 2)
+    {
+      std::sort(level.second.begin(), level.second.end());
+      groups.push_back(level.second);
+    }
+  }
+  return groups;
+}
+
+int64_t OpDependenceGraph::estimateWork(int stage)
+{
+  mlir::linalg::LinalgOp linalgOp = this->linalgOps[stage];
+  int64_t work = 1;
+  for (int64_t size : linalgOp.getStaticLoopRanges())
+  {
+    if (!ShapedType::isDynamic(size))
+      work *= size;
+  }
+
+  // A tiled operation only computes one tile, multiply by the trip counts of
+  // the loops created by the tiling.
+  mlir::Operation *anchor = getAnchor(stage);
+  for (mlir::Operation *parent = linalgOp->getParentOp(); parent && parent != anchor->getParentOp();
+       parent = parent->getParentOp())
+  {
+    if (auto forallOp = dyn_cast<scf::ForallOp>(parent))
+    {
+      for (auto [lb, ub, step] : llvm::zip(forallOp.getMixedLowerBound(),
+                                           forallOp.getMixedUpperBound(),
+                                           forallOp.getMixedStep()))
+      {
+        if (std::optional<int64_t> tripCount = constantTripCount(lb, ub, step))
+          work *= *tripCount;
+      }
+    }
+    else if (auto forOp = dyn_cast<scf::ForOp>(parent))
+    {
+      if (std::optional<int64_t> tripCount = constantTripCount(forOp.getLowerBound(),
+                                                               forOp.getUpperBound(),
+                                                               forOp.getStep()))
+        work *= *tripCount;
+    }
+  }
+  return work;
+}
@@ -0,0 +1,141 @@
+//===------------------------ OpIdentity.cpp OpIdentity -------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the stable identifiers of the linalg
+/// operations and of the OpIdentityIndex class
+///
+//===----------------------------------------------------------------------===//
+#include "OpIdentity.h"
+
+#include "mlir/IR/Builders.h"
+
+#include <atomic>
+#include <memory>
+
+using namespace mlir;
+
+/// Index of the last code looked up by the thread (the worker contexts apply
+/// transformations in parallel), with the generation it was built in.
+static thread_local std::unique_ptr<OpIdentityIndex> lastIndex;
+static thread_local uint64_t lastGeneration = 0;
+
+/// Generation of the indexes, incremented by each invalidation: a code erased by
+/// another thread invalidates the index of every thread, so that a new code
+/// allocated at the address of the indexed one is indexed again.
+static std::atomic<uint64_t> indexGeneration{0};
+
+/// Returns the number of ancestors of the operation.
+static unsigned getDepth(Operation *op)
+{
+  unsigned depth = 0;
+  for (Operation *parent = op->getParentOp(); parent != nullptr; parent = parent->getParentOp())
+    depth++;
+  return depth;
+}
+
+void assignOpIds(Operation *root)
+{
+  int64_t nextId = 0;
+  root->walk([&](linalg::LinalgOp op)
+             { nextId = std::max(nextId, getOpId(op) + 1); });
+
+  Builder builder(root->getContext());
+  for (linalg::LinalgOp op : getLinalgOps(root))
+  {
+    if (getOpId(op) < 0)
+      op->setAttr(kOpIdAttrName, builder.getI64IntegerAttr(nextId++));
+  }
+}
+
+int64_t getOpId(Operation *op)
+{
+  if (auto idAttr = op->getAttrOfType<IntegerAttr>(kOpIdAttrName))
+    return idAttr.getInt();
+  return -1;
+}
+
+void setOpId(Operation *op, int64_t id)
+{
+  if (id < 0)
+    return;
+  op->setAttr(kOpIdAttrName, Builder(op->getContext()).getI64IntegerAttr(id));
+}
+
+OpIdentityIndex::OpIdentityIndex(Operation *root)
+{
+  this->root = root;
+  update(root);
+}
+
+Operation *OpIdentityIndex::getRoot()
+{
+  return this->root;
+}
+
+void OpIdentityIndex::update(Operation *op)
+{
+  unsigned baseDepth = getDepth(op);
+  op->walk([&](Operation *nested)
+           {
+    int64_t id = getOpId(nested);
+    if (id < 0)
+      return;
+    unsigned depth = baseDepth;
+    for (Operation *parent = nested; parent != op; parent = parent->getParentOp())
+      depth++;
+    auto it = ops.find(id);
+    if (it == ops.end() || depth < it->second.second)
+      ops[id] = {nested, depth}; });
+}
+
+void OpIdentityIndex::erase(Operation *op)
+{
+  op->walk([&](Operation *nested)
+           {
+    auto it = ops.find(getOpId(nested));
+    if (it != ops.end() && it->second.first == nested)
+      ops.erase(it); });
+}
+
+Operation *OpIdentityIndex::lookup(int64_t id)
+{
+  auto it = ops.find(id);
+  if (it == ops.end())
+    return nullptr;
+  return it->second.first;
+}
+
+Operation *OpIdentityIndex::lookup(int64_t id, int stage)
+{
+  if (Operation *op = lookup(id))
+    return op;
+  SmallVector<linalg::LinalgOp, 4> linalgOps = getLinalgOps(this->root);
+  if (stage < 0 || stage >= (int)linalgOps.size())
+    return nullptr;
+  return linalgOps[stage];
+}
+
+OpIdentityIndex &getOpIdentityIndex(Operation *root)
+{
+  uint64_t generation = indexGeneration.load();
+  if (!lastIndex || lastIndex->getRoot() != root || lastGeneration != generation)
+  {
+    lastIndex = std::make_unique<OpIdentityIndex>(root);
+    lastGeneration = generation;
+  }
+  return *lastIndex;
+}
+
+void invalidateOpIdentityIndex(Operation *root)
+{
+  indexGeneration++;
+  if (lastIndex && lastIndex->getRoot() == root)
+    lastIndex.reset();
+}
+
+Operation *findStageOp(Operation *root, int64_t id, int stage)
+{
+  return getOpIdentityIndex(root).lookup(id, stage);
+}
@@ -0,0 +1,242 @@
+//===------------ OutputVerification.cpp OutputVerification ---------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the output verification functions
+///
+//===----------------------------------------------------------------------===//
+#include "OutputVerification.h"
+#include "OpIdentity.h"
+
+#include <cmath>
+#include <regex>
+
+using namespace mlir;
+
+/// Declares the runtime function if the module does not declare it yet.
+static void declareRuntimeFunction(ModuleOp module, StringRef name, FunctionType type)
+{
+  if (module.lookupSymbol(name))
+    return;
+  OpBuilder builder(module.getBodyRegion());
+  auto funcOp = builder.create<func::FuncOp>(module.getLoc(), name, type);
+  funcOp.setPrivate();
+}
+
+/// Converts a scalar of the element type of the output to f64.
+static Value convertToF64(OpBuilder &builder, Location loc, Value value)
+{
+  Type f64Type = builder.getF64Type();
+  Type type = value.getType();
+  if (type == f64Type)
+    return value;
+  if (auto floatType = dyn_cast<FloatType>(type))
+  {
+    if (floatType.getWidth() < 64)
+      return builder.create<arith::ExtFOp>(loc, f64Type, value);
+    return builder.create<arith::TruncFOp>(loc, f64Type, value);
+  }
+  return builder.create<arith::SIToFPOp>(loc, f64Type, value);
+}
+
+bool instrumentOutputChecksum(mlir::Operation *op)
+{
+  ModuleOp module = dyn_cast<ModuleOp>(op);
+  if (!module)
+    return false;
+  func::FuncOp mainFunc = module.lookupSymbol<func::FuncOp>("main");
+  if (!mainFunc || mainFunc.isExternal())
+    return false;
+
+  // The output is the last ranked tensor returned by a call to a function
+  // defined in the module.
+  func::CallOp kernelCall;
+  Value output;
+  mainFunc.walk([&](func::CallOp callOp)
+                {
+    auto callee = module.lookupSymbol<func::FuncOp>(callOp.getCallee());
+    if (!callee || callee.isExternal())
+      return;
+    for (Value result : callOp.getResults())
+    {
+      auto tensorType = dyn_cast<RankedTensorType>(result.getType());
+      if (tensorType && tensorType.getElementType().isIntOrFloat())
+      {
+        kernelCall = callOp;
+        output = result;
+      }
+    } });
+  if (!kernelCall)
+    return false;
+
+  // The checksum is computed after the time measurement.
+  Operation *insertionPoint = kernelCall;
+  mainFunc.walk([&](func::CallOp callOp)
+                {
+    if (callOp.getCallee() == "printFlops" && callOp->getBlock() == kernelCall->getBlock() &&
+        kernelCall->isBeforeInBlock(callOp))
+      insertionPoint = callOp; });
+
+  MLIRContext *ctx = module.getContext();
+  Location loc = kernelCall.getLoc();
+  OpBuilder builder(ctx);
+  builder.setInsertionPointAfter(insertionPoint);
+
+  auto tensorType = cast<RankedTensorType>(output.getType());
+  int64_t rank = tensorType.getRank();
+  Type f64Type = builder.getF64Type();
+
+  Value zero = builder.create<arith::ConstantOp>(loc, builder.getF64FloatAttr(0.0));
+  Value init = builder.create<tensor::EmptyOp>(loc, ArrayRef<int64_t>{}, f64Type);
+  Value acc = builder.create<linalg::FillOp>(loc, zero, init).getResult(0);
+
+  SmallVector<AffineMap> indexingMaps = {builder.getMultiDimIdentityMap(rank),
+                                         AffineMap::get(rank, 0, ctx)};
+  SmallVector<utils::IteratorType> iteratorTypes(rank, utils::IteratorType::reduction);
+  auto checksumOp = builder.create<linalg::GenericOp>(
+      loc, TypeRange{acc.getType()}, ValueRange{output}, ValueRange{acc},
+      indexingMaps, iteratorTypes,
+      [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args)
+      {
+        // weight = 1 + (sum_d (d + 1) * index_d) mod 13, so that a permutation
+        // of the output changes the checksum.
+        Value linearIndex = nestedBuilder.create<arith::ConstantIndexOp>(nestedLoc, 0);
+        for (int64_t dim = 0; dim < rank; ++dim)
+        {
+          Value index = nestedBuilder.create<linalg::IndexOp>(nestedLoc, dim);
+          Value factor = nestedBuilder.create<arith::ConstantIndexOp>(nestedLoc, dim + 1);
+          Value term = nestedBuilder.create<arith::MulIOp>(nestedLoc, index, factor);
+          linearIndex = nestedBuilder.create<arith::AddIOp>(nestedLoc, linearIndex, term);
+        }
+        Value modulo = nestedBuilder.create<arith::ConstantIndexOp>(nestedLoc, 13);
+        Value one = nestedBuilder.create<arith::ConstantIndexOp>(nestedLoc, 1);
+        Value weight = nestedBuilder.create<arith::RemUIOp>(nestedLoc, linearIndex, modulo);
+        weight = nestedBuilder.create<arith::AddIOp>(nestedLoc, weight, one);
+        weight = nestedBuilder.create<arith::IndexCastOp>(nestedLoc, nestedBuilder.getI64Type(), weight);
+        weight = nestedBuilder.create<arith::SIToFPOp>(nestedLoc, f64Type, weight);
+
+        Value value = convertToF64(nestedBuilder, nestedLoc, args[0]);
+        Value weighted = nestedBuilder.create<arith::MulFOp>(nestedLoc, value, weight);
+        Value sum = nestedBuilder.create<arith::AddFOp>(nestedLoc, args[1], weighted);
+        nestedBuilder.create<linalg::YieldOp>(nestedLoc, sum);
+      });
+  Value checksum = builder.create<tensor::ExtractOp>(loc, checksumOp.getResult(0), ValueRange{});
+
+  FunctionType voidType = builder.getFunctionType({}, {});
+  declareRuntimeFunction(module, "printOpen", voidType);
+  declareRuntimeFunction(module, "printClose", voidType);
+  declareRuntimeFunction(module, "printNewline", voidType);
+  declareRuntimeFunction(module, "printF64", builder.getFunctionType({f64Type}, {}));
+
+  builder.create<func::CallOp>(loc, "printOpen", TypeRange{}, ValueRange{});
+  builder.create<func::CallOp>(loc, "printF64", TypeRange{}, ValueRange{checksum});
+  builder.create<func::CallOp>(loc, "printClose", TypeRange{}, ValueRange{});
+  builder.create<func::CallOp>(loc, "printNewline", TypeRange{}, ValueRange{});
+  return true;
+}
+
+/// Returns true if the value is an input (not an init) of a linalg operation.
+static bool isLinalgInput(Value value)
+{
+  for (OpOperand &use : value.getUses())
+  {
+    auto linalgOp = dyn_cast<linalg::LinalgOp>(use.getOwner());
+    if (linalgOp && linalgOp.isDpsInput(&use))
+      return true;
+  }
+  return false;
+}
+
+int fillInputsWithPattern(mlir::Operation *op)
+{
+  SmallVector<linalg::FillOp> fillOps;
+  op->walk([&](linalg::FillOp fillOp)
+           {
+    if (fillOp->getNumResults() == 1 && isLinalgInput(fillOp->getResult(0)) &&
+        getElementTypeOrSelf(fillOp->getResult(0).getType()).isIntOrFloat())
+      fillOps.push_back(fillOp); });
+
+  for (linalg::FillOp fillOp : fillOps)
+  {
+    OpBuilder builder(fillOp);
+    Location loc = fillOp.getLoc();
+    Value init = fillOp.getOutputs()[0];
+    auto tensorType = cast<RankedTensorType>(init.getType());
+    Type elementType = tensorType.getElementType();
+    int64_t rank = tensorType.getRank();
+
+    SmallVector<AffineMap> indexingMaps = {builder.getMultiDimIdentityMap(rank)};
+    SmallVector<utils::IteratorType> iteratorTypes(rank, utils::IteratorType::parallel);
+    auto patternOp = builder.create<linalg::GenericOp>(
+        loc, TypeRange{tensorType}, ValueRange{}, ValueRange{init}, indexingMaps, iteratorTypes,
+        [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args)
+        {
+          // value = 1 + (hash(sum_d p_d * index_d) >> 16) mod 16, small integers
+          // the kernels compute exactly
+          static const int64_t primes[] = {7919, 104729, 1299709, 15485863};
+          Type i64Type = nestedBuilder.getI64Type();
+          Value linearIndex = nestedBuilder.create<arith::ConstantIntOp>(nestedLoc, 0, i64Type);
+          for (int64_t dim = 0; dim < rank; ++dim)
+          {
+            Value index = nestedBuilder.create<linalg::IndexOp>(nestedLoc, dim);
+            index = nestedBuilder.create<arith::IndexCastOp>(nestedLoc, i64Type, index);
+            Value prime = nestedBuilder.create<arith::ConstantIntOp>(nestedLoc, primes[dim % 4], i64Type);
+            Value term = nestedBuilder.create<arith::MulIOp>(nestedLoc, index, prime);
+            linearIndex = nestedBuilder.create<arith::AddIOp>(nestedLoc, linearIndex, term);
+          }
+          Value multiplier = nestedBuilder.create<arith::ConstantIntOp>(nestedLoc, 2654435761, i64Type);
+          Value shift = nestedBuilder.create<arith::ConstantIntOp>(nestedLoc, 16, i64Type);
+          Value mask = nestedBuilder.create<arith::ConstantIntOp>(nestedLoc, 15, i64Type);
+          Value one = nestedBuilder.create<arith::ConstantIntOp>(nestedLoc, 1, i64Type);
+          Value hash = nestedBuilder.create<arith::MulIOp>(nestedLoc, linearIndex, multiplier);
+          hash = nestedBuilder.create<arith::ShRUIOp>(nestedLoc, hash, shift);
+          hash = nestedBuilder.create<arith::AndIOp>(nestedLoc, hash, mask);
+          Value value = nestedBuilder.create<arith::AddIOp>(nestedLoc, hash, one);
+
+          if (isa<FloatType>(elementType))
+            value = nestedBuilder.create<arith::SIToFPOp>(nestedLoc, elementType, value);
+          else if (elementType.getIntOrFloatBitWidth() < 64)
+            value = nestedBuilder.create<arith::TruncIOp>(nestedLoc, elementType, value);
+          nestedBuilder.create<linalg::YieldOp>(nestedLoc, value);
+        });
+    // The schedules replayed on the code find the operation by its identifier
+    setOpId(patternOp, getOpId(fillOp));
+    fillOp->replaceAllUsesWith(patternOp->getResults());
+    fillOp->erase();
+  }
+  return fillOps.size();
+}
+
+std::optional<double> parseOutputChecksum(const std::string &output)
+{
+  static const std::regex checksumRegex("\\( ([-+0-9.eEinfa]+) \\)");
+  std::optional<double> checksum;
+  for (auto it = std::sregex_iterator(output.begin(), output.end(), checksumRegex);
+       it != std::sregex_iterator(); ++it)
+  {
+    try
+    {
+      checksum = std::stod((*it)[1].str());
+    }
+    catch (const std::exception &)
+    {
+    }
+  }
+  return checksum;
+}
+
+bool isWithinTolerance(double reference, double value, double tolerance)
+{
+  if (std::isnan(reference) || std::isnan(value))
+    return false;
+  double scale = std::max(1.0, std::fabs(reference));
+  return std::fabs(reference - value) <= tolerance * scale;
+}
+
+double getVerificationTolerance()
+{
+  if (std::getenv("AS_VERIFY_TOLERANCE") != nullptr)
+    return std::stod(std::getenv("AS_VERIFY_TOLERANCE"));
+  return 1e-3;
+}
@@ -42,7 +42,7 @@ static LogicalResult fuseLinalgOpsGreedily(Operation *f)
 
   // Save original Linalg ops, we only want to make a pass over those.
   SmallVector<LinalgOp, 8> linalgOps;
-  std::cout << "HERE\n";
+  AS_LOG(LogLevel::Debug, "HERE");
 
   f->walk([&](LinalgOp op)
           {
@@ -62,7 +62,7 @@ static LogicalResult fuseLinalgOpsGreedily(Operation *f)
 
       if (isa<MemRefType>(opOperand.get().getType()))
       {
-        std::cout << "TYPE\n";
+        AS_LOG(LogLevel::Debug, "TYPE");
         continue;
       }
 
@@ -72,7 +72,7 @@ static LogicalResult fuseLinalgOpsGreedily(Operation *f)
 
         if (opOperand.getOperandNumber() >= linalgOp.getNumDpsInputs())
         {
-          std::cout << "NOT INPUT\n";
+          AS_LOG(LogLevel::Debug, "NOT INPUT");
           continue;
         }
 
@@ -302,6 +302,16 @@ void Parallelization::setOperationStage(int stage)
   this->OperationStage = stage;
 }
 
+int64_t Parallelization::getTargetOpId()
+{
+  return this->targetOpId;
+}
+
+void Parallelization::setTargetOpId(int64_t id)
+{
+  this->targetOpId = id;
+}
+
 llvm::SmallVector<int64_t, 4> Parallelization::getTileSizes()
 {
   return this->tileSizes;
@@ -330,6 +340,62 @@ std::string Parallelization::printTransformation()
 }
 void Parallelization::applyTransformation(CodeIR CodeIr)
 {
+  llvm::TimeTraceScope traceScope("Apply transformation", [&]()
+                                { return this->printTransformation(); });
+  Operation *ClonedTarget = ((Operation *)CodeIr.getIr());
+  MLIRContext *context = ClonedTarget->getContext();
+  int CurrentStage = this->OperationStage;
+
+  mlir::Operation *linalgOp = findStageOp(ClonedTarget, this->targetOpId, CurrentStage);
+
+  if (mlir::TilingInterface ClonedTileableOp = dyn_cast_or_null<mlir::TilingInterface>(linalgOp))
+  {
+    SmallVector<mlir::Operation *, 2> producers;
+    ClonedTarget->walk([&](mlir::Operation *op)
+                       {
+                  if (auto linalgOp = dyn_cast<linalg::LinalgOp>(op))
+                  {
+                        producers.push_back(op);
+                  } });
+    std::reverse(producers.begin(), producers.end());
+
+    IRRewriter rewriter(context);
+    OpBuilder builder(context);
+
+    std::optional<ArrayAttr> mapping;
+    SmallVector<OpFoldResult, 4> opFoldResults;
+    for (int64_t value : this->tileSizes)
+    {
+      opFoldResults.push_back(builder.getIndexAttr(value));
+    }
+    rewriter.setInsertionPoint(ClonedTileableOp);
+    ArrayRef<OpFoldResult> tileSizes = llvm::makeArrayRef(opFoldResults);
+    FailureOr<linalg::ForallTilingResult> tilingResult =
+        linalg::tileToForallOpUsingTileSizes(rewriter, ClonedTileableOp, tileSizes, mapping);
+    if (failed(tilingResult))
+      return;
+    rewriter.replaceOp(ClonedTileableOp, tilingResult->tileOp->getResults());
+
+    std::string consumerTag = "consumer" + std::to_string(CurrentStage);
+    TagSCFForAll(tilingResult->tileOp->getParentOp(), consumerTag);
+    FuseOps(ClonedTarget, producers, consumerTag, 1);
+  }
+  mlir::PassManager pm((ClonedTarget)->getName());
+
+  // Apply any generic pass manager command line options and run the pipeline.
+  applyPassManagerCLOptions(pm);
+
+  pm.addPass(mlir::createLoopInvariantCodeMotionPass());
+  pm.addPass(mlir::createCSEPass());
+  pm.addPass(mlir::createCanonicalizerPass());
+  pm.addPass(mlir::createCSEPass());
+
+  pm.addPass(mlir::bufferization::createEmptyTensorEliminationPass());
+  pm.addPass(mlir::bufferization::createEmptyTensorToAllocTensorPass());
+
+  // The fusion and the passes rewrite the operations of the whole code
+  invalidateOpIdentityIndex(ClonedTarget);
+  (void)pm.run(ClonedTarget);
 }
 
 SmallVector<Node *, 2> Parallelization::createParallelizationCandidates(Node *node,
@@ -337,6 +403,7 @@ SmallVector<Node *, 2> Parallelization::createParallelizationCandidates(Node *no
                                                                         int CurrentStage,
                                                                         SmallVector<mlir::linalg::LinalgOp, 4> LinalgOpStages)
 {
+  llvm::TimeTraceScope traceScope("Generate candidates", "Parallelization");
   // Set the maximum number of loops for parallelization (commented out)
   // int64_t maxNumberLoops = 4;
 
@@ -410,20 +477,24 @@ SmallVector<Node *, 2> Parallelization::createParallelizationCandidates(Node *no
         std::back_inserter(SelectedTileCombinations),
         1,
         std::mt19937{std::random_device{}()});*/
+    // The candidates are recipes: the code is only created (by replaying the
+    // transformation on a clone of the parent code) when it is evaluated.
+    // The fusion moves all the producers of the operation in the forall loop.
+    int StageIncrement = getLinalgOps(target).size();
     for (const auto &candidate : tileCombinations)
     {
-
-      MLIRCodeIR *ClonedCode = (MLIRCodeIR *)CodeIr->cloneIr();
-      Node *ChildNode = new Node(ClonedCode, node->getCurrentStage());
-
-      std::vector<Transformation *> TransList = node->getTransformationList();
-      ChildNode->setTransformationList(TransList);
-
       Parallelization *parallelization =
-          new Parallelization(&tileableOp,
+          SearchTreeArena::get().createTransformation<Parallelization>(&tileableOp,
                               CurrentStage,
                               candidate,
                               context);
+      parallelization->setTargetOpId(getOpId(op));
+
+      MLIRCodeIR *ChildCode = new MLIRCodeIR(CodeIr, parallelization);
+      Node *ChildNode = SearchTreeArena::get().createNode(ChildCode, node->getCurrentStage() + StageIncrement);
+
+      std::vector<Transformation *> TransList = node->getTransformationList();
+      ChildNode->setTransformationList(TransList);
 
       ChildNode->setTransformation(parallelization);
 
@@ -433,132 +504,6 @@ SmallVector<Node *, 2> Parallelization::createParallelizationCandidates(Node *no
     }
     // ChildNodesList.push_back(ChildNodes);
   } //} });
-  int OpIndex = 0;
-  // for (auto ChildNodes : ChildNodesList)
-  //{
-  for (auto node : ChildNodes)
-  {
-    Operation *ClonedTarget = ((Operation *)(*((MLIRCodeIR *)node->getTransformedCodeIr()))
-                                   .getIr());
-    Parallelization *parallelization = (Parallelization *)node->getTransformation();
-
-    SmallVector<mlir::linalg::LinalgOp, 4> linalgOps = getLinalgOps(ClonedTarget);
-
-    // Tile and Fuse for tensors inputs (TODO: all tensor operands).
-    bool changed = false;
-    mlir::Operation *linalgOp = linalgOps[CurrentStage];
-
-    // if(ClonedOpIndex==2){
-    if (mlir::TilingInterface ClonedTileableOp = dyn_cast<mlir::TilingInterface>(linalgOp))
-    {
-
-      SmallVector<mlir::Operation *, 2> producers;
-      ClonedTarget->walk([&](mlir::Operation *op)
-                         {
-                 // TODO: support multi-results.
-                //if ((op->getName().getStringRef()).str() != "linalg.fill"){
-                  if (auto linalgOp = dyn_cast<linalg::LinalgOp>(op))
-                  {
-                        producers.push_back(op);
-                  //} 
-                  } });
-      std::reverse(producers.begin(), producers.end());
-
-      IRRewriter rewriter(context);
-      OpBuilder builder(context);
-
-      std::optional<ArrayAttr> mapping;
-      SmallVector<OpFoldResult, 4> opFoldResults;
-      for (int64_t value : parallelization->getTileSizes())
-      {
-        opFoldResults.push_back(builder.getIndexAttr(value));
-      }
-      rewriter.setInsertionPoint(ClonedTileableOp);
-      ArrayRef<OpFoldResult> tileSizes = llvm::makeArrayRef(opFoldResults);
-      FailureOr<linalg::ForallTilingResult> tilingResult =
-          linalg::tileToForallOpUsingTileSizes(rewriter, ClonedTileableOp, tileSizes, mapping);
-      if (!failed(tilingResult))
-        rewriter.replaceOp(ClonedTileableOp, tilingResult->tileOp->getResults());
-
-      // IRRewriter rewriter1(context);
-      std::string consumerTag = "consumer" + CurrentStage;
-      TagSCFForAll(tilingResult->tileOp->getParentOp(), consumerTag);
-      FuseOps(ClonedTarget, producers, consumerTag, 1);
-
-      node->setCurrentStage(node->getCurrentStage() + producers.size());
-      // FuseIntoContainingOperation(tilingResult->tileOp, ClonedTarget, rewriter1);
-    }
-    mlir::PassManager pm((ClonedTarget)->getName());
-
-    // Apply any generic pass manager command line options and run the pipeline.
-    applyPassManagerCLOptions(pm);
-
-    pm.addPass(mlir::createLoopInvariantCodeMotionPass());
-    pm.addPass(mlir::createCSEPass());
-    pm.addPass(mlir::createCanonicalizerPass());
-    pm.addPass(mlir::createCSEPass());
-
-    pm.addPass(mlir::bufferization::createEmptyTensorEliminationPass());
-    pm.addPass(mlir::bufferization::createEmptyTensorToAllocTensorPass());
-
-    if (!mlir::failed(pm.run((ClonedTarget))))
-      int ClonedOpIndex = 0;
-    /*ClonedTarget->walk([&](Operation *op)
-                       {
-
-      if (mlir::TilingInterface ClonedTileableOp
-                        = dyn_cast<mlir::TilingInterface>(op)) {
-   if ((op->getName().getStringRef()).str() == "linalg.matmul"){
-          ClonedOpIndex++;
-        }
-
-//if(ClonedOpIndex==2){
-          if ((op->getName().getStringRef()).str() != "linalg.fill" ){
-
-            IRRewriter rewriter(context);
-            OpBuilder builder(context);
-
-            std::optional<ArrayAttr> mapping;
-            SmallVector<OpFoldResult, 4> opFoldResults;
-            for (int64_t value : parallelization->getTileSizes()) {
-                  opFoldResults.push_back(builder.getIndexAttr(value));
-            }
-            rewriter.setInsertionPoint(ClonedTileableOp);
-            ArrayRef<OpFoldResult> tileSizes =  llvm::makeArrayRef(opFoldResults);
-            FailureOr<linalg::ForallTilingResult> tilingResult =
-                       linalg::tileToForallOpUsingTileSizes(rewriter,ClonedTileableOp,tileSizes,mapping);
-            if (!failed(tilingResult))
-                rewriter.replaceOp(ClonedTileableOp, tilingResult->tileOp->getResults());
-
-            IRRewriter rewriter1(context);
-
-             /*PassManager pm((ClonedTarget)->getName());
-            mlir::OpPassManager &optPM = pm.nest<mlir::func::FuncOp>();
-          optPM.addPass(std::make_unique<TestLinalgGreedyFusion>());
-          if (failed(pm.run(ClonedTarget))){}
-          /*RewritePatternSet patterns =
-              linalg::getLinalgTilingCanonicalizationPatterns(context);
-          patterns.add<ExtractSliceOfPadTensorSwapPattern>(context);
-          scf::populateSCFForLoopCanonicalizationPatterns(patterns);
-          FrozenRewritePatternSet frozenPatterns(std::move(patterns));
-          PassManager pm((ClonedTarget)->getName());
-          pm.addPass(mlir::createLoopInvariantCodeMotionPass());
-          pm.addPass(mlir::createCanonicalizerPass());
-          pm.addPass(mlir::createCSEPass());
-          do {
-            (void)applyPatternsAndFoldGreedily(ClonedTarget, frozenPatterns);
-           if (failed(pm.run(ClonedTarget)))
-              {}
-          } while (succeeded(fuseLinalgOpsGreedily(ClonedTarget)));*/
-    /*FuseIntoContainingOperation(tilingResult->tileOp, ClonedTarget, rewriter1);
-
-}
-
-//}
-
-}
-});*/
-  }
   // OpIndex++;
   // }
 
@@ -0,0 +1,230 @@
+//===------------------------- PassTiming.cpp PassTiming ------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the PassTiming class, which measures
+/// the passes lowering the candidates
+///
+//===----------------------------------------------------------------------===//
+#include "PassTiming.h"
+
+#include "mlir/Pass/PassInstrumentation.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+
+/// Returns the string as a quoted CSV field.
+static std::string quoteCsv(llvm::StringRef value)
+{
+  std::string quoted = "\"";
+  for (char c : value)
+  {
+    if (c == '"')
+      quoted += "\"\"";
+    else if (c == '\n')
+      quoted += ' ';
+    else
+      quoted += c;
+  }
+  return quoted + "\"";
+}
+
+/// Returns true if the statistics of the passes are counted. The check is made
+/// at runtime: LLVM_ENABLE_STATS follows the NDEBUG of this file, not the build
+/// of LLVM (the release builds do not count the statistics).
+static bool arePassStatisticsEnabled()
+{
+  return llvm::AreStatisticsEnabled();
+}
+
+/// Measures the wall time and the statistics of each run of a pass.
+class PassTimingInstrumentation : public mlir::PassInstrumentation
+{
+private:
+  struct Start
+  {
+    std::chrono::steady_clock::time_point time;
+    llvm::SmallVector<uint64_t, 4> statistics;
+  };
+
+  PassTiming &timing;
+  std::mutex mutex;
+  llvm::DenseMap<std::pair<mlir::Pass *, mlir::Operation *>, Start> starts;
+
+  void endRun(mlir::Pass *pass, mlir::Operation *op)
+  {
+    auto end = std::chrono::steady_clock::now();
+    Start start;
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      auto it = this->starts.find({pass, op});
+      if (it == this->starts.end())
+        return;
+      start = std::move(it->second);
+      this->starts.erase(it);
+    }
+    // The statistics of a pass accumulate over its runs, the run adds the
+    // difference
+    llvm::SmallVector<std::pair<std::string, uint64_t>, 4> statistics;
+    llvm::ArrayRef<mlir::Pass::Statistic *> passStatistics = pass->getStatistics();
+    for (size_t i = 0; i < passStatistics.size() && i < start.statistics.size(); ++i)
+      statistics.push_back({passStatistics[i]->ArgStr.str(),
+                            passStatistics[i]->getValue() - start.statistics[i]});
+    double microseconds = std::chrono::duration<double, std::micro>(end - start.time).count();
+    this->timing.addRun(pass->getName(), microseconds, statistics);
+  }
+
+public:
+  PassTimingInstrumentation(PassTiming &timing) : timing(timing) {}
+
+  void runBeforePass(mlir::Pass *pass, mlir::Operation *op) override
+  {
+    Start start;
+    for (mlir::Pass::Statistic *statistic : pass->getStatistics())
+      start.statistics.push_back(statistic->getValue());
+    start.time = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->starts[{pass, op}] = std::move(start);
+  }
+  void runAfterPass(mlir::Pass *pass, mlir::Operation *op) override
+  {
+    this->endRun(pass, op);
+  }
+  void runAfterPassFailed(mlir::Pass *pass, mlir::Operation *op) override
+  {
+    this->endRun(pass, op);
+  }
+};
+
+PassTiming::PassTiming()
+{
+  if (std::getenv("AS_PASS_TIMING") == nullptr)
+    return;
+  this->csvFile = std::getenv("AS_PASS_TIMING");
+  if (this->csvFile.empty())
+    return;
+  this->csv.open(this->csvFile);
+  if (!this->csv.is_open())
+  {
+    AS_LOG(LogLevel::Error, "Could not open the pass timing file " << this->csvFile);
+    this->csvFile.clear();
+    return;
+  }
+  this->csv << "candidate,schedule,lowered,pass,runs,wall_us,statistic,value\n";
+  // The statistics are counted without being printed at the exit
+  llvm::EnableStatistics(/*DoPrintOnExit=*/false);
+  if (!arePassStatisticsEnabled())
+    AS_LOG(LogLevel::Warning, "The statistics of LLVM are disabled, the pass timing has no statistics");
+}
+
+PassTiming &PassTiming::get()
+{
+  static PassTiming timing;
+  return timing;
+}
+
+bool PassTiming::isEnabled()
+{
+  return !this->csvFile.empty();
+}
+
+void PassTiming::instrument(mlir::PassManager &pm)
+{
+  if (!this->isEnabled())
+    return;
+  pm.addInstrumentation(std::make_unique<PassTimingInstrumentation>(*this));
+}
+
+void PassTiming::addRun(llvm::StringRef name, double microseconds,
+                        llvm::ArrayRef<std::pair<std::string, uint64_t>> statistics)
+{
+  if (!this->isEnabled())
+    return;
+  std::lock_guard<std::mutex> lock(this->mutex);
+  PassRecord &record = this->current[name.str()];
+  record.runs++;
+  record.wallMicroseconds += microseconds;
+  for (const auto &statistic : statistics)
+    record.statistics[statistic.first] += statistic.second;
+}
+
+void PassTiming::recordCandidate(const std::string &schedule, bool lowered)
+{
+  if (!this->isEnabled())
+    return;
+  std::lock_guard<std::mutex> lock(this->mutex);
+  int candidate = this->numCandidates++;
+  std::string prefix = std::to_string(candidate) + "," + quoteCsv(schedule) + "," + (lowered ? "1" : "0") + ",";
+  for (auto &entry : this->current)
+  {
+    const PassRecord &record = entry.second;
+    // The statistics are written on their own rows, the first row of the pass
+    // has its time
+    std::string passPrefix = prefix + quoteCsv(entry.first) + ",";
+    this->csv << passPrefix << record.runs << "," << std::fixed << std::setprecision(1)
+              << record.wallMicroseconds << ",,\n";
+    for (const auto &statistic : record.statistics)
+      this->csv << passPrefix << ",," << quoteCsv(statistic.first) << "," << statistic.second << "\n";
+
+    PassRecord &total = this->summary[entry.first];
+    total.runs += record.runs;
+    total.wallMicroseconds += record.wallMicroseconds;
+    total.maxMicroseconds = std::max(total.maxMicroseconds, record.wallMicroseconds);
+    total.candidates++;
+    for (const auto &statistic : record.statistics)
+      total.statistics[statistic.first] += statistic.second;
+  }
+  this->current.clear();
+}
+
+void PassTiming::writeSummary()
+{
+  if (!this->isEnabled())
+    return;
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->csv.close();
+
+  // The time of a pipeline collection (a nested pass manager) is the time of
+  // its passes, it is not counted twice in the total
+  double totalMicroseconds = 0;
+  for (auto &entry : this->summary)
+  {
+    if (!llvm::StringRef(entry.first).starts_with("Pipeline Collection"))
+      totalMicroseconds += entry.second.wallMicroseconds;
+  }
+
+  std::ofstream out(this->csvFile + ".summary.csv");
+  out << "pass,candidates,runs,total_us,mean_us,max_us,share,statistic,value\n";
+  std::vector<std::pair<double, std::string>> ranking;
+  for (auto &entry : this->summary)
+  {
+    const PassRecord &record = entry.second;
+    double mean = record.candidates > 0 ? record.wallMicroseconds / record.candidates : 0;
+    double share = totalMicroseconds > 0 ? record.wallMicroseconds / totalMicroseconds : 0;
+    out << quoteCsv(entry.first) << "," << record.candidates << "," << record.runs << ","
+        << std::fixed << std::setprecision(1) << record.wallMicroseconds << "," << mean << ","
+        << record.maxMicroseconds << "," << std::setprecision(4) << share << ",,\n";
+    for (const auto &statistic : record.statistics)
+      out << quoteCsv(entry.first) << ",,,,,,," << quoteCsv(statistic.first) << "," << statistic.second << "\n";
+    if (!llvm::StringRef(entry.first).starts_with("Pipeline Collection"))
+      ranking.push_back({record.wallMicroseconds, entry.first});
+  }
+  // An empty statistic column does not mean the passes changed nothing
+  if (!arePassStatisticsEnabled())
+    out << ",,,,,,," << quoteCsv("unavailable: the statistics of LLVM are disabled") << ",\n";
+  out.close();
+
+  std::sort(ranking.rbegin(), ranking.rend());
+  AS_LOG(LogLevel::Info, "Lowering time of " << this->numCandidates << " candidates: "
+                                             << totalMicroseconds / 1e6 << " s");
+  for (size_t i = 0; i < ranking.size() && i < 5; ++i)
+    AS_LOG(LogLevel::Info, "  " << ranking[i].second << ": " << ranking[i].first / 1e6 << " s");
+  if (!arePassStatisticsEnabled())
+    AS_LOG(LogLevel::Info, "No pass statistics: the statistics of LLVM are disabled");
+}
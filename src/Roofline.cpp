@@ -0,0 +1,337 @@
+//===-------------------------- Roofline.cpp Roofline ---------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the Roofline class, which calibrates
+/// the roofline of the host and computes the cost of a code
+///
+//===----------------------------------------------------------------------===//
+#include "Roofline.h"
+
+#include "mlir/Interfaces/CastInterfaces.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace mlir;
+
+/// The FMA kernel works on vectors of 8 floats (one AVX register) or of 16
+/// floats (one AVX-512 register), with enough independent accumulators to hide
+/// the latency of the FMA units.
+typedef float FloatVector8 __attribute__((vector_size(32)));
+typedef float FloatVector16 __attribute__((vector_size(64)));
+static constexpr int kAccumulators = 8;
+
+template <typename FloatVector, int Lanes>
+LLVM_ATTRIBUTE_ALWAYS_INLINE static float runFmaKernel(int64_t iterations)
+{
+  FloatVector accumulators[kAccumulators];
+  for (int j = 0; j < kAccumulators; ++j)
+    for (int lane = 0; lane < Lanes; ++lane)
+      accumulators[j][lane] = 1.0f + (j * Lanes + lane) * 1e-3f;
+  const FloatVector scale = FloatVector{} + 0.999999f;
+  const FloatVector offset = FloatVector{} + 1e-7f;
+  for (int64_t i = 0; i < iterations; ++i)
+  {
+#pragma GCC unroll 8
+    for (int j = 0; j < kAccumulators; ++j)
+      accumulators[j] = accumulators[j] * scale + offset;
+  }
+  float sum = 0;
+  for (int j = 0; j < kAccumulators; ++j)
+    for (int lane = 0; lane < Lanes; ++lane)
+      sum += accumulators[j][lane];
+  return sum;
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+/// The kernels compiled for AVX2 and for AVX-512, the generated code of the
+/// benchmarks targets the host while the auto-scheduler may be built for a
+/// generic CPU.
+__attribute__((target("avx2,fma"))) static float runFmaKernelAvx2(int64_t iterations)
+{
+  return runFmaKernel<FloatVector8, 8>(iterations);
+}
+
+__attribute__((target("avx512f"))) static float runFmaKernelAvx512(int64_t iterations)
+{
+  return runFmaKernel<FloatVector16, 16>(iterations);
+}
+#endif
+
+/// Returns the lanes of the FMA kernels the host runs, the widest first.
+static std::vector<int> getHostFmaLanes()
+{
+  std::vector<int> lanes;
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+  if (__builtin_cpu_supports("avx512f"))
+    lanes.push_back(16);
+#endif
+  lanes.push_back(8);
+  return lanes;
+}
+
+static float runHostFmaKernel(int64_t iterations, int lanes)
+{
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+  if (lanes == 16)
+    return runFmaKernelAvx512(iterations);
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return runFmaKernelAvx2(iterations);
+#endif
+  return runFmaKernel<FloatVector8, 8>(iterations);
+}
+
+/// Runs the body on numThreads threads, returns the seconds until all of them
+/// finished.
+static double timeOnThreads(unsigned numThreads, llvm::function_ref<void(unsigned)> body)
+{
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned thread = 0; thread < numThreads; ++thread)
+    threads.emplace_back([&body, thread]()
+                         { body(thread); });
+  for (std::thread &thread : threads)
+    thread.join();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double KernelCost::getArithmeticIntensity()
+{
+  return this->bytes > 0 ? this->flops / this->bytes : 0;
+}
+
+Roofline &Roofline::get()
+{
+  static Roofline roofline;
+  return roofline;
+}
+
+bool Roofline::isEnabled()
+{
+  return (std::getenv("AS_ROOFLINE") != nullptr && std::stoi(std::getenv("AS_ROOFLINE")) == 1) ||
+         this->getStopFraction() > 0;
+}
+
+double Roofline::getStopFraction()
+{
+  if (std::getenv("AS_ROOFLINE_STOP_FRACTION") == nullptr)
+    return 0;
+  return std::stod(std::getenv("AS_ROOFLINE_STOP_FRACTION"));
+}
+
+bool Roofline::readCache()
+{
+  if (std::getenv("AS_ROOFLINE_CACHE") == nullptr)
+    return false;
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      llvm::MemoryBuffer::getFile(std::getenv("AS_ROOFLINE_CACHE"));
+  if (!buffer)
+    return false;
+  llvm::Expected<llvm::json::Value> content = llvm::json::parse((*buffer)->getBuffer());
+  if (!content)
+  {
+    llvm::consumeError(content.takeError());
+    return false;
+  }
+  llvm::json::Object *cache = content->getAsObject();
+  // A calibration of another machine (or of a different number of threads or
+  // vector width) is measured again
+  if (!cache || cache->getInteger("threads") != (int64_t)std::thread::hardware_concurrency() ||
+      cache->getInteger("fma_lanes") != getHostFmaLanes().front())
+    return false;
+  this->peakGflopsSingleCore = cache->getNumber("peak_gflops_single_core").value_or(0);
+  this->peakGflops = cache->getNumber("peak_gflops").value_or(0);
+  this->bandwidth = cache->getNumber("bandwidth_gbs").value_or(0);
+  return this->peakGflops > 0 && this->bandwidth > 0;
+}
+
+void Roofline::writeCache()
+{
+  if (std::getenv("AS_ROOFLINE_CACHE") == nullptr)
+    return;
+  std::error_code ec;
+  llvm::raw_fd_ostream file(std::getenv("AS_ROOFLINE_CACHE"), ec);
+  if (ec)
+  {
+    llvm::errs() << "Could not write the roofline calibration: " << ec.message() << "\n";
+    return;
+  }
+  llvm::json::OStream json(file, 2);
+  json.object([&]()
+              {
+    json.attribute("threads", (int64_t)std::thread::hardware_concurrency());
+    json.attribute("fma_lanes", (int64_t)getHostFmaLanes().front());
+    json.attribute("peak_gflops_single_core", this->peakGflopsSingleCore);
+    json.attribute("peak_gflops", this->peakGflops);
+    json.attribute("bandwidth_gbs", this->bandwidth); });
+  file << "\n";
+}
+
+void Roofline::calibrate()
+{
+  if (this->calibrated)
+    return;
+  this->calibrated = true;
+  if (!this->readCache())
+  {
+    llvm::TimeTraceScope traceScope("Roofline calibration");
+    unsigned numThreads = std::max(1u, std::thread::hardware_concurrency());
+    this->peakGflopsSingleCore = measurePeakGflops(1);
+    this->peakGflops = measurePeakGflops(numThreads);
+    this->bandwidth = measureBandwidth(numThreads);
+    this->writeCache();
+  }
+  if (std::getenv("AS_ROOFLINE_PEAK_GFLOPS") != nullptr)
+    this->peakGflops = std::stod(std::getenv("AS_ROOFLINE_PEAK_GFLOPS"));
+  if (std::getenv("AS_ROOFLINE_BANDWIDTH") != nullptr)
+    this->bandwidth = std::stod(std::getenv("AS_ROOFLINE_BANDWIDTH"));
+  AS_LOG(LogLevel::Info, "Roofline: " << this->peakGflopsSingleCore << " GFLOPS on one core, "
+                                      << this->peakGflops << " GFLOPS on all cores, "
+                                      << this->bandwidth << " GB/s");
+}
+
+double Roofline::getPeakGflopsSingleCore()
+{
+  this->calibrate();
+  return this->peakGflopsSingleCore;
+}
+
+double Roofline::getPeakGflops()
+{
+  this->calibrate();
+  return this->peakGflops;
+}
+
+double Roofline::getBandwidth()
+{
+  this->calibrate();
+  return this->bandwidth;
+}
+
+double Roofline::getAttainableGflops(double arithmeticIntensity)
+{
+  this->calibrate();
+  if (arithmeticIntensity <= 0)
+    return this->peakGflops;
+  return std::min(this->peakGflops, arithmeticIntensity * this->bandwidth);
+}
+
+double Roofline::measurePeakGflops(unsigned numThreads)
+{
+  numThreads = std::max(1u, numThreads);
+  std::vector<float> sinks(numThreads);
+  double peakGflops = 0;
+  // Every kernel of the host is measured and the best one is kept, the cores
+  // with a single AVX-512 FMA unit (or lowering their frequency on it) may
+  // reach their peak with AVX2
+  for (int lanes : getHostFmaLanes())
+  {
+    auto run = [&](int64_t iterations)
+    {
+      return timeOnThreads(numThreads, [&](unsigned thread)
+                           { sinks[thread] = runHostFmaKernel(iterations, lanes); });
+    };
+
+    // The iterations are doubled until a run takes 0.1 second, the best of
+    // three runs is kept
+    int64_t iterations = 1 << 16;
+    double seconds = run(iterations);
+    while (seconds < 0.1 && iterations < ((int64_t)1 << 40))
+    {
+      iterations *= 2;
+      seconds = run(iterations);
+    }
+    for (int i = 0; i < 2; ++i)
+      seconds = std::min(seconds, run(iterations));
+    peakGflops = std::max(peakGflops,
+                          2.0 * kAccumulators * lanes * iterations * numThreads / seconds / 1e9);
+  }
+
+  volatile float sink = std::accumulate(sinks.begin(), sinks.end(), 0.0f);
+  (void)sink;
+  return peakGflops;
+}
+
+double Roofline::measureBandwidth(unsigned numThreads)
+{
+  numThreads = std::max(1u, numThreads);
+  // 3 arrays of 32 MiB
+  const size_t size = (size_t)1 << 23;
+  std::unique_ptr<float[]> a(new float[size]);
+  std::unique_ptr<float[]> b(new float[size]);
+  std::unique_ptr<float[]> c(new float[size]);
+  size_t chunk = (size + numThreads - 1) / numThreads;
+
+  // The pages of a chunk are first touched by the thread streaming it
+  timeOnThreads(numThreads, [&](unsigned thread)
+                {
+    for (size_t i = std::min(size, thread * chunk); i < std::min(size, (thread + 1) * chunk); ++i)
+    {
+      a[i] = 0.0f;
+      b[i] = 1.0f;
+      c[i] = 2.0f;
+    } });
+
+  double seconds = std::numeric_limits<double>::max();
+  for (int run = 0; run < 5; ++run)
+  {
+    seconds = std::min(seconds, timeOnThreads(numThreads, [&](unsigned thread)
+                                              {
+      for (size_t i = std::min(size, thread * chunk); i < std::min(size, (thread + 1) * chunk); ++i)
+        a[i] = b[i] + 3.0f * c[i]; }));
+  }
+
+  volatile float sink = a[size / 2];
+  (void)sink;
+  return 3.0 * sizeof(float) * size / seconds / 1e9;
+}
+
+/// Returns true if the operation of a linalg body computes a floating-point
+/// value (the casts and the constants are not counted).
+static bool isFloatingPointOp(mlir::Operation *op)
+{
+  return op->getNumResults() == 1 && isa<FloatType>(op->getResult(0).getType()) &&
+         !isa<CastOpInterface>(op) && !op->hasTrait<OpTrait::ConstantLike>();
+}
+
+KernelCost Roofline::computeKernelCost(mlir::Operation *root)
+{
+  KernelCost cost;
+  llvm::DenseSet<mlir::Value> operands;
+  root->walk([&](linalg::LinalgOp linalgOp)
+             {
+    if (isa<linalg::FillOp>(linalgOp.getOperation()))
+      return;
+    SmallVector<int64_t, 4> loopRanges = linalgOp.getStaticLoopRanges();
+    if (llvm::any_of(loopRanges, ShapedType::isDynamic))
+      return;
+    double iterations = 1;
+    for (int64_t range : loopRanges)
+      iterations *= range;
+    int64_t flopsPerIteration = 0;
+    for (mlir::Operation &op : *linalgOp.getBlock())
+      if (isFloatingPointOp(&op))
+        flopsPerIteration++;
+    cost.flops += iterations * flopsPerIteration;
+
+    for (mlir::Value operand : linalgOp->getOperands())
+    {
+      ShapedType type = dyn_cast<ShapedType>(operand.getType());
+      if (type && type.hasStaticShape() && operands.insert(operand).second)
+        cost.bytes += type.getNumElements() * (type.getElementTypeBitWidth() / 8.0);
+    } });
+  return cost;
+}
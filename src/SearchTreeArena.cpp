@@ -0,0 +1,67 @@
+//===------------------- SearchTreeArena.cpp SearchTreeArena --------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the SearchTreeArena class, which owns
+/// the nodes and the transformations of the search tree
+///
+//===----------------------------------------------------------------------===//
+#include "SearchTreeArena.h"
+
+SearchTreeArena::~SearchTreeArena()
+{
+  for (auto &destructor : destructors)
+    destructor.second(destructor.first);
+}
+
+SearchTreeArena &SearchTreeArena::get()
+{
+  static SearchTreeArena arena;
+  return arena;
+}
+
+void SearchTreeArena::freeNode(Node *node)
+{
+  if (node == nullptr)
+    return;
+  MLIRCodeIR *CodeIr = (MLIRCodeIR *)node->getTransformedCodeIr();
+  if (CodeIr != nullptr)
+    CodeIr->dropReference();
+
+  node->~Node();
+  nodeAllocator.Deallocate(node);
+  liveNodes--;
+  freedNodes++;
+}
+
+void SearchTreeArena::freeNodes(llvm::ArrayRef<Node *> nodes, Node *keep)
+{
+  for (Node *node : nodes)
+  {
+    if (node != keep)
+      freeNode(node);
+  }
+}
+
+bool SearchTreeArena::releaseTransformations()
+{
+  if (liveNodes > 0)
+    return false;
+  for (auto &destructor : destructors)
+    destructor.second(destructor.first);
+  destructors.clear();
+  destructors.shrink_to_fit();
+  transformationAllocator.Reset();
+  return true;
+}
+
+int SearchTreeArena::getLiveNodes()
+{
+  return this->liveNodes;
+}
+
+int SearchTreeArena::getFreedNodes()
+{
+  return this->freedNodes;
+}
@@ -0,0 +1,114 @@
+//===----------------- SearchTreeRecorder.cpp SearchTreeRecorder ----------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the SearchTreeRecorder class, which
+/// exports the search tree
+///
+//===----------------------------------------------------------------------===//
+#include "SearchTreeRecorder.h"
+
+#include "llvm/Support/JSON.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+SearchTreeRecorder::SearchTreeRecorder()
+{
+  this->startTime = std::chrono::steady_clock::now();
+  if (std::getenv("AS_SEARCH_TREE") == nullptr)
+    return;
+  std::error_code ec;
+  this->output = std::make_unique<llvm::raw_fd_ostream>(std::getenv("AS_SEARCH_TREE"), ec);
+  if (ec)
+  {
+    llvm::errs() << "Could not open the search tree file: " << ec.message() << "\n";
+    this->output.reset();
+  }
+}
+
+SearchTreeRecorder &SearchTreeRecorder::get()
+{
+  static SearchTreeRecorder recorder;
+  return recorder;
+}
+
+bool SearchTreeRecorder::isEnabled()
+{
+  return this->output != nullptr;
+}
+
+void SearchTreeRecorder::beginSearch(const std::string &name)
+{
+  this->searchIndex++;
+  this->searchName = name;
+  this->numRecords = 0;
+  this->numFailed = 0;
+  this->nodeIds.clear();
+  this->startTime = std::chrono::steady_clock::now();
+}
+
+std::vector<std::string> SearchTreeRecorder::getScheduleKey(const std::vector<Transformation *> &schedule)
+{
+  std::vector<std::string> key;
+  for (Transformation *transformation : schedule)
+    key.push_back(transformation->getType() + ":" + transformation->printTransformation());
+  return key;
+}
+
+int64_t SearchTreeRecorder::findParent(std::vector<std::string> key)
+{
+  while (!key.empty())
+  {
+    key.pop_back();
+    auto it = this->nodeIds.find(key);
+    if (it != this->nodeIds.end())
+      return it->second;
+  }
+  return -1;
+}
+
+int64_t SearchTreeRecorder::recordEvaluation(Node *node, const std::string &evaluation, bool failed)
+{
+  if (!this->isEnabled())
+    return -1;
+  std::vector<Transformation *> schedule = node->getTransformationList();
+  std::vector<std::string> key = getScheduleKey(schedule);
+  int64_t id = this->numRecords++;
+  if (failed)
+    this->numFailed++;
+  int64_t parent = findParent(key);
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->startTime).count();
+
+  llvm::json::OStream json(*this->output);
+  json.object([&]()
+              {
+    json.attribute("search", std::max<int64_t>(this->searchIndex, 0));
+    json.attribute("search_name", this->searchName);
+    json.attribute("id", id);
+    json.attribute("parent", parent);
+    json.attribute("depth", (int64_t)schedule.size());
+    json.attribute("stage", (int64_t)node->getCurrentStage());
+    json.attributeArray("schedule", [&]()
+                        {
+      for (Transformation *transformation : schedule)
+      {
+        json.object([&]()
+                    {
+          json.attribute("type", transformation->getType());
+          json.attribute("params", transformation->printTransformation()); });
+      } });
+    json.attribute("evaluation", evaluation);
+    json.attribute("failed", failed);
+    json.attributeObject("counters", [&]()
+                         {
+      json.attribute("evaluations", this->numRecords);
+      json.attribute("failed", this->numFailed);
+      json.attribute("elapsed_s", elapsed); }); });
+  *this->output << "\n";
+  this->output->flush();
+
+  this->nodeIds[key] = id;
+  return id;
+}
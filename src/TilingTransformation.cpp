@@ -44,6 +44,14 @@ void Tiling::setOperationStage(int stage){
   this->OperationStage = stage;
 }
 
+int64_t Tiling::getTargetOpId(){
+  return this->targetOpId;
+}
+
+void Tiling::setTargetOpId(int64_t id){
+  this->targetOpId = id;
+}
+
 std::string Tiling::printTransformation()
 {
 
@@ -75,8 +83,24 @@ std::string Tiling::printTransformation()
 }
 void Tiling::applyTransformation(CodeIR CodeIr)
 {
-
-  IRRewriter rewriter(this->context);
+  llvm::TimeTraceScope traceScope("Apply transformation", [&]()
+                                { return this->printTransformation(); });
+  Operation *ClonedTarget = ((Operation *)CodeIr.getIr());
+  // The index is kept up to date for the next tilings of the code
+  OpIdentityIndex &index = getOpIdentityIndex(ClonedTarget);
+  mlir::Operation *linalgOp = index.lookup(this->targetOpId, this->OperationStage);
+  if (mlir::TilingInterface ClonedTileableOp = dyn_cast_or_null<mlir::TilingInterface>(linalgOp))
+  {
+    IRRewriter rewriter(ClonedTarget->getContext());
+    FailureOr<scf::SCFTilingResult> maybeTiled =
+        scf::tileUsingSCFForOp(rewriter, ClonedTileableOp, this->options);
+    if (!failed(maybeTiled))
+    {
+      index.erase(ClonedTileableOp);
+      rewriter.replaceOp(ClonedTileableOp, maybeTiled->loops.front()->getResults());
+      index.update(maybeTiled->loops.front());
+    }
+  }
   // linalg::LinalgOp oper = (this->op);
   //  std::cout<<"BLOCKINSIDE BUG\n";
 
@@ -142,6 +166,7 @@ SmallVector<Node *, 2> Tiling::createTilingCandidates(Node *node,
                                                       int CurrentStage,
                                                       SmallVector<mlir::linalg::LinalgOp, 4> LinalgOpStages)
 {
+  llvm::TimeTraceScope traceScope("Generate candidates", "Tiling");
 
   // int64_t maxNumberLoops = 3;
 
@@ -190,17 +215,11 @@ SmallVector<Node *, 2> Tiling::createTilingCandidates(Node *node,
       tileCombinations.end(),
       std::back_inserter(SelectedTileCombinations),
       1,
-      std::mt19937{std::random_device{}()});
+      getRandomEngine());
     for (const auto &candidate : SelectedTileCombinations)
     {
       for (const auto &interchange : values)
       {
-        MLIRCodeIR *ClonedCode = (MLIRCodeIR *)CodeIr->cloneIr();
-        Node *ChildNode = new Node(ClonedCode, node->getCurrentStage());
-
-        std::vector<Transformation *> TransList = node->getTransformationList();
-        ChildNode->setTransformationList(TransList);
-
         scf::SCFTilingOptions options;
         SmallVector<OpFoldResult> mixedSizes = getMixedSizes(candidate, context);
         options.setTileSizes(mixedSizes);
@@ -217,11 +236,20 @@ SmallVector<Node *, 2> Tiling::createTilingCandidates(Node *node,
         options.setInterchange(targetSmallVector);
 
         Tiling *tiling =
-            new Tiling(&tileableOp,
+            SearchTreeArena::get().createTransformation<Tiling>(&tileableOp,
                        CurrentStage,
                        options,
                        candidate,
                        context);
+        tiling->setTargetOpId(getOpId(op));
+
+        // The candidate is a recipe, the tiling is replayed on a clone of the
+        // parent code when the candidate is evaluated.
+        MLIRCodeIR *ChildCode = new MLIRCodeIR(CodeIr, tiling);
+        Node *ChildNode = SearchTreeArena::get().createNode(ChildCode, node->getCurrentStage() + 1);
+
+        std::vector<Transformation *> TransList = node->getTransformationList();
+        ChildNode->setTransformationList(TransList);
 
         ChildNode->setTransformation(tiling);
 
@@ -265,61 +293,6 @@ SmallVector<Node *, 2> Tiling::createTilingCandidates(Node *node,
     }
     ChildNodesList.push_back(ChildNodes);*/
 
-  int OpIndex = 0;
-  // for (auto ChildNodes : ChildNodesList)
-  // {
-  for (auto node : ChildNodes)
-  {
-    Operation *ClonedTarget = ((Operation *)(*((MLIRCodeIR *)node->getTransformedCodeIr()))
-                                   .getIr());
-    Tiling *tiling = (Tiling *)node->getTransformation();
-    SmallVector<mlir::linalg::LinalgOp, 4> linalgOps = getLinalgOps(ClonedTarget);
-
-    mlir::Operation *linalgOp = linalgOps[CurrentStage];
-    if (mlir::TilingInterface ClonedTileableOp = dyn_cast<mlir::TilingInterface>(linalgOp))
-    {
-      /*if ((op->getName().getStringRef()).str() != "linalg.fill")
-      {*/
-        IRRewriter rewriter(context);
-        FailureOr<scf::SCFTilingResult> maybeTiled =
-            scf::tileUsingSCFForOp(rewriter, ClonedTileableOp, tiling->getOptions());
-        // FailureOr<scf::SCFTileAndFuseResult> maybeTiled =
-        // mlir::scf::tileConsumerAndFuseProducerGreedilyUsingSCFForOp(rewriter,ClonedTileableOp,tiling->getOptions());
-        node->setCurrentStage(node->getCurrentStage() + 1);
-        if (!failed(maybeTiled))
-          rewriter.replaceOp(ClonedTileableOp, maybeTiled->loops.front()->getResults());
-      //}
-    }
-    int ClonedOpIndex = 0;
-    /*ClonedTarget->walk([&](Operation *op)
-                       {
-                     /*if (mlir::TilingInterface ClonedTileableOp
-                              =dyn_cast<mlir::TilingInterface>(op)) {
-                      IRRewriter rewriter(context);
-                      Diagnostic diag(op->getLoc(),DiagnosticSeverity::Remark);
-                      ClonedTarget->walk([&](Operation *op1)
-                       {
-                        if ((op1->getName().getStringRef()).str() == "scf.forall") {
-                                std::cout<<"for.all\n";
-                              SmallVector<Operation *>res =   tileAndFuseFirstExtractUseThroughContainingOpBlockArgument(rewriter,diag,op,op1);
-                               }
-                       });}*/
-
-    /*if (mlir::TilingInterface ClonedTileableOp
-                      =dyn_cast<mlir::TilingInterface>(op)) {
-        if ((op->getName().getStringRef()).str() != "linalg.fill" ){
-            IRRewriter rewriter(context);
-            FailureOr<scf::SCFTilingResult> maybeTiled =
-                    scf::tileUsingSCFForOp(rewriter, ClonedTileableOp, tiling->getOptions());
-            //FailureOr<scf::SCFTileAndFuseResult> maybeTiled =
-               //mlir::scf::tileConsumerAndFuseProducerGreedilyUsingSCFForOp(rewriter,ClonedTileableOp,tiling->getOptions());
-            if (!failed(maybeTiled))
-                    rewriter.replaceOp(ClonedTileableOp, maybeTiled->loops.front()->getResults());
-        }
-      ClonedOpIndex++;
-      } });*/
-  }
-  OpIndex++;
   // }
 
   /*SmallVector<Node *, 2> ResChildNodes;
@@ -0,0 +1,95 @@
+//===--------------------------- Tracing.cpp Tracing ----------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the tracing functions of the search
+///
+//===----------------------------------------------------------------------===//
+#include "Tracing.h"
+
+#include "mlir/Pass/PassInstrumentation.h"
+#include "llvm/Support/Threading.h"
+
+static std::string traceFile;
+static std::string traceProcessName;
+static unsigned traceGranularity = 0;
+
+/// Records each pass as an event nested in the event of the pass manager.
+class PassTracing : public mlir::PassInstrumentation
+{
+public:
+  void runBeforePass(mlir::Pass *pass, mlir::Operation *op) override
+  {
+    llvm::timeTraceProfilerBegin(pass->getName(), [&]()
+                                 { return op->getName().getStringRef().str(); });
+  }
+  void runAfterPass(mlir::Pass *pass, mlir::Operation *op) override
+  {
+    llvm::timeTraceProfilerEnd();
+  }
+  void runAfterPassFailed(mlir::Pass *pass, mlir::Operation *op) override
+  {
+    llvm::timeTraceProfilerEnd();
+  }
+};
+
+void initTracing(llvm::StringRef processName)
+{
+  if (std::getenv("AS_TRACE") == nullptr)
+    return;
+  traceFile = std::getenv("AS_TRACE");
+  if (traceFile.empty())
+    return;
+  if (std::getenv("AS_TRACE_GRANULARITY") != nullptr)
+    traceGranularity = std::stoi(std::getenv("AS_TRACE_GRANULARITY"));
+  traceProcessName = processName.str();
+  llvm::timeTraceProfilerInitialize(traceGranularity, traceProcessName);
+}
+
+bool isTracingEnabled()
+{
+  return !traceFile.empty();
+}
+
+void initThreadTracing(llvm::StringRef threadName)
+{
+  if (!isTracingEnabled())
+    return;
+  // The name of the thread is the name of its track in the trace
+  llvm::set_thread_name(threadName);
+  llvm::timeTraceProfilerInitialize(traceGranularity, traceProcessName);
+}
+
+void finishThreadTracing()
+{
+  if (llvm::timeTraceProfilerEnabled())
+    llvm::timeTraceProfilerFinishThread();
+}
+
+void writeTrace()
+{
+  if (!llvm::timeTraceProfilerEnabled())
+    return;
+  if (llvm::Error err = llvm::timeTraceProfilerWrite(traceFile, traceProcessName))
+    llvm::errs() << "Could not write the trace: " << llvm::toString(std::move(err)) << "\n";
+  else
+    std::cout << "Trace written to " << traceFile << std::endl;
+  llvm::timeTraceProfilerCleanup();
+}
+
+std::string getTraceCandidateName(Node *node)
+{
+  if (node->getTransformation() == NULL)
+    return "root";
+  std::string name;
+  for (Transformation *transformation : node->getTransformationList())
+    name += transformation->printTransformation();
+  return name;
+}
+
+void addPassTracing(mlir::PassManager &pm)
+{
+  if (llvm::timeTraceProfilerEnabled())
+    pm.addInstrumentation(std::make_unique<PassTracing>());
+}
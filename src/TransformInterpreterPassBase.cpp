@@ -59,7 +59,6 @@ static mlir::Operation *
 findTopLevelTransform(mlir::Operation *root, StringRef filenameOption,
                       mlir::transform::TransformOptions options)
 {
-  //std::cout <<"findTopLevelTransform"<<std::endl;
   //root->dump();
   ::mlir::transform::TransformOpInterface topLevelTransform = nullptr;
   root->walk<WalkOrder::PreOrder>(
@@ -67,20 +66,16 @@ findTopLevelTransform(mlir::Operation *root, StringRef filenameOption,
       {
         //transformOp->dump();
         if (!transformOp
-                 ->hasTrait<transform::PossibleTopLevelTransformOpTrait>()){
-                   std::cout <<"hasTrait<transform::PossibleTopLevelTransformOpTrait"<<std::endl;
-                   return WalkResult::skip();
-                 }
+                 ->hasTrait<transform::PossibleTopLevelTransformOpTrait>())
+          return WalkResult::skip();
           
         if (!topLevelTransform)
         {
-          std::cout <<"!topLevelTransform"<<std::endl;
           topLevelTransform = transformOp;
           return WalkResult::skip();
         }
         if (options.getEnforceSingleToplevelTransformOp())
         {
-          std::cout <<"options.getEnforceSingleToplevelTransformOp()"<<std::endl;
           auto diag = transformOp.emitError()
                       << "more than one top-level transform op";
           diag.attachNote(topLevelTransform.getLoc())
@@ -89,7 +84,6 @@ findTopLevelTransform(mlir::Operation *root, StringRef filenameOption,
         }
         return WalkResult::skip();
       });
-  //std::cout <<"return findTopLevelTransform"<<std::endl;
   if (!topLevelTransform)
   {
     auto diag = root->emitError()
@@ -427,7 +421,6 @@ mlir::LogicalResult interpreterBaseRunOnOperationImplModified(
     if (!payloadRoot)
       return failure();
   }
-    std::cout << " Step 1" <<std::endl;
   // Step 2
   // ------
   // If a shared transform was specified separately, use it. Otherwise, the
@@ -452,7 +445,6 @@ mlir::LogicalResult interpreterBaseRunOnOperationImplModified(
            << "expected the transform entry point to be a top-level transform "
               "op";
   }
- std::cout << " Step 2" <<std::endl;
   // Step 3
   // ------
   // Copy external defintions for symbols if provided. Be aware of potential
@@ -478,7 +470,6 @@ mlir::LogicalResult interpreterBaseRunOnOperationImplModified(
       return diag;
     }
   }
- std::cout << " Step 3" <<std::endl;
   // Step 4
   // ------
   // Optionally perform debug actions requested by the user to dump IR and a
@@ -486,7 +477,6 @@ mlir::LogicalResult interpreterBaseRunOnOperationImplModified(
   performOptionalDebugActions(target, transformRoot, passName,
                               debugPayloadRootTag, debugTransformRootTag,
                               transformLibraryPaths, binaryName);
-   std::cout << " Step 4" <<std::endl;
   // Step 5
   // ------
   // Apply the transform to the IR
@@ -720,9 +710,8 @@ mlir::LogicalResult interpreterBaseInitializeImplModified(
     }
   }
 
-  if (parsedLibraries.empty()){std::cout << "RETUNING" << std::endl;
-return success();
-  }
+  if (parsedLibraries.empty())
+    return success();
     
 
   // Merge parsed libraries into one module.
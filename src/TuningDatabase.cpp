@@ -0,0 +1,298 @@
+//===--------------------- TuningDatabase.cpp TuningDatabase --------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the implmentation of the TuningDatabase class, which
+/// stores the best schedule found for each benchmark
+///
+//===----------------------------------------------------------------------===//
+#include "TuningDatabase.h"
+
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdlib>
+#include <ctime>
+
+using namespace mlir;
+
+using AnalysisHeuristic = bufferization::OneShotBufferizationOptions::AnalysisHeuristic;
+
+template <typename T>
+static llvm::json::Array toJsonArray(const T &values)
+{
+  llvm::json::Array array;
+  for (auto value : values)
+    array.push_back((int64_t)value);
+  return array;
+}
+
+/// Reads the integers of the array of the step, returns false if the step has
+/// no such array.
+static bool fromJsonArray(const llvm::json::Object &step, llvm::StringRef key,
+                          llvm::SmallVectorImpl<int64_t> &values)
+{
+  const llvm::json::Array *array = step.getArray(key);
+  if (!array)
+    return false;
+  for (const llvm::json::Value &value : *array)
+  {
+    std::optional<int64_t> integer = value.getAsInteger();
+    if (!integer)
+      return false;
+    values.push_back(*integer);
+  }
+  return true;
+}
+
+TuningDatabase::TuningDatabase()
+{
+  if (std::getenv("AS_TUNING_DB") != nullptr)
+    this->open(std::getenv("AS_TUNING_DB"));
+}
+
+bool TuningDatabase::open(const std::string &path)
+{
+  this->path = path;
+  this->benchmarks = llvm::json::Object();
+  if (path.empty())
+    return true;
+
+  // A missing file is an empty database, it is created by the first record
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer = llvm::MemoryBuffer::getFile(this->path);
+  if (!buffer)
+    return true;
+  llvm::Expected<llvm::json::Value> content = llvm::json::parse((*buffer)->getBuffer());
+  if (!content)
+  {
+    llvm::errs() << "Could not read the tuning database " << this->path << ": "
+                 << llvm::toString(content.takeError()) << "\n";
+    return false;
+  }
+  if (llvm::json::Object *root = content->getAsObject())
+    if (llvm::json::Object *entries = root->getObject("benchmarks"))
+      this->benchmarks = std::move(*entries);
+  return true;
+}
+
+const std::string &TuningDatabase::getPath()
+{
+  return this->path;
+}
+
+TuningDatabase &TuningDatabase::get()
+{
+  static TuningDatabase database;
+  return database;
+}
+
+bool TuningDatabase::isEnabled()
+{
+  return !this->path.empty();
+}
+
+bool TuningDatabase::write()
+{
+  std::error_code ec;
+  llvm::raw_fd_ostream file(this->path, ec);
+  if (ec)
+  {
+    llvm::errs() << "Could not write the tuning database: " << ec.message() << "\n";
+    return false;
+  }
+  llvm::json::OStream json(file, 2);
+  json.value(llvm::json::Object{{"benchmarks", llvm::json::Object(this->benchmarks)}});
+  file << "\n";
+  return true;
+}
+
+bool TuningDatabase::lookup(const std::string &benchmark, TuningRecord &record, mlir::MLIRContext *context)
+{
+  const llvm::json::Object *entry = this->benchmarks.getObject(benchmark);
+  if (!entry)
+    return false;
+  record.rootTime = entry->getNumber("root_time").value_or(0);
+  record.time = entry->getNumber("time").value_or(0);
+  record.date = entry->getString("date").value_or("").str();
+  record.schedule.clear();
+  if (const llvm::json::Array *schedule = entry->getArray("schedule"))
+  {
+    if (!deserializeSchedule(*schedule, context, record.schedule))
+    {
+      llvm::errs() << "Unknown transformation in the schedule of " << benchmark << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TuningDatabase::record(const std::string &benchmark, double rootTime, double time,
+                            const std::vector<Transformation *> &schedule)
+{
+  if (!this->isEnabled())
+    return false;
+  if (const llvm::json::Object *entry = this->benchmarks.getObject(benchmark))
+  {
+    std::optional<double> storedTime = entry->getNumber("time");
+    if (storedTime && *storedTime <= time)
+      return false;
+  }
+
+  llvm::json::Array steps = serializeSchedule(schedule);
+  char date[32];
+  std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+
+  this->benchmarks[benchmark] = llvm::json::Object{{"root_time", rootTime},
+                                                   {"time", time},
+                                                   {"date", date},
+                                                   {"schedule", std::move(steps)}};
+  return this->write();
+}
+
+llvm::json::Object TuningDatabase::serializeTransformation(Transformation *transformation)
+{
+  std::string type = transformation->getType();
+  llvm::json::Object step{{"type", type}, {"print", transformation->printTransformation()}};
+  if (type == "Parallelization")
+  {
+    Parallelization *parallelization = (Parallelization *)transformation;
+    step["stage"] = parallelization->getOperationStage();
+    step["op_id"] = parallelization->getTargetOpId();
+    step["tile_sizes"] = toJsonArray(parallelization->getTileSizes());
+  }
+  else if (type == "Tiling")
+  {
+    Tiling *tiling = (Tiling *)transformation;
+    step["stage"] = tiling->getOperationStage();
+    step["op_id"] = tiling->getTargetOpId();
+    step["tile_sizes"] = toJsonArray(tiling->getTilingSizes());
+    step["interchange"] = toJsonArray(tiling->getOptions().interchangeVector);
+  }
+  else if (type == "Interchange")
+  {
+    step["interchange"] = toJsonArray(((Interchange *)transformation)->getInterchangeVector());
+  }
+  else if (type == "Vectorization")
+  {
+    Vectorization *vectorization = (Vectorization *)transformation;
+    step["stage"] = vectorization->getOperationStage();
+    step["op_id"] = vectorization->getTargetOpId();
+  }
+  else if (type == "Bufferization")
+  {
+    BufferizationStrategy *strategy = (BufferizationStrategy *)transformation;
+    step["function_boundary_layout"] = (int64_t)strategy->getFunctionBoundaryLayout();
+    step["heuristic"] = (int64_t)strategy->getHeuristic();
+    step["copy_before_write"] = strategy->getCopyBeforeWrite();
+    step["empty_tensor_elimination"] = strategy->getEmptyTensorElimination();
+  }
+  else if (type == "FastMath")
+  {
+    step["flags"] = arith::stringifyFastMathFlags(((FastMath *)transformation)->getFlags());
+  }
+  else if (type == "InterOpConcurrency")
+  {
+    InterOpConcurrency *concurrency = (InterOpConcurrency *)transformation;
+    step["stages"] = toJsonArray(concurrency->getStages());
+    step["num_threads"] = toJsonArray(concurrency->getNumThreads());
+    step["group"] = concurrency->getGroupId();
+  }
+  return step;
+}
+
+Transformation *TuningDatabase::deserializeTransformation(const llvm::json::Object &step, mlir::MLIRContext *context)
+{
+  std::string type = step.getString("type").value_or("").str();
+  int stage = (int)step.getInteger("stage").value_or(0);
+  int64_t opId = step.getInteger("op_id").value_or(-1);
+  SearchTreeArena &arena = SearchTreeArena::get();
+
+  if (type == "Parallelization")
+  {
+    llvm::SmallVector<int64_t, 4> tileSizes;
+    if (!fromJsonArray(step, "tile_sizes", tileSizes))
+      return nullptr;
+    Parallelization *parallelization =
+        arena.createTransformation<Parallelization>((mlir::TilingInterface *)nullptr, stage, tileSizes, context);
+    parallelization->setTargetOpId(opId);
+    return parallelization;
+  }
+  if (type == "Tiling")
+  {
+    llvm::SmallVector<int64_t, 4> tileSizes;
+    llvm::SmallVector<int64_t, 4> interchange;
+    if (!fromJsonArray(step, "tile_sizes", tileSizes) || !fromJsonArray(step, "interchange", interchange))
+      return nullptr;
+    scf::SCFTilingOptions options;
+    options.setTileSizes(getMixedSizes(tileSizes, context));
+    options.setInterchange(interchange);
+    Tiling *tiling =
+        arena.createTransformation<Tiling>((mlir::TilingInterface *)nullptr, stage, options, tileSizes, context);
+    tiling->setTargetOpId(opId);
+    return tiling;
+  }
+  if (type == "Interchange")
+  {
+    llvm::SmallVector<int64_t, 4> values;
+    if (!fromJsonArray(step, "interchange", values))
+      return nullptr;
+    std::vector<unsigned> interchange(values.begin(), values.end());
+    return arena.createTransformation<Interchange>((linalg::LinalgOp *)nullptr, interchange, context);
+  }
+  if (type == "Vectorization")
+    return arena.createTransformation<Vectorization>(opId, stage, context);
+  // The deallocation and memory space of the schedules stored by earlier
+  // versions are ignored
+  if (type == "Bufferization")
+  {
+    return arena.createTransformation<BufferizationStrategy>(
+        (bufferization::LayoutMapOption)step.getInteger("function_boundary_layout").value_or(0),
+        (AnalysisHeuristic)step.getInteger("heuristic").value_or(0),
+        step.getBoolean("copy_before_write").value_or(false),
+        step.getBoolean("empty_tensor_elimination").value_or(true),
+        context);
+  }
+  if (type == "FastMath")
+  {
+    std::optional<arith::FastMathFlags> flags =
+        arith::symbolizeFastMathFlags(step.getString("flags").value_or(""));
+    if (!flags)
+      return nullptr;
+    return arena.createTransformation<FastMath>(*flags, context);
+  }
+  if (type == "InterOpConcurrency")
+  {
+    llvm::SmallVector<int64_t, 4> stageValues;
+    llvm::SmallVector<int64_t, 4> numThreads;
+    if (!fromJsonArray(step, "stages", stageValues) || !fromJsonArray(step, "num_threads", numThreads))
+      return nullptr;
+    llvm::SmallVector<int, 4> stages(stageValues.begin(), stageValues.end());
+    return arena.createTransformation<InterOpConcurrency>(stages, numThreads,
+                                                          (int)step.getInteger("group").value_or(0), context);
+  }
+  return nullptr;
+}
+
+llvm::json::Array TuningDatabase::serializeSchedule(const std::vector<Transformation *> &schedule)
+{
+  llvm::json::Array steps;
+  for (Transformation *transformation : schedule)
+    steps.push_back(serializeTransformation(transformation));
+  return steps;
+}
+
+bool TuningDatabase::deserializeSchedule(const llvm::json::Array &steps, mlir::MLIRContext *context,
+                                         std::vector<Transformation *> &schedule)
+{
+  for (const llvm::json::Value &value : steps)
+  {
+    const llvm::json::Object *step = value.getAsObject();
+    Transformation *transformation = step ? deserializeTransformation(*step, context) : nullptr;
+    if (!transformation)
+      return false;
+    schedule.push_back(transformation);
+  }
+  return true;
+}
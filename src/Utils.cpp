@@ -261,7 +261,7 @@ std::vector<std::vector<unsigned>> generateCandidates(int64_t numLoops,
       candidates.end(),
       std::back_inserter(out),
       1,
-      std::mt19937{std::random_device{}()});
+      getRandomEngine());
   return out;
   // return candidates;
 }
@@ -407,6 +407,18 @@ llvm::SmallVector<mlir::OpFoldResult> getMixedSizes(llvm::ArrayRef<int64_t> tile
   return results;
 }
 
+std::mt19937 &getRandomEngine()
+{
+  static std::mt19937 engine(std::getenv("AS_SEED") != nullptr
+                                 ? (std::mt19937::result_type)std::stoul(std::getenv("AS_SEED"))
+                                 : std::random_device{}());
+  return engine;
+}
+
+void seedRandomEngine(std::mt19937::result_type seed)
+{
+  getRandomEngine().seed(seed);
+}
 
 mlir::LogicalResult TagSCFForAll(mlir::Operation *Target, std::string tag)
 {
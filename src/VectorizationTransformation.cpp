@@ -11,6 +11,86 @@
 
 using namespace mlir;
 
+template <typename PatternTy, typename... Args>
+static FailureOr<mlir::linalg::LinalgOp> tryApply(mlir::Operation *operation, Args &&...args)
+{
+  // Check if the given operation has the type expected by the pattern.
+  using OpTy = typename llvm::function_traits<
+      decltype(&PatternTy::returningMatchAndRewrite)>::template arg_t<0>;
+  auto op = dyn_cast<OpTy>(operation);
+  if (!op)
+    return failure();
+
+  // Apply the pattern directly to the op.
+  PatternTy pattern(operation->getContext(), std::forward<Args>(args)...);
+  // We want to discourage direct use of PatternRewriter in APIs but In this
+  // very specific case, an IRRewriter is not enough.
+  struct TrivialPatternRewriter : public PatternRewriter
+  {
+  public:
+    explicit TrivialPatternRewriter(mlir::MLIRContext *context)
+        : PatternRewriter(context) {}
+  };
+  TrivialPatternRewriter rewriter(operation->getContext());
+  rewriter.setInsertionPoint(operation);
+  int64_t opId = getOpId(operation);
+  auto result = pattern.returningMatchAndRewrite(op, rewriter);
+
+  if (failed(result))
+    return failure();
+  // The decomposed operation keeps the identifier of the operation
+  setOpId(result->getOperation(), opId);
+  return cast<mlir::linalg::LinalgOp>(result->getOperation());
+}
+
+mlir::linalg::LinalgOp DecomposeOp(mlir::linalg::LinalgOp Target, mlir::IRRewriter *rewriter)
+{
+#define DOWNSCALE(trans)                                             \
+  {                                                                  \
+    Logger::get().logIR(LogLevel::Trace, "Decomposing", Target);     \
+    FailureOr<mlir::linalg::LinalgOp> res = tryApply<trans>(Target); \
+    if (succeeded(res))                                              \
+    {                                                                \
+      AS_LOG(LogLevel::Debug, "Decomposed op " << getOpId(*res));    \
+      return Target;                                                 \
+    }                                                                \
+  }
+
+#define DOWNSCALE_CALL(a, b) mlir::linalg::DownscaleSizeOneWindowed2DConvolution<a, b>
+#define DOWNSCALE_NORMAL(a, b) DOWNSCALE(DOWNSCALE_CALL(a, b))
+
+  DOWNSCALE_NORMAL(mlir::linalg::Conv2DNhwcHwcfOp, mlir::linalg::Conv1DNwcWcfOp)
+  DOWNSCALE_NORMAL(mlir::linalg::Conv2DNchwFchwOp, mlir::linalg::Conv1DNcwFcwOp)
+  DOWNSCALE_NORMAL(mlir::linalg::PoolingNhwcSumOp, mlir::linalg::PoolingNwcSumOp)
+  DOWNSCALE_NORMAL(mlir::linalg::PoolingNchwSumOp, mlir::linalg::PoolingNcwSumOp)
+  DOWNSCALE_NORMAL(mlir::linalg::PoolingNhwcMaxOp, mlir::linalg::PoolingNwcMaxOp)
+  DOWNSCALE_NORMAL(mlir::linalg::PoolingNhwcMaxUnsignedOp, mlir::linalg::PoolingNwcMaxUnsignedOp)
+  DOWNSCALE_NORMAL(mlir::linalg::PoolingNhwcMinOp, mlir::linalg::PoolingNwcMinOp)
+  DOWNSCALE_NORMAL(mlir::linalg::PoolingNhwcMinUnsignedOp, mlir::linalg::PoolingNwcMinUnsignedOp)
+  DOWNSCALE_NORMAL(mlir::linalg::PoolingNchwMaxOp, mlir::linalg::PoolingNcwMaxOp)
+  DOWNSCALE(mlir::linalg::DownscaleDepthwiseConv2DNhwcHwcOp)
+  DOWNSCALE(mlir::linalg::DownscaleConv2DOp)
+#undef DOWNSCALE_NORMAL
+#undef DOWNSCALE_CALL
+#undef DOWNSCALE
+
+  /*auto decomposableOp = dyn_cast<mlir::linalg::AggregatedOpInterface>(Target);
+  if (decomposableOp)
+  {
+    FailureOr<SmallVector<Value>> maybeNewResults =
+        decomposableOp.decomposeOperation(*rewriter);
+    if (!failed(maybeNewResults))
+    {
+      rewriter->replaceOp(decomposableOp, *maybeNewResults);
+      for (Value val : *maybeNewResults)
+      {
+
+      }
+    }
+  }*/
+  return Target;
+}
+
 mlir::Operation *DecomposeConv2dOp(mlir::Operation *Target)
 {
 
@@ -44,6 +124,26 @@ Vectorization::Vectorization(mlir::linalg::LinalgOp *op,
   this->context = context;
 }
 
+Vectorization::Vectorization(int64_t targetOpId,
+                             int OperationStage,
+                             mlir::MLIRContext *context)
+{
+  this->op = nullptr;
+  this->targetOpId = targetOpId;
+  this->OperationStage = OperationStage;
+  this->context = context;
+}
+
+int Vectorization::getOperationStage()
+{
+  return this->OperationStage;
+}
+
+int64_t Vectorization::getTargetOpId()
+{
+  return this->targetOpId;
+}
+
 std::string Vectorization::getType()
 {
   return "Vectorization";
@@ -59,11 +159,155 @@ std::string Vectorization::printTransformation()
 }
 void Vectorization::applyTransformation(CodeIR CodeIr)
 {
+  llvm::TimeTraceScope traceScope("Apply transformation", [&]()
+                                { return this->printTransformation(); });
+  // The vectorization of the candidates of the search (created without a
+  // target) is applied by the search itself
+  if (this->OperationStage < 0)
+    return;
+  Operation *ClonedOpVect = ((Operation *)CodeIr.getIr());
+  MLIRContext *context = ClonedOpVect->getContext();
+  IRRewriter rewriter(context);
+
+  // The operation to vectorize is found by its identifier, the tiling and
+  // the decomposition below keep the index up to date
+  OpIdentityIndex &vectIndex = getOpIdentityIndex(ClonedOpVect);
+
+  bool ToDecompose = false;
+  mlir::Operation *OpVect = vectIndex.lookup(this->targetOpId, this->OperationStage);
+  if (!OpVect)
+    return;
+  // OpVect->dump();
+  if (mlir::TilingInterface ClonedTileableOp = dyn_cast<mlir::TilingInterface>(OpVect))
+  {
+    if ((OpVect->getName().getStringRef()).str() == "linalg.pooling_nchw_max" || (OpVect->getName().getStringRef()).str() == "linalg.pooling_nchw_sum" || (OpVect->getName().getStringRef()).str() == "linalg.conv_2d_nchw_fchw")
+    {
+      llvm::SmallVector<int64_t, 4> tilingSizes;
+      OpBuilder builder(context);
+      SmallVector<Range> iterationDomain = ClonedTileableOp.getIterationDomain(builder);
+      for (size_t i = 0; i < iterationDomain.size(); ++i)
+      {
+        if (i == 2)
+        {
+          tilingSizes.push_back(1); // DEPENDS on the 'h' and the type of the conv2D
+        }
+        else if (((OpVect->getName().getStringRef()).str() == "linalg.pooling_nchw_max" || (OpVect->getName().getStringRef()).str() == "linalg.pooling_nchw_sum") && i == 4)
+        {
+          tilingSizes.push_back(1); // DEPENDS on the 'h' and the type of the pooling
+          break;
+        }
+        else if ((OpVect->getName().getStringRef()).str() == "linalg.conv_2d_nchw_fchw" && i == 5)
+        {
+          tilingSizes.push_back(1); // DEPENDS on the 'h' and the type of the conv2D
+          break;
+        }
+        else
+        {
+          tilingSizes.push_back(0);
+        }
+      }
+      scf::SCFTilingOptions options;
+      SmallVector<OpFoldResult> mixedSizes = getMixedSizes(tilingSizes, context);
+      options.setTileSizes(mixedSizes);
+      if (Logger::get().isEnabled(LogLevel::Debug))
+      {
+        std::string sizes;
+        for (size_t i = 0; i < tilingSizes.size(); ++i)
+          sizes += (i > 0 ? ", " : "") + std::to_string(tilingSizes[i]);
+        AS_LOG(LogLevel::Debug, "Window tiling of op " << this->targetOpId << " (stage " << this->OperationStage
+                                                       << ", " << (OpVect->getName().getStringRef()).str() << "): [" << sizes << "]");
+      }
+
+      ToDecompose = true;
+
+      FailureOr<scf::SCFTilingResult> maybeTiled =
+          scf::tileUsingSCFForOp(rewriter, ClonedTileableOp, options);
+      if (failed(maybeTiled))
+        AS_LOG(LogLevel::Debug, "Window tiling of op " << this->targetOpId << " failed");
+
+      if (!failed(maybeTiled))
+      {
+        vectIndex.erase(ClonedTileableOp);
+        rewriter.replaceOp(ClonedTileableOp, maybeTiled->loops.front()->getResults());
+        vectIndex.update(maybeTiled->loops.front());
+      }
+    }
+  }
+  // ClonedOpVect->dump();
+  if (ToDecompose)
+  {
+    OpVect = vectIndex.lookup(this->targetOpId, this->OperationStage);
+    if (mlir::linalg::LinalgOp LinalgOpVect = dyn_cast_or_null<mlir::linalg::LinalgOp>(OpVect))
+    {
+      AS_LOG(LogLevel::Debug, "Decomposing op " << this->targetOpId << " (stage " << this->OperationStage << ")");
+
+      mlir::Operation *DecomposeScope = OpVect->getParentOp();
+      vectIndex.erase(OpVect);
+      mlir::linalg::LinalgOp DecomposedTarget = DecomposeOp(LinalgOpVect, &rewriter);
+      vectIndex.update(DecomposeScope);
+      // MLIRCodeIR *DecomposedCodeIr = (MLIRCodeIR *)ClonedCodeVect->setMLIRIR(DecomposedTarget);
+      // VectNode->setTransformedCodeIr(DecomposedCodeIr);
+    }
+
+    // DecomposedTarget->dump();
+  }
+  // ClonedOpVect->dump();
+  // IRRewriter rewriter(context);
+  AS_LOG(LogLevel::Debug, "Vectorizing op " << this->targetOpId << " (stage " << this->OperationStage << ")");
+  Logger::get().logIR(LogLevel::Trace, "Vectorization candidate", ClonedOpVect);
+
+  // for (auto oper : linalgOps)
+  //{
+  OpVect = vectIndex.lookup(this->targetOpId, this->OperationStage);
+  if (!OpVect)
+    return;
+  mlir::Operation *OpVectParent = OpVect->getParentOp();
+  // The vectorization and the patterns rewrite the operations of the code
+  invalidateOpIdentityIndex(ClonedOpVect);
+  OpVectParent->walk([&](mlir::Operation *op)
+                     {
+           if (linalg::LinalgOp linalgOp = dyn_cast<linalg::LinalgOp>(op)) {
+              llvm::ArrayRef<int64_t> emptyArrayRef;
+
+              llvm::ArrayRef<bool> boolArrayRef;
+
+              mlir::linalg::vectorize(rewriter, op, emptyArrayRef,
+                                                  boolArrayRef, false);
+
+              RewritePatternSet patterns(context);
+
+
+              //if (!props.getDisableTransferPermutationMapLoweringPatterns())
+                mlir::vector::populateVectorTransferPermutationMapLoweringPatterns(patterns);
+
+              //if (!props.getDisableMultiReductionToContractPatterns())
+                vector::populateVectorReductionToContractPatterns(patterns);
+
+              vector::populateSinkVectorBroadcastPatterns(patterns);
+
+              patterns.add<linalg::LinalgCopyVTRForwardingPattern,
+                            linalg::LinalgCopyVTWForwardingPattern>(context, 2);
+              vector::TransferReadOp::getCanonicalizationPatterns(patterns, context);
+              vector::TransferWriteOp::getCanonicalizationPatterns(patterns, context);
+              tensor::populateFoldTensorSubsetIntoVectorTransferPatterns(patterns);
+
+              patterns.add<mlir::linalg::CopyVectorizationPattern>(context);
+
+              //if (props.getVectorizePadding())
+                linalg::populatePadOpVectorizationPatterns(patterns);
+
+              if (failed(applyPatternsAndFoldGreedily(ClonedOpVect, std::move(patterns))))
+                AS_LOG(LogLevel::Debug, "Vectorization patterns of op " << this->targetOpId << " did not converge");
+   // ######### GREEDILY APPLY AND FOLD #################*/
+
+           } });
+  // ## VECTORIZE ONE OP
 }
 
 SmallVector<Node *, 2> Vectorization::createVectorizationCandidates(Node *node,
                                                                     mlir::MLIRContext *context)
 {
+  llvm::TimeTraceScope traceScope("Generate candidates", "Vectorization");
   // SmallVector<SmallVector<Node *, 2>> ChildNodesList;
 
   SmallVector<linalg::LinalgOp, 2> LinalgOps;
@@ -89,7 +333,6 @@ SmallVector<Node *, 2> Vectorization::createVectorizationCandidates(Node *node,
 
           std::vector<Transformation*> TransList= node->getTransformationList();
           ChildNode->setTransformationList(TransList);
-          std::cout << "VECT1\n";
           Vectorization *vectorization  =
             new Vectorization(&genricOp,
                             //candidate,
@@ -106,14 +349,14 @@ SmallVector<Node *, 2> Vectorization::createVectorizationCandidates(Node *node,
   SmallVector<Node *, 2> ChildNodes;
 
   MLIRCodeIR *ClonedCode = (MLIRCodeIR *)CodeIr->cloneIr();
-  Node *ChildNode = new Node(ClonedCode, node->getCurrentStage());
+  Node *ChildNode = SearchTreeArena::get().createNode(ClonedCode, node->getCurrentStage());
 
   std::vector<Transformation *> TransList = node->getTransformationList();
   ChildNode->setTransformationList(TransList);
 
   linalg::LinalgOp genricOp;
   Vectorization *vectorization =
-      new Vectorization(&genricOp,
+      SearchTreeArena::get().createTransformation<Vectorization>(&genricOp,
                         // candidate,
                         context);
 
@@ -177,23 +420,19 @@ SmallVector<Node *, 2> Vectorization::createVectorizationCandidates(Node *node,
 
           SmallVector<OpFoldResult> mixedSizes = getMixedSizes(tilingSizes, context);
           options.setTileSizes(mixedSizes);
-          std::cout << "Modified tilingSizes " << (op->getName().getStringRef()).str() << " : [";
-          for (size_t i = 0; i < tilingSizes.size(); ++i)
+          if (Logger::get().isEnabled(LogLevel::Debug))
           {
-            std::cout << tilingSizes[i];
-            if (i < tilingSizes.size() - 1)
-            {
-              std::cout << ", ";
-            }
+            std::string sizes;
+            for (size_t i = 0; i < tilingSizes.size(); ++i)
+              sizes += (i > 0 ? ", " : "") + std::to_string(tilingSizes[i]);
+            AS_LOG(LogLevel::Debug, "Window tiling of op " << getOpId(op) << " (stage " << node->getCurrentStage()
+                                                           << ", " << (op->getName().getStringRef()).str() << "): [" << sizes << "]");
           }
-          std::cout << "]\n";
-
-          std::cout << "TRYING TO TILE CONV2D\n";
 
           ToDecompose = true;
           
           Tiling *tiling =
-              new Tiling(&ClonedTileableOp,
+              SearchTreeArena::get().createTransformation<Tiling>(&ClonedTileableOp,
                         node->getCurrentStage(),
                         options,
                         tilingSizes,
@@ -207,73 +446,11 @@ SmallVector<Node *, 2> Vectorization::createVectorizationCandidates(Node *node,
 
           FailureOr<scf::SCFTilingResult> maybeTiled =
               scf::tileUsingSCFForOp(rewriter, ClonedTileableOp, options);
-          std::cout << "END OF TILE CONV2D\n";
 
           if (!failed(maybeTiled))
             rewriter.replaceOp(ClonedTileableOp, maybeTiled->loops.front()->getResults());
         }
       } });
-    /*for (Transformation *transform : transformations)
-    {
-      // Check if the dynamic cast to Tiling is successful
-      if (transform->getType() == "Parallelization")
-      {
-        TilingDone = true;
-        // Found a Tiling transformation
-        Parallelization *tiling = (Parallelization *)transform;
-        int stage = tiling->getOperationStage();
-        tilingSizes = tiling->getTileSizes();
-        mlir::Operation *linalgOp = linalgOps[stage];
-        for (size_t i = 0; i < tilingSizes.size(); ++i)
-        {
-          if (i == 2)
-          {
-            tilingSizes[i] = 1; // DEPENDS on the 'h' and the type of the conv2D
-          }
-          else if ((linalgOp->getName().getStringRef()).str() == "linalg.pooling_nchw_max" && i == 4)
-          {
-            tilingSizes[i] = 1; // DEPENDS on the 'h' and the type of the pooling
-          }
-          else if ((linalgOp->getName().getStringRef()).str() == "linalg.conv_2d_nchw_fchw" && i == 6)
-          {
-            tilingSizes[i] = 1; // DEPENDS on the 'h' and the type of the conv2D
-          }
-        }
-        scf::SCFTilingOptions options;
-
-        options.setTileSizes(tilingSizes);
-        std::cout << "Modified tilingSizes on stage " << stage << " : [";
-        for (size_t i = 0; i < tilingSizes.size(); ++i)
-        {
-          std::cout << tilingSizes[i];
-          if (i < tilingSizes.size() - 1)
-          {
-            std::cout << ", ";
-          }
-        }
-        std::cout << "]\n";
-        if (mlir::TilingInterface ClonedTileableOp = dyn_cast<mlir::TilingInterface>(linalgOp))
-        {
-          if ((linalgOp->getName().getStringRef()).str() != "linalg.fill" && TilingDone)
-          {
-            if ((linalgOp->getName().getStringRef()).str() == "linalg.conv_2d_nchw_fchw" || (linalgOp->getName().getStringRef()).str() == "linalg.pooling_nchw_max") // TO DO : TYPE OF THE CONV2D
-            {
-              std::cout << "TRYING TO TILE CONV2D\n";
-
-              ToDecompose = true;
-              IRRewriter rewriter(context);
-
-              FailureOr<scf::SCFTilingResult> maybeTiled =
-                  scf::tileUsingSCFForOp(rewriter, ClonedTileableOp, options);
-              std::cout << "END OF TILE CONV2D\n";
-
-              if (!failed(maybeTiled))
-                rewriter.replaceOp(ClonedTileableOp, maybeTiled->loops.front()->getResults());
-            }
-          }
-        }
-      }
-    }*/
 
     /*ClonedTarget->walk([&](mlir::Operation *op)
                        {
@@ -299,12 +476,11 @@ SmallVector<Node *, 2> Vectorization::createVectorizationCandidates(Node *node,
     //  Conv2d Decomposition
     if (ToDecompose)
     {
-      std::cout << "START DECOMPOSE\n";
+      AS_LOG(LogLevel::Debug, "Decomposing the windowed ops of the candidate (stage " << node->getCurrentStage() << ")");
       mlir::Operation *DecomposedTarget = DecomposeConv2dOp(ClonedTarget);
       MLIRCodeIR *DecomposedCodeIr = (MLIRCodeIR *)CodeIr->setMLIRIR(DecomposedTarget);
       node->setTransformedCodeIr(DecomposedCodeIr);
-      std::cout << "END DECOMPOSE\n";
-      DecomposedTarget->dump();
+      Logger::get().logIR(LogLevel::Trace, "Decomposed code", DecomposedTarget);
     }
 
     // End Conv2d Decomposition
@@ -313,9 +489,8 @@ SmallVector<Node *, 2> Vectorization::createVectorizationCandidates(Node *node,
                                    .getIr());
     Vectorization *vectorization = (Vectorization *)node->getTransformation();
 
-    // auto start = std::chrono::high_resolution_clock::now();
     std::string transformDialectString = "module attributes {transform.with_named_sequence} { \n transform.named_sequence @__transform_main(%variant_op: !transform.any_op {transform.readonly})  { \n   %func = transform.structured.match ops{[\"func.func\"]} in %variant_op: (!transform.any_op) -> !transform.any_op \n  %func_0 = transform.structured.vectorize_children_and_apply_patterns %func {vectorize_padding}: (!transform.any_op) -> (!transform.any_op) \n %func_01 = transform.structured.hoist_redundant_vector_transfers %func_0 :(!transform.any_op) -> (!transform.any_op) \n transform.yield}}";
-    std::cout << "START VECT\n";
+    AS_LOG(LogLevel::Debug, "Vectorizing the candidate (stage " << node->getCurrentStage() << ")");
 
     mlir::transform::TransformOptions options1;
     mlir::OwningOpRef<mlir::ModuleOp> moduleFromFile = parseSourceString<mlir::ModuleOp>(transformDialectString, Target->getContext());
@@ -342,10 +517,6 @@ SmallVector<Node *, 2> Vectorization::createVectorizationCandidates(Node *node,
       node->setTransformedCodeIr(ClonedCodeIr);
     }*/
     // Target->dump();
-    std::cout << "END VECT\n";
-    /*auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-    std::cout << "Time taken by vectorization: " << duration.count() << " microseconds" << std::endl;*/
   }
   // OpIndex++;
   //}
@@ -399,7 +570,6 @@ SmallVector<Node *, 2> Vectorization::createVectorizationCandidates(Node *node,
   /*ClonedTarget->walk<WalkOrder::PreOrder>([&](Operation *op)
                      {
                       op->dump();
-          //std::cout << "op = "<<(op->getName().getStringRef()).str()<<std::endl;
 
 
           if (auto genricOp = dyn_cast<linalg::LinalgOp>(op)) {  // IT APPLYS VECTORIZATION ON ALL THE CODE, WITHOUT THE NEXT CONDITION
@@ -470,8 +640,10 @@ pid_t popenvect(const char *command, int *infp, int *outfp)
             NULL);
     }
 
+    // _exit: the destructors of the statics (logger, metrics) must not run
+    // in the child, it does not have their threads
     perror("execl");
-    exit(1);
+    _exit(127);
   }
 
   // Parent process
@@ -0,0 +1,177 @@
+/*===------------------------------- capi.c -------------------------------===*\
+|*                                                                            *|
+|*===----------------------------------------------------------------------===*|
+|*                                                                            *|
+|* This file contains the smoke test of the C API of the MLAutoScheduler      *|
+|* library: the calls that do not run the code (the application of a          *|
+|* schedule, the errors of the API) on the module of the first argument, and  *|
+|* the round trip of the schedules through the tuning database of the second  *|
+|* argument (the third argument is the path of a temporary database).         *|
+|*                                                                            *|
+\*===----------------------------------------------------------------------===*/
+
+// RUN: AutoSchedulerCApiTest %S/../Inputs/matmul.mlir %S/../Inputs/tuning-db.json %t.json 2>&1 | FileCheck %s
+
+#include "AutoSchedulerC.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Returns the content of the file, NULL if it could not be read. The string is
+ * freed by the caller. */
+static char *readFile(const char *path)
+{
+  FILE *file = fopen(path, "rb");
+  if (!file)
+    return NULL;
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  char *content = malloc(size + 1);
+  if (content && fread(content, 1, size, file) != (size_t)size)
+  {
+    free(content);
+    content = NULL;
+  }
+  if (content)
+    content[size] = '\0';
+  fclose(file);
+  return content;
+}
+
+/* The parallelization of the matmul (operation 0) with 8x16 tiles is applied,
+ * the printed module has the forall loop and the matmul of one tile. */
+static void testApplySchedule(AsScheduler *scheduler, const char *module)
+{
+  fprintf(stderr, "@testApplySchedule\n");
+  const char *schedule = "[{\"type\": \"Parallelization\", \"stage\": 0, \"op_id\": 0, \"tile_sizes\": [8, 16, 0]}]";
+  char *transformed = NULL;
+  if (asApplySchedule(scheduler, module, schedule, &transformed) != 0)
+  {
+    fprintf(stderr, "error: %s\n", asGetLastError(scheduler));
+    return;
+  }
+  fprintf(stderr, "%s\n", transformed);
+  asFreeString(transformed);
+  // CHECK-LABEL: @testApplySchedule
+  // CHECK: func.func @matmul
+  // CHECK: scf.forall
+  // CHECK: linalg.matmul {{.*}}ins({{.*}} : tensor<8x32xf32>, tensor<32x16xf32>) outs({{.*}} : tensor<8x16xf32>)
+  // CHECK: func.func @main
+  // CHECK-NOT: error:
+}
+
+/* The failed calls return a non-zero status and set the last error, the
+ * scheduler stays usable. */
+static void testErrors(AsScheduler *scheduler, const char *module)
+{
+  fprintf(stderr, "@testErrors\n");
+  char *transformed = NULL;
+  int status = asApplySchedule(scheduler, module, "{}", &transformed);
+  fprintf(stderr, "%d %s\n", status, asGetLastError(scheduler));
+  // CHECK-LABEL: @testErrors
+  // CHECK: 1 The schedule is not a JSON array
+
+  status = asApplySchedule(scheduler, module, "[{\"type\": \"Unrolling\"}]", &transformed);
+  fprintf(stderr, "%d %s\n", status, asGetLastError(scheduler));
+  // CHECK: 1 Unknown transformation in the schedule
+
+  status = asApplySchedule(scheduler, "func.func @f(", "[]", &transformed);
+  fprintf(stderr, "%d %s\n", status, asGetLastError(scheduler));
+  // CHECK: 1 Could not parse the module
+
+  char *schedule = NULL;
+  double time = 0;
+  status = asLookupSchedule(scheduler, NULL, "matmul", &schedule, &time);
+  fprintf(stderr, "%d %s\n", status, asGetLastError(scheduler));
+  // CHECK: 1 No stored schedule for matmul
+
+  status = asApplySchedule(scheduler, module, "[]", &transformed);
+  fprintf(stderr, "%d [%s]\n", status, asGetLastError(scheduler));
+  asFreeString(transformed);
+  // CHECK: 0 []
+}
+
+/* The stored schedule has every type of transformation: it is read (the
+ * transformations are created), written back as JSON, and read again from a
+ * database holding the written schedule, which must not change it. The fields
+ * of the earlier versions (the deallocation and the memory space of the
+ * bufferization) are dropped. */
+static void testScheduleRoundTrip(AsScheduler *scheduler, const char *database, const char *copy)
+{
+  fprintf(stderr, "@testScheduleRoundTrip\n");
+  char *schedule = NULL;
+  double time = 0;
+  if (asLookupSchedule(scheduler, database, "matmul", &schedule, &time) != 0)
+  {
+    fprintf(stderr, "error: %s\n", asGetLastError(scheduler));
+    return;
+  }
+  fprintf(stderr, "%g %s\n", time, schedule);
+  // CHECK-LABEL: @testScheduleRoundTrip
+  // CHECK: 1250.5 [
+  // CHECK-SAME: {"op_id":0,"print":"TP( 8, 16, 0 ){{[^"]*}}","stage":0,"tile_sizes":[8,16,0],"type":"Parallelization"},
+  // CHECK-SAME: {"interchange":[1,0,2],"op_id":0,"print":"T( 4, 8, 16 ){{[^"]*}}","stage":0,"tile_sizes":[4,8,16],"type":"Tiling"},
+  // CHECK-SAME: {"interchange":[2,0,1],"print":"I( 2, 0, 1{{[^"]*}}","type":"Interchange"},
+  // CHECK-SAME: {"op_id":0,"print":"V( {{[^"]*}}","stage":0,"type":"Vectorization"},
+  // CHECK-SAME: {"copy_before_write":true,"empty_tensor_elimination":false,"function_boundary_layout":1,"heuristic":1,"print":"B( identity{{[^"]*}}","type":"Bufferization"},
+  // CHECK-SAME: {"flags":"contract","print":"FM( contract )","type":"FastMath"},
+  // CHECK-SAME: {"group":1,"num_threads":[4,2],"print":"C( 0:4, 1:2 )","stages":[0,1],"type":"InterOpConcurrency"}]
+
+  FILE *file = fopen(copy, "w");
+  if (!file)
+  {
+    fprintf(stderr, "error: could not write %s\n", copy);
+    asFreeString(schedule);
+    return;
+  }
+  fprintf(file, "{\"benchmarks\": {\"matmul\": {\"time\": %.17g, \"schedule\": %s}}}\n", time, schedule);
+  fclose(file);
+
+  char *copied = NULL;
+  double copiedTime = 0;
+  if (asLookupSchedule(scheduler, copy, "matmul", &copied, &copiedTime) != 0)
+  {
+    fprintf(stderr, "error: %s\n", asGetLastError(scheduler));
+    asFreeString(schedule);
+    return;
+  }
+  fprintf(stderr, "%s\n", strcmp(schedule, copied) == 0 && copiedTime == time ? "identical" : "changed");
+  // CHECK-NEXT: identical
+  asFreeString(copied);
+  asFreeString(schedule);
+
+  // A schedule with an unknown transformation is not returned
+  int status = asLookupSchedule(scheduler, database, "unknown", &schedule, &time);
+  fprintf(stderr, "%d %s\n", status, asGetLastError(scheduler));
+  // CHECK: Unknown transformation in the schedule of unknown
+  // CHECK-NEXT: 1 No stored schedule for unknown
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 4)
+  {
+    fprintf(stderr, "Usage: AutoSchedulerCApiTest <module.mlir> <tuning-db.json> <copy.json>\n");
+    return 1;
+  }
+  char *module = readFile(argv[1]);
+  if (!module)
+  {
+    fprintf(stderr, "Could not read %s\n", argv[1]);
+    return 1;
+  }
+  AsScheduler *scheduler = asSchedulerCreate();
+  if (!scheduler)
+  {
+    free(module);
+    return 1;
+  }
+  testApplySchedule(scheduler, module);
+  testErrors(scheduler, module);
+  testScheduleRoundTrip(scheduler, argv[2], argv[3]);
+  asSchedulerDestroy(scheduler);
+  free(module);
+  return 0;
+}
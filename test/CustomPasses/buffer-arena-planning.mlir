@@ -0,0 +1,95 @@
+// RUN: AutoSchedulerOpt %s -pass-pipeline='builtin.module(func.func(as-buffer-arena-planning))' -split-input-file | FileCheck %s
+
+// The buffer %a is still used through its subview after %b is allocated, the
+// two buffers get different offsets; %c only lives after both and reuses the
+// offset of %a.
+
+// CHECK-LABEL: func.func @aliasing
+// CHECK: %[[ARENA:.*]] = memref.alloc() {alignment = 64 : i64} : memref<128xi8>
+// CHECK: %[[OFFA:.*]] = arith.constant 0 : index
+// CHECK: %[[A:.*]] = memref.view %[[ARENA]][%[[OFFA]]][] : memref<128xi8> to memref<16xf32>
+// CHECK: %[[SUB:.*]] = memref.subview %[[A]]
+// CHECK: %[[OFFB:.*]] = arith.constant 64 : index
+// CHECK: %[[B:.*]] = memref.view %[[ARENA]][%[[OFFB]]][] : memref<128xi8> to memref<16xf32>
+// CHECK: memref.store %{{.*}}, %[[B]]
+// CHECK: memref.store %{{.*}}, %[[SUB]]
+// CHECK: %[[OFFC:.*]] = arith.constant 0 : index
+// CHECK: %[[C:.*]] = memref.view %[[ARENA]][%[[OFFC]]][] : memref<128xi8> to memref<16xf32>
+// CHECK: memref.store %{{.*}}, %[[C]]
+// CHECK-NOT: memref.dealloc %[[A]]
+// CHECK: memref.dealloc %[[ARENA]] : memref<128xi8>
+// CHECK-NEXT: return
+func.func @aliasing(%x: f32, %c0: index) {
+  %a = memref.alloc() : memref<16xf32>
+  %sub = memref.subview %a[0] [8] [1] : memref<16xf32> to memref<8xf32, strided<[1]>>
+  %b = memref.alloc() : memref<16xf32>
+  memref.store %x, %b[%c0] : memref<16xf32>
+  memref.dealloc %b : memref<16xf32>
+  memref.store %x, %sub[%c0] : memref<8xf32, strided<[1]>>
+  memref.dealloc %a : memref<16xf32>
+  %c = memref.alloc() : memref<16xf32>
+  memref.store %x, %c[%c0] : memref<16xf32>
+  memref.dealloc %c : memref<16xf32>
+  return
+}
+
+// -----
+
+// A buffer used in a loop lives for the whole loop: %a and %b are both alive
+// in the first loop, %c reuses the offset of %a. The buffer allocated in the
+// body of the second loop is not planned.
+
+// CHECK-LABEL: func.func @loop
+// CHECK: %[[ARENA:.*]] = memref.alloc() {alignment = 64 : i64} : memref<128xi8>
+// CHECK: %[[OFFA:.*]] = arith.constant 0 : index
+// CHECK: %[[A:.*]] = memref.view %[[ARENA]][%[[OFFA]]][] : memref<128xi8> to memref<16xf32>
+// CHECK: %[[OFFB:.*]] = arith.constant 64 : index
+// CHECK: %[[B:.*]] = memref.view %[[ARENA]][%[[OFFB]]][] : memref<128xi8> to memref<16xf32>
+// CHECK: scf.for
+// CHECK:   memref.store %{{.*}}, %[[A]]
+// CHECK:   memref.store %{{.*}}, %[[B]]
+// CHECK: %[[OFFC:.*]] = arith.constant 0 : index
+// CHECK: %[[C:.*]] = memref.view %[[ARENA]][%[[OFFC]]][] : memref<128xi8> to memref<16xf32>
+// CHECK: scf.for
+// CHECK:   %[[T:.*]] = memref.alloc() : memref<4xf32>
+// CHECK:   memref.dealloc %[[T]] : memref<4xf32>
+// CHECK:   memref.store %{{.*}}, %[[C]]
+// CHECK: memref.dealloc %[[ARENA]] : memref<128xi8>
+// CHECK-NEXT: return
+func.func @loop(%x: f32, %c0: index, %c1: index, %c16: index) {
+  %a = memref.alloc() : memref<16xf32>
+  %b = memref.alloc() : memref<16xf32>
+  scf.for %i = %c0 to %c16 step %c1 {
+    memref.store %x, %a[%i] : memref<16xf32>
+    memref.store %x, %b[%i] : memref<16xf32>
+  }
+  memref.dealloc %a : memref<16xf32>
+  memref.dealloc %b : memref<16xf32>
+  %c = memref.alloc() : memref<16xf32>
+  scf.for %i = %c0 to %c16 step %c1 {
+    %t = memref.alloc() : memref<4xf32>
+    memref.store %x, %t[%c0] : memref<4xf32>
+    memref.dealloc %t : memref<4xf32>
+    memref.store %x, %c[%i] : memref<16xf32>
+  }
+  memref.dealloc %c : memref<16xf32>
+  return
+}
+
+// -----
+
+// A returned buffer escapes the function and is left unchanged, a single
+// remaining buffer is not worth an arena.
+
+// CHECK-LABEL: func.func @escaping
+// CHECK-NOT: memref.view
+// CHECK: %[[R:.*]] = memref.alloc() : memref<16xf32>
+// CHECK: return %[[R]]
+func.func @escaping(%x: f32, %c0: index) -> memref<16xf32> {
+  %r = memref.alloc() : memref<16xf32>
+  %t = memref.alloc() : memref<16xf32>
+  memref.store %x, %t[%c0] : memref<16xf32>
+  memref.dealloc %t : memref<16xf32>
+  memref.store %x, %r[%c0] : memref<16xf32>
+  return %r : memref<16xf32>
+}
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+# Starts the daemon (AutoSchedulerML --daemon) and sends it requests through
+# the client of scripts/, for the lit test of the daemon:
+#
+#   daemon_requests.py <AutoSchedulerML> <module.mlir>
+#
+# The requests do not run the code (apply, lookup, stats...), the responses are
+# printed for FileCheck. The socket is created in a temporary directory, the
+# path of a Unix socket is limited to about 100 characters.
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "..", "scripts"))
+import autoscheduler_client  # noqa: E402
+
+
+def main():
+    binary, module_path = sys.argv[1], sys.argv[2]
+    with open(module_path) as module:
+        source = module.read()
+    directory = tempfile.mkdtemp()
+    socket_path = os.path.join(directory, "daemon.sock")
+    # The output of the daemon goes to stderr, stdout holds the responses
+    daemon = subprocess.Popen([binary, "--daemon", socket_path], stdout=sys.stderr)
+    try:
+        # The daemon is ready once it accepts a connection
+        for _ in range(600):
+            if daemon.poll() is not None:
+                print("error: the daemon exited with status {}".format(daemon.returncode))
+                return 1
+            try:
+                response = autoscheduler_client.request(socket_path, {"op": "ping"}, timeout=60)
+                break
+            except (FileNotFoundError, ConnectionRefusedError):
+                time.sleep(0.1)
+        else:
+            print("error: the daemon did not start")
+            return 1
+        print("ping", response["status"])
+
+        def send(message):
+            response = autoscheduler_client.request(socket_path, message, timeout=60)
+            response.pop("elapsed_s", None)
+            return response
+
+        schedule = [{"type": "Parallelization", "stage": 0, "op_id": 0, "tile_sizes": [8, 16, 0]}]
+        response = send({"op": "apply", "module": source, "schedule": schedule})
+        print("apply", response["status"])
+        print(response.get("module", response.get("error")))
+
+        response = send({"op": "apply", "module": source, "schedule": [{"type": "Unrolling"}]})
+        print("apply", response["status"], response.get("error"))
+
+        response = send({"op": "lookup", "name": "matmul"})
+        print("lookup", response["status"], response.get("time"),
+              [step["type"] for step in response.get("schedule", [])])
+
+        response = send({"op": "lookup", "name": "missing"})
+        print("lookup", response["status"], response.get("error"))
+
+        response = send({"op": "frobnicate"})
+        print("frobnicate", response["status"], response.get("error"))
+
+        response = send({"op": "stats"})
+        print("stats", response["status"], response["requests"], response["searches"],
+              os.path.basename(response["tuning_db"]))
+
+        response = send({"op": "shutdown"})
+        print("shutdown", response["status"])
+        print("exit", daemon.wait(timeout=60))
+        return 0
+    finally:
+        if daemon.poll() is None:
+            daemon.kill()
+            daemon.wait()
+        shutil.rmtree(directory, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,20 @@
+// Matmul whose only linalg operation is the matmul of the kernel (as.op_id 0
+// once parsed), the input of the tests of the C API and of the daemon.
+
+!TTa = tensor<64x32xf32>
+!TTb = tensor<32x64xf32>
+!TTc = tensor<64x64xf32>
+
+func.func @matmul(%A: !TTa, %B: !TTb, %C: !TTc) -> !TTc {
+  %D = linalg.matmul ins(%A, %B: !TTa, !TTb)
+                     outs(%C: !TTc) -> !TTc
+  return %D : !TTc
+}
+
+func.func @main() {
+  %A = arith.constant dense<2.000000e+00> : !TTa
+  %B = arith.constant dense<2.000000e+00> : !TTb
+  %C = arith.constant dense<0.000000e+00> : !TTc
+  %D = func.call @matmul(%A, %B, %C) : (!TTa, !TTb, !TTc) -> !TTc
+  return
+}
@@ -0,0 +1,22 @@
+# -*- Python -*-
+# Configuration of the lit tests of the auto-scheduler, run by the
+# check-autoscheduler target (and by ctest).
+
+import os
+
+import lit.formats
+from lit.llvm import llvm_config
+
+config.name = "AUTOSCHEDULER"
+config.test_format = lit.formats.ShTest(not llvm_config.use_lit_shell)
+config.suffixes = [".mlir", ".test"]
+config.test_source_root = os.path.dirname(__file__)
+config.test_exec_root = os.path.join(config.autoscheduler_obj_root, "test")
+config.excludes = ["CMakeLists.txt", "lit.cfg.py", "lit.site.cfg.py", "Inputs"]
+
+llvm_config.use_default_substitutions()
+llvm_config.with_environment("PATH", config.llvm_tools_dir, append_path=True)
+
+tool_dirs = [config.autoscheduler_tools_dir, config.llvm_tools_dir]
+tools = ["AutoSchedulerOpt", "AutoSchedulerCApiTest", "AutoSchedulerML"]
+llvm_config.add_tool_substitutions(tools, tool_dirs)
@@ -0,0 +1,28 @@
+//===------------------------- AutoSchedulerOpt.cpp -----------------------===//
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// This file contains the optimizer driver of the auto-scheduler: mlir-opt with
+/// the custom passes of the lowering pipeline (as-buffer-arena-planning,
+/// as-concurrent-regions-lowering...), for the FileCheck tests of test/
+///
+//===----------------------------------------------------------------------===//
+
+#include "CustomPasses/Passes.h"
+
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/InitAllDialects.h"
+#include "mlir/InitAllPasses.h"
+#include "mlir/Tools/mlir-opt/MlirOptMain.h"
+
+int main(int argc, char **argv)
+{
+  mlir::registerAllPasses();
+  mlir::registerCustomPasses();
+
+  mlir::DialectRegistry registry;
+  mlir::registerAllDialects(registry);
+  return mlir::asMainReturnCode(
+      mlir::MlirOptMain(argc, argv, "Auto-scheduler optimizer driver\n", registry));
+}